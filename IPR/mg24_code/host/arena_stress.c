@@ -0,0 +1,115 @@
+/*
+ * arena_stress.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: edward62740
+ *
+ *  Exercises the arena allocator (app_arena.c) the way RSS uses it: a detector
+ *  create allocates a burst of mixed-size buffers, a reconfigure frees them all
+ *  and allocates a differently sized set, with some long-lived allocations in
+ *  between. Every block is filled with a pattern that is verified before it is
+ *  freed, and the boundary tags are checked after every operation.
+ *
+ *  usage: arena_stress [cycles] [arena_bytes] [seed]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "app_arena.h"
+
+#define MAX_LIVE 64
+
+typedef struct
+{
+    uint8_t *p;
+    size_t size;
+    uint8_t fill;
+} live_t;
+
+static live_t live[MAX_LIVE];
+static size_t nLive;
+
+/* RSS-like size mix: many small control structs, a few sweep/SPI sized buffers */
+static size_t randomSize(unsigned *seed)
+{
+    unsigned r = (unsigned) rand_r(seed) % 100;
+    if (r < 60) return 8 + (unsigned) rand_r(seed) % 120;
+    if (r < 90) return 128 + (unsigned) rand_r(seed) % 896;
+    return 1024 + (unsigned) rand_r(seed) % 7168;
+}
+
+static bool release(appArena_t *a, size_t i)
+{
+    for (size_t k = 0; k < live[i].size; k++)
+    {
+        if (live[i].p[k] != live[i].fill) return false;
+    }
+    appArenaFree(a, live[i].p);
+    live[i] = live[--nLive];
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    unsigned long cycles = argc > 1 ? strtoul(argv[1], NULL, 0) : 20000UL;
+    size_t arenaBytes = argc > 2 ? strtoul(argv[2], NULL, 0) : APP_ARENA_RSS_SIZE;
+    unsigned seed = argc > 3 ? (unsigned) strtoul(argv[3], NULL, 0) : 1;
+
+    uint64_t *buf = malloc(arenaBytes);
+    appArena_t a;
+    appArenaStats_t st;
+    unsigned long errors = 0, fragSum = 0, fragSamples = 0;
+    uint8_t fragMax = 0;
+
+    appArenaInit(&a, buf, arenaBytes);
+
+    for (unsigned long c = 0; c < cycles; c++)
+    {
+        // Reconfigure: drop a random share of the live set (all of it now and then)
+        bool all = (rand_r(&seed) % 8) == 0;
+        for (size_t i = nLive; i-- > 0;)
+        {
+            if (all || rand_r(&seed) % 2)
+            {
+                if (!release(&a, i) && errors++ < 10) fprintf(stderr, "cycle %lu: block overwritten\n", c);
+            }
+        }
+
+        // Create: a burst of allocations
+        size_t burst = 1 + (unsigned) rand_r(&seed) % 12;
+        for (size_t n = 0; n < burst && nLive < MAX_LIVE; n++)
+        {
+            size_t size = randomSize(&seed);
+            uint8_t *p = appArenaAlloc(&a, size);
+            if (p == NULL) continue;
+            if ((uintptr_t) p % APP_ARENA_ALIGN && errors++ < 10) fprintf(stderr, "cycle %lu: misaligned\n", c);
+            live[nLive] = (live_t) { p, size, (uint8_t) rand_r(&seed) };
+            memset(p, live[nLive].fill, size);
+            nLive++;
+        }
+
+        if (!appArenaCheck(&a) && errors++ < 10) fprintf(stderr, "cycle %lu: tags corrupted\n", c);
+
+        appArenaGetStats(&a, &st);
+        fragSum += st.fragPct;
+        fragSamples++;
+        if (st.fragPct > fragMax) fragMax = st.fragPct;
+    }
+
+    while (nLive > 0)
+    {
+        if (!release(&a, nLive - 1) && errors++ < 10) fprintf(stderr, "final: block overwritten\n");
+    }
+    appArenaGetStats(&a, &st);
+    if ((st.inUse != 0 || st.largestFree + 8 != st.capacity || !appArenaCheck(&a)) && errors++ < 10)
+        fprintf(stderr, "final: arena not fully coalesced\n");
+
+    printf("arena %u B: allocs %u, frees %u, failed %u, peak %u B (%u%%)\n",
+           st.capacity, st.allocs, st.frees, st.failed, st.peak, (unsigned) (100ULL * st.peak / st.capacity));
+    printf("fragmentation: mean %.1f%%, max %u%%, errors %lu\n",
+           fragSamples ? (double) fragSum / fragSamples : 0.0, fragMax, errors);
+
+    free(buf);
+    return errors == 0 ? 0 : 1;
+}
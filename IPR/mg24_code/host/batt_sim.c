@@ -0,0 +1,184 @@
+/*
+ * batt_sim.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: edward62740
+ *
+ *  Discharges a simulated 2 x LR03 pack through the battery model (app_batt.c)
+ *  the way radar_app.c drives it. Each minute the pack supplies the modelled
+ *  average current. Load samples (sagged by the internal resistance) arrive
+ *  with every data poll, and one idle sample per alive interval. Both carry
+ *  ADC noise and a slow temperature swing.
+ *
+ *  The current follows the sim.h energy model at the idle frame spacing, with
+ *  frame spacing, alive interval and poll period stretched by appBattScale().
+ *  Prints the estimate every 30 days against the truth and the actual days left.
+ *  It then reports the service life with and without throttling, and the mean
+ *  end-of-life prediction error.
+ *
+ *  The samples are the pack voltage, as on a board with pack sense. -q runs the
+ *  model without it, as on the IPR v2 board: SoC from the charge used at the
+ *  nominal current, no throttling.
+ *
+ *  usage: batt_sim [-q] [-C capacity_mAh] [-o offset_mV] [-s seed]
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "app_batt.h"
+#include "sim.h"
+
+#define POLL_PERIOD_S   5      // one load sample per data poll
+#define RADIO_LOAD_MA   8.0    // during a poll, sets the load sag
+#define MAX_ROWS        64
+
+typedef struct
+{
+    uint32_t day;
+    double trueSoc;
+    uint8_t soc;
+    appBattLevel_t level;
+    uint32_t eolDays;
+    bool trend;
+} row_t;
+
+typedef struct
+{
+    double capacityMah;
+    double offsetMv;
+    unsigned seed;
+    bool packSense;
+} cfg_t;
+
+/* Inverse of the app_batt.c curve for the truth, with a per-pack offset */
+static double packOcvMv(double soc, double offsetMv)
+{
+    static const double mv[] = { 2000, 2120, 2240, 2340, 2420, 2500, 2560, 2640, 2720, 2840, 3160 };
+    if (soc <= 0) return mv[0] + offsetMv;
+    if (soc >= 100) return mv[10] + offsetMv;
+    int i = (int) (soc / 10);
+    return mv[i] + (mv[i + 1] - mv[i]) * (soc - 10 * i) / 10 + offsetMv;
+}
+
+/* Alkaline internal resistance rises towards the end of discharge */
+static double packResistanceOhm(double soc)
+{
+    return 0.3 + 1.2 * (1.0 - soc / 100) * (1.0 - soc / 100);
+}
+
+static double noiseMv(unsigned *seed, double amplitude)
+{
+    return amplitude * (2.0 * rand_r(seed) / RAND_MAX - 1.0);
+}
+
+static double currentUa(const simEnergyModel_t *m, uint8_t scale)
+{
+    double frameS = RADAR_APP_DEFAULT_FRAME_SPACING_MS / 1000.0 * scale;
+    double aliveS = SIM_ALIVE_INTERVAL_MS / 1000.0 * scale;
+    return m->baseCurrentUa + m->frameChargeUc / frameS + m->sendChargeUc / aliveS;
+}
+
+/* Returns the service life in days, fills rows when given */
+static double run(const cfg_t *cfg, bool throttle, row_t *rows, unsigned *nRows, double *eolErrDays)
+{
+    simEnergyModel_t model;
+    simDefaultEnergyModel(&model);
+
+    appBatt_t batt;
+    appBattInit(&batt, cfg->packSense);
+
+    unsigned seed = cfg->seed;
+    double chargeMah = cfg->capacityMah;
+    uint32_t minute = 0, nextUpdate = 0, pollAcc = 0;
+    uint8_t scale = 1;
+    unsigned n = 0;
+
+    while (chargeMah > 0)
+    {
+        double soc = 100.0 * chargeMah / cfg->capacityMah;
+        double tempMv = 15.0 * sin(2 * M_PI * minute / 1440.0);
+        double ocv = packOcvMv(soc, cfg->offsetMv) + tempMv;
+
+        // Data polls this minute, each with one load sample
+        pollAcc += 60;
+        while (pollAcc >= POLL_PERIOD_S * scale)
+        {
+            pollAcc -= POLL_PERIOD_S * scale;
+            double sag = RADIO_LOAD_MA * packResistanceOhm(soc);
+            appBattSample(&batt, (uint32_t) (ocv - sag + noiseMv(&seed, 10)), true);
+        }
+
+        if (minute >= nextUpdate)
+        {
+            // radarAppBattUpdate(): estimate, then the idle sample for the next update
+            if (appBattUpdate(&batt, minute * 60) && throttle) scale = appBattScale(&batt);
+            appBattSample(&batt, (uint32_t) (ocv + noiseMv(&seed, 10)), false);
+            nextUpdate = minute + (SIM_ALIVE_INTERVAL_MS / 60000) * scale;
+        }
+
+        if (rows != NULL && minute % (30 * 1440) == 0 && n < MAX_ROWS)
+        {
+            rows[n] = (row_t) { minute / 1440, soc, batt.soc, batt.level, batt.eolDays, batt.trend };
+            n++;
+        }
+
+        chargeMah -= currentUa(&model, scale) / 1000.0 / 60.0;
+        minute++;
+    }
+
+    double lifeDays = minute / 1440.0;
+    if (rows != NULL)
+    {
+        double err = 0;
+        unsigned m = 0;
+        for (unsigned i = 1; i < n; i++)
+        {
+            err += fabs((double) rows[i].eolDays - (lifeDays - rows[i].day));
+            m++;
+        }
+        *nRows = n;
+        *eolErrDays = m ? err / m : 0;
+    }
+    return lifeDays;
+}
+
+int main(int argc, char **argv)
+{
+    cfg_t cfg = { .capacityMah = 1000, .offsetMv = 20, .seed = 1, .packSense = true };
+
+    int opt;
+    while ((opt = getopt(argc, argv, "qC:o:s:h")) != -1)
+    {
+        switch (opt)
+        {
+        case 'q': cfg.packSense = false; break;
+        case 'C': cfg.capacityMah = atof(optarg); break;
+        case 'o': cfg.offsetMv = atof(optarg); break;
+        case 's': cfg.seed = (unsigned) atoi(optarg); break;
+        default:
+            fprintf(stderr, "usage: %s [-q] [-C capacity_mAh] [-o offset_mV] [-s seed]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    row_t rows[MAX_ROWS];
+    unsigned nRows = 0;
+    double eolErr = 0;
+    double life = run(&cfg, true, rows, &nRows, &eolErr);
+    double lifeFixed = run(&cfg, false, NULL, NULL, NULL);
+
+    printf("pack: %.0f mAh, %+.0f mV offset, %s\n\n", cfg.capacityMah, cfg.offsetMv,
+           cfg.packSense ? "pack sense" : "charge count");
+    printf("%5s %8s %6s %6s %8s %8s %6s\n", "day", "soc[%]", "est%", "level", "eol[d]", "left[d]", "trend");
+    for (unsigned i = 0; i < nRows; i++)
+    {
+        printf("%5u %8.1f %6u %6d %8u %8.0f %6d\n", rows[i].day, rows[i].trueSoc, rows[i].soc,
+               (int) rows[i].level, rows[i].eolDays, life - rows[i].day, (int) rows[i].trend);
+    }
+    printf("\nlife: %.0f days throttled, %.0f days fixed rate (%+.1f%%)\n",
+           life, lifeFixed, 100.0 * (life - lifeFixed) / lifeFixed);
+    printf("end-of-life prediction: mean abs error %.1f days\n", eolErr);
+    return 0;
+}
@@ -0,0 +1,211 @@
+/*
+ * disc_check.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: edward62740
+ *
+ *  Checks the server selection of the DNS-SD discovery (app_disc.c):
+ *  - appDiscSelect() keeps to the lowest priority and spreads over the weights,
+ *    also when their sum is past 16 bits; weight 0 servers get their one draw in
+ *    total + 1, and an all zero list is picked uniformly;
+ *  - appDiscFail() skips the failed server and backs off once none is left;
+ *  - appDiscEnd() refreshes at the first TTL, clamped to APP_DISC_TTL_MIN_S,
+ *    and backs off with jitter up to APP_DISC_RETRY_MAX_MS after a failed browse.
+ *  Prints each failed check and exits non-zero if there was any.
+ *
+ *  usage: disc_check [draws] [seed]
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "app_disc.h"
+
+static unsigned errors;
+
+#define CHECK(cond, ...)                                         \
+    do                                                           \
+    {                                                            \
+        if (!(cond))                                             \
+        {                                                        \
+            errors++;                                            \
+            printf("FAIL %s:%d: ", __func__, __LINE__);          \
+            printf(__VA_ARGS__);                                 \
+            printf("\n");                                        \
+        }                                                        \
+    } while (0)
+
+typedef struct
+{
+    const char *label;
+    uint16_t priority;
+    uint16_t weight;
+} entry_t;
+
+static void load(appDisc_t *disc, const entry_t *e, unsigned n, uint32_t ttlS, uint32_t nowMs)
+{
+    uint8_t addr[16] = { 0xfd };
+    appDiscBegin(disc);
+    for (unsigned i = 0; i < n; i++)
+    {
+        addr[15] = (uint8_t) i;
+        appDiscAdd(disc, e[i].label, addr, 5683, e[i].priority, e[i].weight, ttlS, nowMs);
+    }
+    appDiscEnd(disc, true, nowMs);
+}
+
+static int indexOf(const entry_t *e, unsigned n, const char *label)
+{
+    for (unsigned i = 0; i < n; i++) if (strcmp(e[i].label, label) == 0) return (int) i;
+    return -1;
+}
+
+/* Shares picked over draws against the expected ones, within 5 sigma */
+static void spread(const char *name, const entry_t *e, unsigned n, const double *expect, unsigned draws, uint32_t seed)
+{
+    unsigned hits[APP_DISC_MAX_SERVERS] = { 0 };
+    appDisc_t disc;
+    appDiscInit(&disc, seed, 0);
+    load(&disc, e, n, 3600, 0);
+
+    for (unsigned k = 0; k < draws; k++)
+    {
+        const appDiscServer_t *s = appDiscSelect(&disc, 0);
+        int i = s ? indexOf(e, n, s->label) : -1;
+        CHECK(i >= 0, "%s: nothing picked", name);
+        if (i < 0) return;
+        hits[i]++;
+    }
+
+    printf("%-10s", name);
+    for (unsigned i = 0; i < n; i++)
+    {
+        double got = (double) hits[i] / draws;
+        double sigma = sqrt(expect[i] * (1 - expect[i]) / draws);
+        printf("  %s %.4f/%.4f", e[i].label, got, expect[i]);
+        CHECK(fabs(got - expect[i]) <= 5 * sigma + 1e-9, "%s: %s picked %.4f, expected %.4f",
+              name, e[i].label, got, expect[i]);
+    }
+    printf("\n");
+}
+
+static void checkSelect(unsigned draws, uint32_t seed)
+{
+    // Weights summing past 16 bits, the draw must cover all of them
+    const entry_t big[] = { { "a", 1, 60000 }, { "b", 1, 60000 }, { "c", 1, 60000 }, { "d", 1, 60000 } };
+    spread("big", big, 4, (const double[]) { 0.25, 0.25, 0.25, 0.25 }, draws, seed);
+
+    const entry_t skew[] = { { "a", 1, 65535 }, { "b", 1, 65535 }, { "c", 1, 65535 }, { "d", 1, 1 } };
+    spread("skew", skew, 4, (const double[]) { 65535 / 196606.0, 65535 / 196606.0, 65535 / 196606.0, 1 / 196606.0 },
+           draws, seed);
+
+    // Weight 0 gets one draw in total + 1, the higher priority value is never picked
+    const entry_t zero[] = { { "a", 1, 3 }, { "b", 1, 1 }, { "c", 1, 0 }, { "d", 2, 100 } };
+    spread("zero", zero, 4, (const double[]) { 0.6, 0.2, 0.2, 0 }, draws, seed);
+
+    const entry_t zeros[] = { { "a", 0, 0 }, { "b", 0, 0 }, { "c", 0, 0 }, { "d", 0, 0 } };
+    spread("all zero", zeros, 4, (const double[]) { 0.25, 0.25, 0.25, 0.25 }, draws, seed);
+}
+
+static void checkFail(uint32_t seed)
+{
+    const entry_t e[] = { { "a", 1, 10 }, { "b", 1, 10 }, { "c", 2, 10 } };
+    appDisc_t disc;
+    appDiscInit(&disc, seed, 0);
+    load(&disc, e, 3, 3600, 0);
+    uint32_t refresh = disc.nextBrowseMs;
+
+    // Fails over within the priority first, then to the next one
+    const appDiscServer_t *first = appDiscSelect(&disc, 0);
+    CHECK(first && first->priority == 1, "first pick not at priority 1");
+    appDiscFail(&disc, 1000);
+    CHECK(disc.current[0] == '\0', "current kept after a failure");
+    const appDiscServer_t *second = appDiscSelect(&disc, 1000);
+    CHECK(second && second->priority == 1 && strcmp(second->label, first->label) != 0,
+          "second pick is not the other priority 1 server");
+    appDiscFail(&disc, 2000);
+    const appDiscServer_t *third = appDiscSelect(&disc, 2000);
+    CHECK(third && strcmp(third->label, "c") == 0, "failover to priority 2 missing");
+    CHECK(disc.nextBrowseMs == refresh, "browse moved while a server was left");
+
+    // None left: browse again after the jittered backoff
+    appDiscFail(&disc, 3000);
+    CHECK(appDiscSelect(&disc, 3000) == NULL, "a failed server was picked");
+    CHECK(disc.stats.failovers == 3, "failovers %u, expected 3", disc.stats.failovers);
+    CHECK(disc.nextBrowseMs >= 3000 + APP_DISC_RETRY_MS && disc.nextBrowseMs <= 3000 + APP_DISC_RETRY_MS * 3 / 2,
+          "backoff browse at %u", disc.nextBrowseMs);
+    CHECK(appDiscDue(&disc, disc.nextBrowseMs) && !appDiscDue(&disc, disc.nextBrowseMs - 1), "due at the wrong time");
+
+    // A failure with no server picked changes nothing
+    uint32_t next = disc.nextBrowseMs;
+    appDiscFail(&disc, 4000);
+    CHECK(disc.nextBrowseMs == next && disc.stats.failovers == 3, "failure without a current server counted");
+}
+
+static void checkEnd(uint32_t seed)
+{
+    appDisc_t disc;
+    appDiscInit(&disc, seed, 500);
+    CHECK(appDiscDue(&disc, 500), "no browse at init");
+
+    // Refresh at the first TTL, short TTLs clamped
+    const entry_t e[] = { { "a", 1, 1 }, { "b", 1, 1 } };
+    uint8_t addr[16] = { 0xfd };
+    appDiscBegin(&disc);
+    appDiscAdd(&disc, e[0].label, addr, 5683, 1, 1, 7200, 1000);
+    appDiscAdd(&disc, e[1].label, addr, 5683, 1, 1, 5, 1000);
+    appDiscAdd(&disc, "unresolved", NULL, 0, 0, 0, 0, 1000);
+    CHECK(appDiscUnresolved(&disc) && strcmp(appDiscUnresolved(&disc), "unresolved") == 0, "unresolved not listed");
+    appDiscDrop(&disc, "unresolved");
+    CHECK(appDiscUnresolved(&disc) == NULL && disc.count == 2, "drop left %u", disc.count);
+    appDiscEnd(&disc, true, 1000);
+    CHECK(disc.nextBrowseMs == 1000 + APP_DISC_TTL_MIN_S * 1000, "refresh at %u", disc.nextBrowseMs);
+
+    // The expired server is no longer current
+    appDiscSelect(&disc, 1000);
+    strcpy(disc.current, "b");
+    CHECK(appDiscCurrent(&disc, 2000) != NULL, "current lost before its TTL");
+    CHECK(appDiscCurrent(&disc, 1000 + APP_DISC_TTL_MIN_S * 1000) == NULL, "expired server still current");
+    const appDiscServer_t *s = appDiscSelect(&disc, 1000 + APP_DISC_TTL_MIN_S * 1000);
+    CHECK(s && strcmp(s->label, "a") == 0, "expired server picked");
+
+    // Failed browses back off with jitter, doubling up to the cap
+    uint32_t now = 100000, retry = APP_DISC_RETRY_MS;
+    for (unsigned k = 0; k < 8; k++)
+    {
+        appDiscBegin(&disc);
+        appDiscEnd(&disc, false, now);
+        CHECK(disc.nextBrowseMs >= now + retry && disc.nextBrowseMs <= now + retry + retry / 2,
+              "retry %u at +%u, expected %u..%u", k, disc.nextBrowseMs - now, retry, retry + retry / 2);
+        retry = retry * 2 < APP_DISC_RETRY_MAX_MS ? retry * 2 : APP_DISC_RETRY_MAX_MS;
+        now = disc.nextBrowseMs;
+    }
+    CHECK(disc.retryMs == APP_DISC_RETRY_MAX_MS, "backoff not capped: %u", disc.retryMs);
+    CHECK(disc.stats.retries == 8, "retries %u, expected 8", disc.stats.retries);
+
+    // A browse that answers without a usable server backs off as well, a good one resets it
+    appDiscBegin(&disc);
+    appDiscAdd(&disc, "pending", NULL, 0, 0, 0, 0, now);
+    appDiscEnd(&disc, true, now);
+    CHECK(disc.stats.retries == 9, "browse without usable servers not retried");
+    load(&disc, e, 2, 3600, now);
+    CHECK(disc.retryMs == APP_DISC_RETRY_MS && disc.nextBrowseMs == now + 3600000u, "backoff not reset");
+}
+
+int main(int argc, char **argv)
+{
+    unsigned draws = argc > 1 ? (unsigned) strtoul(argv[1], NULL, 0) : 200000;
+    uint32_t seed = argc > 2 ? (uint32_t) strtoul(argv[2], NULL, 0) : 1;
+    if (draws == 0)
+    {
+        fprintf(stderr, "usage: %s [draws] [seed]\n", argv[0]);
+        return 2;
+    }
+
+    checkSelect(draws, seed);
+    checkFail(seed);
+    checkEnd(seed);
+    printf("%s, %u failed checks\n", errors ? "FAILED" : "ok", errors);
+    return errors == 0 ? 0 : 1;
+}
@@ -0,0 +1,249 @@
+/*
+ * ipr_app.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: edward62740
+ *
+ *  Runs the firmware's radar application loop (../ipr/radar_app.c) natively on
+ *  the host shim (shim/), driven by a recorded presence trace. Mirrors main():
+ *  radarAppInit(), initBURTC(), initRadar(), then radarAppAlgo() and sleep in a
+ *  loop, with the BURTC ISR posting frame events exactly as on target.
+ *
+ *  Reports frames, modelled awake time, CoAP sends and payload bytes per trace,
+ *  and the radio wakes and bytes on air per day of the reports (shim air-time model).
+ *  Built twice: ipr_app (synchronous) and ipr_app_async (RADAR_APP_ASYNC_MEASUREMENT=1).
+ *
+ *  With a lossy link (-l, -o) it also reports how the state reports fared: the
+ *  delivery queue's counters and RTT (app_txq.h), and for how long the server
+ *  did not have the latest state.
+ *
+ *  With -t it writes the trace ring (trace_rec.h) as a GET on the "trace"
+ *  resource would return it, for trace_decode, and reports the hours it holds.
+ *
+ *  usage: ipr_app [-P policy] [-c connect_ms] [-b] [-B] [-l loss%] [-o every_s:for_s] [-q] [-t dump.bin] [-v] trace.csv...
+ *      -b  the server accepts the binary payload (app_payload.h)
+ *      -B  the server accepts batched alive telemetry (app_batch.h)
+ *      -l  confirmable exchanges lost after all retransmissions, in %
+ *      -o  detached for for_s out of every every_s seconds
+ *      -q  no delivery queue, one attempt per state report as before
+ *      -t  dump of the trace ring at the end of the (last) trace
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "shim.h"
+#include "radar_app.h"
+#include "app_payload.h"
+#include "app_batch.h"
+#include "opt3001.h"
+#include "trace_rec.h"
+#include "em_burtc.h"
+#include "sl_sleeptimer.h"
+
+static bool verbose;
+static uint32_t stateSends, aliveSends;
+
+/* Same as BURTC_IRQHandler() in main.c */
+static void burtcIrq(void)
+{
+    radarEvt_t evt = { .tick = sl_sleeptimer_get_tick_count(), .type = RADAR_EVT_FRAME_DUE };
+    radarEvqPush(&radarEvq, &evt);
+}
+
+static void onSend(uint64_t tUs, const uint8_t *payload, size_t len, uint32_t contentFormat, bool confirmable)
+{
+    if (confirmable) stateSends++;
+    else aliveSends++;
+    if (!verbose) return;
+
+    char text[128];
+    const char *kind = "txt";
+    appPayload_t p;
+    appBatchHeader_t hdr;
+    appBatchSample_t samples[APP_BATCH_SAMPLES];
+    if (contentFormat == APP_PAYLOAD_CONTENT_FORMAT)
+    {
+        kind = "bin";
+        if (appPayloadDecode(payload, len, &p)) appPayloadFormatCsv(&p, text, sizeof(text));
+        else snprintf(text, sizeof(text), "(bad payload)");
+    }
+    else if (contentFormat == APP_BATCH_CONTENT_FORMAT)
+    {
+        kind = "bat";
+        if (appBatchDecode(payload, len, &hdr, samples, APP_BATCH_SAMPLES))
+        {
+            snprintf(text, sizeof(text), "%u samples every %u s, newest %u s old, last score %lu lux %lu rssi %d",
+                     hdr.count, hdr.intervalS, hdr.ageS, hdr.count ? (unsigned long) samples[hdr.count - 1].score : 0,
+                     hdr.count ? (unsigned long) samples[hdr.count - 1].lux : 0, hdr.count ? samples[hdr.count - 1].rssi : 0);
+        }
+        else snprintf(text, sizeof(text), "(bad batch)");
+    }
+    else snprintf(text, sizeof(text), "%.*s", (int) len, (const char *) payload);
+    printf("%10.3f %s %s %2zu %s\n", tUs / 1e6, confirmable ? "CON" : "NON", kind, len, text);
+}
+
+static void connectCb(sl_sleeptimer_timer_handle_t *handle, void *data)
+{
+    (void) handle;
+    (void) data;
+    shimCoapSetConnected(true);
+}
+
+/* Writes all blocks of the ring, oldest first, and reports the time they cover */
+static bool dumpTrace(const char *path)
+{
+    FILE *f = fopen(path, "wb");
+    if (f == NULL)
+    {
+        perror(path);
+        return false;
+    }
+    // Block times wrap, each step from one block to the next is shorter than that
+    uint8_t blk[TRACE_REC_BLOCK_SIZE];
+    size_t n = traceRecBlockCount();
+    uint64_t heldMs = 0;
+    uint32_t t = 0;
+    for (size_t i = 0; i < n && traceRecReadBlock(i, blk); i++)
+    {
+        uint32_t t0 = (uint32_t) blk[2] | (uint32_t) blk[3] << 8 | (uint32_t) blk[4] << 16 | (uint32_t) blk[5] << 24;
+        if (i > 0) heldMs += (t0 + TRACE_REC_T0_WRAP_MS - t) % TRACE_REC_T0_WRAP_MS;
+        t = t0;
+        fwrite(blk, 1, sizeof(blk), f);
+    }
+    fclose(f);
+    uint32_t nowMs = sl_sleeptimer_tick_to_ms(sl_sleeptimer_get_tick_count());
+    if (n) heldMs += (nowMs + TRACE_REC_T0_WRAP_MS - t) % TRACE_REC_T0_WRAP_MS;
+    double heldH = heldMs / 3.6e6;
+    printf("  trace: %zu blocks (%zu B), %.1f h held\n", n, n * TRACE_REC_BLOCK_SIZE, heldH);
+    return true;
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr, "usage: %s [-P policy] [-c connect_ms] [-b] [-B] [-l loss%%] [-o every_s:for_s] [-q] [-t dump.bin] [-v] trace...\n",
+            prog);
+}
+
+int main(int argc, char **argv)
+{
+    const char *policy = NULL, *dumpPath = NULL;
+    uint32_t connectMs = 0;
+    bool binary = false, batch = false, queue = true, link = false;
+    unsigned lossPct = 0, outageEveryS = 0, outageForS = 0;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "P:c:bBl:o:qt:vh")) != -1)
+    {
+        switch (opt)
+        {
+        case 'P': policy = optarg; break;
+        case 'c': connectMs = (uint32_t) atoi(optarg); break;
+        case 'b': binary = true; break;
+        case 'B': batch = true; break;
+        case 'l': lossPct = (unsigned) atoi(optarg); link = true; break;
+        case 'o':
+            if (sscanf(optarg, "%u:%u", &outageEveryS, &outageForS) != 2)
+            {
+                usage(argv[0]);
+                return 2;
+            }
+            link = true;
+            break;
+        case 'q': queue = false; link = true; break;
+        case 't': dumpPath = optarg; break;
+        case 'v': verbose = true; break;
+        default: usage(argv[0]); return 2;
+        }
+    }
+    if (optind >= argc)
+    {
+        usage(argv[0]);
+        return 2;
+    }
+
+    printf("%-24s %8s %7s %9s %9s %9s %7s %6s %6s %8s %8s %9s\n",
+           "trace", "dur[s]", "frames", "getnx[ms]", "post[ms]", "ovlp[ms]", "awake%", "state", "alive", "bytes",
+           "wakes/d", "air[B]/d");
+
+    int status = 0;
+    for (int i = optind; i < argc; i++)
+    {
+        trace_t trace;
+        if (!traceLoad(&trace, argv[i]))
+        {
+            fprintf(stderr, "cannot load %s\n", argv[i]);
+            status = 1;
+            continue;
+        }
+
+        shimCoapGetStats()->onSend = onSend;
+        stateSends = aliveSends = 0;
+        shimInit(&trace, NULL);
+        shimCoapSetBinary(binary);
+        shimCoapSetBatch(batch);
+        shimCoapSetLink((uint8_t) (lossPct > 100 ? 100 : lossPct), outageEveryS, outageForS, queue);
+        shimSetBurtcHandler(burtcIrq);
+
+        radarAppInit(0x0123456789abcdefULL);
+        if (policy != NULL && !radarAppSetPolicy(policy))
+        {
+            fprintf(stderr, "unknown policy %s\n", policy);
+            return 2;
+        }
+
+        // initBURTC()
+        BURTC_CounterReset();
+        BURTC_CompareSet(0, radarAlgo.delayMs);
+        BURTC_Enable(true);
+
+        sl_sleeptimer_timer_handle_t connectTimer = { 0 };
+        if (connectMs) sl_sleeptimer_start_timer_ms(&connectTimer, connectMs, connectCb, NULL, 0, 0);
+        else shimCoapSetConnected(true);
+
+        initRadar();
+
+        const uint64_t endUs = (uint64_t) traceDurationMs(&trace) * 1000;
+        uint64_t postUs = 0;
+        uint32_t frames = 0;
+        while (shimNowUs() < endUs)
+        {
+            opt3001_process();
+            radarAppAlgo();
+
+            const shimStats_t *st = shimGetStats();
+            if (st->getNextCalls != frames)
+            {
+                radarAppTiming_t timing;
+                radarAppGetTiming(&timing);
+                postUs += timing.postUs;
+                frames = st->getNextCalls;
+            }
+            if (!shimSleep()) break;
+        }
+
+        const shimStats_t *st = shimGetStats();
+        const shimCoapStats_t *coap = shimCoapGetStats();
+        double dur = shimNowUs() / 1e6;
+        double perDay = dur > 0 ? 86400.0 / dur : 0.0;
+        printf("%-24.24s %8.0f %7u %9.2f %9.2f %9.2f %7.3f %6u %6u %8u %8.0f %9.0f\n",
+               trace.name, dur, st->getNextCalls,
+               st->getNextCalls ? st->getNextUs / 1e3 / st->getNextCalls : 0.0,
+               st->getNextCalls ? postUs / 1e3 / st->getNextCalls : 0.0,
+               st->getNextCalls ? st->overlapUs / 1e3 / st->getNextCalls : 0.0,
+               dur > 0 ? 100.0 * st->awakeUs / 1e6 / dur : 0.0,
+               stateSends, aliveSends, coap->bytes, coap->wakes * perDay, coap->airBytes * perDay);
+        if (link)
+        {
+            const appTxqStats_t *q = shimCoapQueueStats();
+            printf("  state reports: %u, exchanges %u delivered %u lost, queue: %u coalesced %u retries %u dropped, "
+                   "rtt %u/%u ms (srtt/max), latency max %.1f s, server stale %.1f s (%.2f%%)\n",
+                   queue ? q->pushed : stateSends, coap->delivered, coap->lost, q->coalesced, q->retries,
+                   q->dropped + q->failed, q->srttMs, q->rttMaxMs, q->latencyMaxMs / 1e3, coap->staleUs / 1e6,
+                   dur > 0 ? 100.0 * coap->staleUs / 1e6 / dur : 0.0);
+        }
+        if (dumpPath != NULL && !dumpTrace(dumpPath)) status = 1;
+        traceFree(&trace);
+    }
+    return status;
+}
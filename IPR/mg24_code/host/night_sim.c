@@ -0,0 +1,172 @@
+/*
+ * night_sim.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: edward62740
+ *
+ *  Replays multi-day traces with a lux column through the radar state machine:
+ *  at the normal frame rate, with the night-mode scheduler (radar_night.c)
+ *  gating it, and with the gating plus the OPT3001 light-change hint. Reports the
+ *  average current, the time in night mode, the detections lost, and the mean
+ *  time-to-detect of each run, over all onsets and over those where the light
+ *  went on in the dark (the ones a hint can speed up). -n leaves night mode out, to compare the hint
+ *  against the plain frame rate.
+ *
+ *  -g writes a synthetic day/night trace instead (stdout). Each day has a dark,
+ *  empty night with an occasional walk-through, sometimes with the light on, a
+ *  morning, an empty daylit day and a lit evening:
+ *      night_sim -g 7 -s 1 > traces/week_daynight.csv
+ *
+ *  usage: night_sim [-n] [-g days] [-s seed] trace.csv...
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "sim.h"
+
+#define H(x) ((uint32_t) ((x) * 3600))
+
+static double uniform(unsigned *seed, double lo, double hi)
+{
+    return lo + (hi - lo) * rand_r(seed) / RAND_MAX;
+}
+
+static bool chance(unsigned *seed, double p)
+{
+    return uniform(seed, 0, 1) < p;
+}
+
+/* Occupied: sample every 5 s, mostly detected. Vacant: every 60 s, rare single-sweep false positive */
+static void genSpan(unsigned *seed, uint32_t fromS, uint32_t toS, bool occupied, double luxLo, double luxHi)
+{
+    uint32_t step = occupied ? 5 : 60;
+    for (uint32_t t = fromS; t < toS; t += step)
+    {
+        bool detected = occupied ? chance(seed, 0.85) : chance(seed, 0.005);
+        double score = detected ? uniform(seed, 1.5, 3.0) : uniform(seed, 0.2, 1.0);
+        double lux = uniform(seed, luxLo, luxHi);
+        printf("%lu,%d,%.3f,%.3f,%d,%.1f\n", (unsigned long) t * 1000, detected, score,
+               uniform(seed, 0.5, 2.5), occupied, lux);
+        // A false detection lasts one sweep, not the whole hold interval
+        if (detected && !occupied)
+            printf("%lu,0,%.3f,%.3f,0,%.1f\n", (unsigned long) t * 1000 + 1000, uniform(seed, 0.2, 1.0),
+                   uniform(seed, 0.5, 2.5), lux);
+    }
+}
+
+static void generate(unsigned days, unsigned seed)
+{
+    printf("# Synthetic day/night trace: t_ms,presence_detected,presence_score,presence_distance,truth,lux\n"
+           "# %u days, seed %u (night_sim -g). Dark empty nights with occasional walk-throughs,\n"
+           "# lit morning and evening occupancy, daylit empty day.\n", days, seed);
+
+    for (unsigned d = 0; d < days; d++)
+    {
+        uint32_t day = d * H(24);
+        uint32_t wake = day + H(6.5) + (uint32_t) uniform(&seed, 0, H(0.5));
+        uint32_t leave = day + H(8) + (uint32_t) uniform(&seed, 0, H(0.5));
+        uint32_t back = day + H(17.5) + (uint32_t) uniform(&seed, 0, H(1));
+        uint32_t bed = day + H(22.5) + (uint32_t) uniform(&seed, 0, H(1));
+
+        if (chance(&seed, 0.4))
+        {
+            // Walk-through at night, light on half of the time
+            uint32_t at = day + H(1) + (uint32_t) uniform(&seed, 0, H(4));
+            uint32_t len = 60 + (uint32_t) uniform(&seed, 0, 120);
+            double lux = chance(&seed, 0.5) ? 150 : 0.5;
+            genSpan(&seed, day, at, false, 0.1, 1);
+            genSpan(&seed, at, at + len, true, lux, lux * 1.1);
+            genSpan(&seed, at + len, wake, false, 0.1, 1);
+        }
+        else genSpan(&seed, day, wake, false, 0.1, 1);
+
+        genSpan(&seed, wake, leave, true, 200, 300);
+        genSpan(&seed, leave, back, false, 300, 800);
+        genSpan(&seed, back, bed, true, 250, 350);
+        genSpan(&seed, bed, day + H(24), false, 0.1, 1);
+    }
+}
+
+static double meanS(uint64_t sumMs, uint32_t n)
+{
+    return n ? sumMs / 1000.0 / n : 0;
+}
+
+int main(int argc, char **argv)
+{
+    unsigned genDays = 0, seed = 1;
+    bool gate = true;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "ng:s:h")) != -1)
+    {
+        switch (opt)
+        {
+        case 'g': genDays = (unsigned) atoi(optarg); break;
+        case 's': seed = (unsigned) atoi(optarg); break;
+        case 'n': gate = false; break;
+        default:
+            fprintf(stderr, "usage: %s [-n] [-g days] [-s seed] trace...\n", argv[0]);
+            return 2;
+        }
+    }
+    if (genDays)
+    {
+        generate(genDays, seed);
+        return 0;
+    }
+    if (optind >= argc)
+    {
+        fprintf(stderr, "usage: %s [-n] [-g days] [-s seed] trace...\n", argv[0]);
+        return 2;
+    }
+
+    simEnergyModel_t model;
+    simDefaultEnergyModel(&model);
+    radarAlgoParams_t params;
+    radarAlgoDefaultParams(&params);
+
+    printf("night: %s, < %.0f lux, slot %u min, learn %u days, %u ms frames\n"
+           "hint:  > %.0f lux, %u ms latency, %u boost frames\n\n",
+           gate ? "on" : "off", RADAR_NIGHT_DARK_LUX, RADAR_NIGHT_SLOT_S / 60, RADAR_NIGHT_LEARN_DAYS,
+           RADAR_NIGHT_FRAME_SPACING_MS, RADAR_NIGHT_WAKE_LUX, SIM_LIGHT_HINT_LATENCY_MS,
+           RADAR_APP_DEFAULT_BOOST_FRAMES);
+    printf("%-16s %6s | %6s %6s %6s | %6s %6s %5s %5s | %6s %6s %6s | %5s %6s %6s %6s | %6s %6s\n",
+           "trace", "dur[h]", "I[uA]", "Inight", "Ihint", "night%", "enters", "hints", "det",
+           "ttd[s]", "night", "hint", "lit", "ttd[s]", "night", "hint", "missed", "m_hint");
+
+    int status = 0;
+    for (int i = optind; i < argc; i++)
+    {
+        trace_t trace;
+        if (!traceLoad(&trace, argv[i]))
+        {
+            fprintf(stderr, "%s: cannot load trace\n", argv[i]);
+            status = 1;
+            continue;
+        }
+
+        simResult_t base, gated, hinted;
+        radarNight_t night, nightHint;
+        radarNightInit(&night);
+        radarNightInit(&nightHint);
+        simRun(&trace, &params, &base);
+        simRunNight(&trace, &params, gate ? &night : NULL, false, &gated);
+        simRunNight(&trace, &params, gate ? &nightHint : NULL, true, &hinted);
+
+        printf("%-16.16s %6.1f | %6.1f %6.1f %6.1f | %5.1f%% %6u %5u %2u/%-2u | %6.2f %6.2f %6.2f "
+               "| %5u %6.2f %6.2f %6.2f | %6u %6u\n",
+               trace.name, base.durationMs / 3.6e6, simAverageCurrentUa(&base, &model),
+               simAverageCurrentUa(&gated, &model), simAverageCurrentUa(&hinted, &model),
+               base.durationMs ? 100.0 * gated.nightMs / base.durationMs : 0.0, gated.nightEnters, hinted.hints,
+               hinted.detected, hinted.onsets, meanS(base.ttdSumMs, base.detected),
+               meanS(gated.ttdSumMs, gated.detected), meanS(hinted.ttdSumMs, hinted.detected),
+               base.litOnsets, meanS(base.litTtdSumMs, base.litDetected),
+               meanS(gated.litTtdSumMs, gated.litDetected), meanS(hinted.litTtdSumMs, hinted.litDetected),
+               gated.nightMissed, hinted.nightMissed);
+        traceFree(&trace);
+    }
+    return status;
+}
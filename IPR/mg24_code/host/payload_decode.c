@@ -0,0 +1,279 @@
+/*
+ * payload_decode.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: edward62740
+ *
+ *  Reference decoder for the binary report payload (../ipr/app_payload.h) and
+ *  the batched alive telemetry (../ipr/app_batch.h, -B). Each argument, or each
+ *  stdin line without arguments, is one payload in hex (whitespace ignored).
+ *  Reports are printed in the text payload format, followed by the fields only
+ *  the binary payload carries. Batches print one line per sample.
+ *
+ *  -r runs a round-trip check instead: n random payloads of both kinds are
+ *  encoded, decoded and compared field by field, and their text forms are
+ *  compared with the text the node would have sent. Short, truncated and
+ *  unknown-version payloads must be rejected. Random batches are checked the
+ *  same way, within the quantisation of app_batch.h. Exits 1 on any mismatch.
+ *
+ *  usage: payload_decode [-B] [hex...]
+ *         payload_decode -r n [-s seed]
+ */
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "app_payload.h"
+#include "app_batch.h"
+
+static int hexNibble(int c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    c = tolower(c);
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+/* Returns the number of bytes, -1 on a bad digit or an odd count */
+static int parseHex(const char *s, uint8_t *buf, size_t len)
+{
+    size_t n = 0;
+    int hi = -1;
+    for (; *s; s++)
+    {
+        if (isspace((unsigned char) *s)) continue;
+        int v = hexNibble(*s);
+        if (v < 0 || n >= len) return -1;
+        if (hi < 0) hi = v;
+        else
+        {
+            buf[n++] = (uint8_t) (hi << 4 | v);
+            hi = -1;
+        }
+    }
+    return hi < 0 ? (int) n : -1;
+}
+
+static bool decodeHex(const char *hex, bool batch)
+{
+    uint8_t buf[256];
+    appPayload_t p;
+    appBatchHeader_t hdr;
+    appBatchSample_t samples[UINT8_MAX];
+    char text[160];
+
+    int n = parseHex(hex, buf, sizeof(buf));
+    if (n >= 0 && batch && appBatchDecode(buf, (size_t) n, &hdr, samples, UINT8_MAX))
+    {
+        printf("%u,%08lx%08lx,tx=%lu,eol_days=%u,soc=%u,level=%u,arena_peak=%u,arena_failed=%u,arena_frag=%u\n",
+               hdr.deviceType, (unsigned long) (hdr.eui64 >> 32), (unsigned long) (hdr.eui64 & 0xFFFFFFFF),
+               (unsigned long) hdr.txCtr, hdr.eolDays, hdr.soc, hdr.battLevel, hdr.arenaPeak, hdr.arenaFailed,
+               hdr.arenaFragPct);
+        // Sample i was taken (count - 1 - i) intervals before the newest one
+        for (unsigned i = 0; i < hdr.count; i++)
+        {
+            printf("  t-%lus score=%lu lux=%lu vdd_mv=%lu rssi=%d\n",
+                   (unsigned long) hdr.ageS + (unsigned long) (hdr.count - 1 - i) * hdr.intervalS,
+                   (unsigned long) samples[i].score, (unsigned long) samples[i].lux,
+                   (unsigned long) samples[i].vddMv, samples[i].rssi);
+        }
+        return true;
+    }
+    if (n < 0 || batch || !appPayloadDecode(buf, (size_t) n, &p))
+    {
+        fprintf(stderr, "bad payload: %s\n", hex);
+        return false;
+    }
+    appPayloadFormatCsv(&p, text, sizeof(text));
+    printf("%s vdd_mv=%lu\n", text, (unsigned long) p.vddMv);
+    return true;
+}
+
+static uint32_t randBits(unsigned *seed, unsigned bits)
+{
+    uint32_t v = ((uint32_t) rand_r(seed) << 16) ^ (uint32_t) rand_r(seed);
+    return bits >= 32 ? v : v & ((1u << bits) - 1);
+}
+
+/* Random fields in the ranges the node produces, with occasional out-of-range values */
+static void randomPayload(unsigned *seed, appPayload_t *p)
+{
+    memset(p, 0, sizeof(*p));
+    p->kind = (appPayloadKind_t) (randBits(seed, 8) % 3);
+    p->deviceType = (uint8_t) randBits(seed, 2);
+    p->eui64 = (uint64_t) randBits(seed, 32) << 32 | randBits(seed, 32);
+    p->score = randBits(seed, randBits(seed, 4) ? 14 : 20);
+    p->distance = randBits(seed, 11);
+    p->lux = randBits(seed, randBits(seed, 1) ? 20 : 32);
+    p->vddMv = 1800 + randBits(seed, 11);
+    p->eolDays = randBits(seed, 10);
+    p->rssi = (int8_t) -(int) randBits(seed, 7);
+    p->txCtr = randBits(seed, randBits(seed, 1) ? 12 : 32);
+    if (p->kind == APP_PAYLOAD_ALIVE)
+    {
+        p->arenaPeak = randBits(seed, 15);
+        p->arenaFailed = randBits(seed, 3);
+        p->arenaFragPct = (uint8_t) (randBits(seed, 8) % 101);
+        p->soc = (uint8_t) (randBits(seed, 8) % 101);
+        p->battLevel = (uint8_t) (randBits(seed, 8) % 3);
+    }
+}
+
+static uint32_t sat16(uint32_t v)
+{
+    return v > UINT16_MAX ? UINT16_MAX : v;
+}
+
+static bool samePayload(const appPayload_t *a, const appPayload_t *b)
+{
+    return a->kind == b->kind && a->deviceType == b->deviceType && a->eui64 == b->eui64
+            && sat16(a->score) == b->score && sat16(a->distance) == b->distance && a->lux == b->lux
+            && sat16(a->vddMv) == b->vddMv && sat16(a->eolDays) == b->eolDays && a->rssi == b->rssi
+            && a->txCtr == b->txCtr && sat16(a->arenaPeak) == b->arenaPeak
+            && sat16(a->arenaFailed) == b->arenaFailed && a->arenaFragPct == b->arenaFragPct
+            && a->soc == b->soc && a->battLevel == b->battLevel;
+}
+
+static int roundTrip(unsigned n, unsigned seed)
+{
+    unsigned failures = 0, saturated = 0;
+    size_t binBytes[3] = { 0 }, textBytes[3] = { 0 }, count[3] = { 0 }, textMax = 0;
+
+    for (unsigned i = 0; i < n; i++)
+    {
+        appPayload_t in, out;
+        uint8_t buf[APP_PAYLOAD_MAX_SIZE + 4];
+        char textIn[160], textOut[160];
+
+        randomPayload(&seed, &in);
+        size_t len = appPayloadEncode(&in, buf, APP_PAYLOAD_MAX_SIZE);
+        size_t want = in.kind == APP_PAYLOAD_ALIVE ? APP_PAYLOAD_ALIVE_SIZE : APP_PAYLOAD_STATE_SIZE;
+        int textLen = appPayloadFormatCsv(&in, textIn, sizeof(textIn));
+
+        bool ok = len == want && appPayloadDecode(buf, len, &out) && samePayload(&in, &out);
+        if (ok && in.score <= UINT16_MAX && in.eolDays <= UINT16_MAX)
+        {
+            // Unsaturated payloads must give the text the node would have sent
+            appPayloadFormatCsv(&out, textOut, sizeof(textOut));
+            ok = strcmp(textIn, textOut) == 0;
+        }
+        else if (ok) saturated++;
+
+        // A truncated payload, a foreign version and a too small buffer are rejected
+        ok = ok && !appPayloadDecode(buf, len - 1, &out) && appPayloadEncode(&in, buf, len - 1) == 0;
+        appPayloadEncode(&in, buf, sizeof(buf));
+        buf[0] = APP_PAYLOAD_VERSION + 1;
+        ok = ok && !appPayloadDecode(buf, len, &out);
+
+        // Appended fields of a later revision are ignored
+        buf[0] = APP_PAYLOAD_VERSION;
+        memset(buf + len, 0xA5, 4);
+        ok = ok && appPayloadDecode(buf, len + 4, &out) && samePayload(&in, &out);
+
+        if (!ok)
+        {
+            if (failures++ < 5) fprintf(stderr, "mismatch %u: %s\n", i, textIn);
+            continue;
+        }
+        binBytes[in.kind] += len;
+        textBytes[in.kind] += (size_t) textLen;
+        count[in.kind]++;
+        if ((size_t) textLen > textMax) textMax = (size_t) textLen;
+    }
+
+    static const char *names[] = { "alive", "inactive", "active" };
+    printf("%u payloads, %u failed, %u with saturated fields\n\n", n, failures, saturated);
+    printf("%-9s %7s %9s %9s\n", "kind", "count", "bin[B]", "text[B]");
+    for (int k = 0; k < 3; k++)
+    {
+        printf("%-9s %7zu %9.1f %9.1f\n", names[k], count[k], count[k] ? (double) binBytes[k] / count[k] : 0.0,
+               count[k] ? (double) textBytes[k] / count[k] : 0.0);
+    }
+    printf("longest text %zu B, binary at most %d B\n", textMax, APP_PAYLOAD_MAX_SIZE);
+    return failures ? 1 : 0;
+}
+
+/* Random walks like the alive samples of a quiet room, with occasional jumps */
+static int batchRoundTrip(unsigned n, unsigned seed)
+{
+    unsigned failures = 0, batches = 0;
+    size_t bytes = 0, samplesSent = 0;
+    appBatch_t batch;
+    appBatchSample_t in[APP_BATCH_SAMPLES], out[APP_BATCH_SAMPLES];
+    appBatchSample_t s = { .score = 800, .lux = 120000, .vddMv = 2900, .rssi = -60 };
+    uint8_t buf[APP_BATCH_HEADER_SIZE + APP_BATCH_MAX_BYTES];
+
+    appBatchInit(&batch);
+    for (unsigned i = 0; i < n; i++)
+    {
+        bool jump = randBits(&seed, 5) == 0;
+        s.score = jump ? randBits(&seed, 14) : s.score + randBits(&seed, 7) - (s.score >= 64 ? 64 : 0);
+        s.lux = jump ? randBits(&seed, 24) : s.lux + randBits(&seed, 12) - (s.lux >= 2048 ? 2048 : 0);
+        s.vddMv = 2000 + randBits(&seed, 10);
+        s.rssi = (int8_t) (-40 - (int) randBits(&seed, 5));
+        in[batch.count] = s;
+        if (!appBatchAdd(&batch, &s, i * 60) && i + 1 < n) continue;
+
+        appBatchHeader_t hdr = { .eui64 = 0x0123456789abcdefULL, .txCtr = i, .intervalS = 60 }, got;
+        size_t len = appBatchEncode(&batch, &hdr, i * 60 + 7, buf, sizeof(buf));
+        bool ok = len > 0 && appBatchDecode(buf, len, &got, out, APP_BATCH_SAMPLES)
+                && got.count == batch.count && got.ageS == 7 && got.eui64 == hdr.eui64 && got.txCtr == i;
+        for (unsigned k = 0; ok && k < batch.count; k++)
+        {
+            ok = (out[k].score + 5) / 10 == (in[k].score + 5) / 10 && out[k].lux / 1000 == in[k].lux / 1000
+                    && out[k].vddMv == in[k].vddMv && out[k].rssi == in[k].rssi;
+        }
+        ok = ok && !appBatchDecode(buf, len - 1, &got, out, APP_BATCH_SAMPLES);
+        if (!ok && failures++ < 5) fprintf(stderr, "batch mismatch at sample %u\n", i);
+        batches++;
+        bytes += len;
+        samplesSent += batch.count;
+        appBatchInit(&batch);
+    }
+    printf("%zu batch samples in %u batches, %u failed, %.1f B per batch, %.1f B per sample\n",
+           samplesSent, batches, failures, batches ? (double) bytes / batches : 0.0,
+           samplesSent ? (double) bytes / samplesSent : 0.0);
+    return failures ? 1 : 0;
+}
+
+int main(int argc, char **argv)
+{
+    unsigned rounds = 0, seed = 1;
+    bool batch = false;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "Br:s:h")) != -1)
+    {
+        switch (opt)
+        {
+        case 'r': rounds = (unsigned) atoi(optarg); break;
+        case 's': seed = (unsigned) atoi(optarg); break;
+        case 'B': batch = true; break;
+        default:
+            fprintf(stderr, "usage: %s [-B] [hex...]\n       %s -r n [-s seed]\n", argv[0], argv[0]);
+            return 2;
+        }
+    }
+    if (rounds)
+    {
+        int status = roundTrip(rounds, seed);
+        return batchRoundTrip(rounds, seed) || status;
+    }
+
+    int status = 0;
+    if (optind < argc)
+    {
+        for (int i = optind; i < argc; i++) if (!decodeHex(argv[i], batch)) status = 1;
+        return status;
+    }
+
+    char line[1024];
+    while (fgets(line, sizeof(line), stdin))
+    {
+        if (line[0] == '#' || line[strspn(line, " \t\r\n")] == '\0') continue;
+        if (!decodeHex(line, batch)) status = 1;
+    }
+    return status;
+}
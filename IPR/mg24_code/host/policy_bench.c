@@ -0,0 +1,87 @@
+/*
+ * policy_bench.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: edward62740
+ *
+ *  Scores every frame-rate policy (radar_policy.c) on a set of recorded traces
+ *  by expected average current and detection latency.
+ *
+ *  usage: policy_bench [-b base_uA] [-f frame_uC] [-s send_uC] trace.csv...
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "sim.h"
+
+int main(int argc, char **argv)
+{
+    simEnergyModel_t model;
+    simDefaultEnergyModel(&model);
+
+    int opt;
+    while ((opt = getopt(argc, argv, "b:f:s:h")) != -1)
+    {
+        switch (opt)
+        {
+        case 'b': model.baseCurrentUa = atof(optarg); break;
+        case 'f': model.frameChargeUc = atof(optarg); break;
+        case 's': model.sendChargeUc = atof(optarg); break;
+        default:
+            fprintf(stderr, "usage: %s [-b base_uA] [-f frame_uC] [-s send_uC] trace...\n", argv[0]);
+            return 2;
+        }
+    }
+    if (optind >= argc)
+    {
+        fprintf(stderr, "usage: %s [-b base_uA] [-f frame_uC] [-s send_uC] trace...\n", argv[0]);
+        return 2;
+    }
+
+    int nTraces = argc - optind;
+    trace_t *traces = calloc((size_t) nTraces, sizeof(*traces));
+    if (traces == NULL) return 1;
+    for (int i = 0; i < nTraces; i++)
+    {
+        if (!traceLoad(&traces[i], argv[optind + i]))
+        {
+            fprintf(stderr, "%s: cannot load trace\n", argv[optind + i]);
+            return 1;
+        }
+    }
+
+    printf("model: %.1f uA + %.1f uC/frame + %.1f uC/send\n\n", model.baseCurrentUa, model.frameChargeUc, model.sendChargeUc);
+    printf("%-12s %8s %10s %8s %8s %8s %8s %8s\n",
+           "policy", "I[uA]", "frames/h", "det[%]", "ttd[s]", "ttdmax", "ttc[s]", "spurious");
+
+    for (int p = 0; p < RADAR_POLICY_COUNT; p++)
+    {
+        radarAlgoParams_t params;
+        radarAlgoDefaultParams(&params);
+        params.policy = (radarPolicyId_t) p;
+
+        simResult_t sum = { 0 };
+        for (int i = 0; i < nTraces; i++)
+        {
+            simResult_t r;
+            simRun(&traces[i], &params, &r);
+            simAccumulate(&sum, &r);
+        }
+
+        double hours = sum.durationMs / 3600000.0;
+        printf("%-12s %8.1f %10.1f %8.1f %8.2f %8.2f %8.2f %8u\n",
+               radarPolicyGet(params.policy)->name,
+               simAverageCurrentUa(&sum, &model),
+               hours > 0 ? sum.frames / hours : 0.0,
+               sum.onsets ? 100.0 * sum.detected / sum.onsets : 0.0,
+               sum.detected ? (double) sum.ttdSumMs / sum.detected / 1000.0 : 0.0,
+               sum.ttdMaxMs / 1000.0,
+               sum.cleared ? (double) sum.ttcSumMs / sum.cleared / 1000.0 : 0.0,
+               sum.spuriousReports);
+    }
+
+    for (int i = 0; i < nTraces; i++) traceFree(&traces[i]);
+    free(traces);
+    return 0;
+}
@@ -0,0 +1,310 @@
+/*
+ * poll_sim.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: edward62740
+ *
+ *  Downlink latency and data poll current of the sleepy end device under the
+ *  fixed 5 s poll period, a fixed 500 ms one, the adaptive poll period
+ *  (app_poll.c) and CSL (app_link.c). All of them see the same synthetic traffic:
+ *  - confirmable state reports at random times, each answered by the server
+ *    after SERVER_RTT_MIN_MS..SERVER_RTT_MAX_MS. They go through the firmware's
+ *    delivery queue (app_txq.c), whose RTT estimate drives the fast poll period;
+ *  - server transactions at random times, 1 to MAX_TXN_REQUESTS requests, each
+ *    sent after the server got the response to the previous one (permissions
+ *    then policy, a diag read, a Block2 trace read).
+ *  The parent holds each downlink frame until the next poll. A poll that finds a
+ *  frame pending polls again at once. Under CSL the parent sends each frame in
+ *  the next receive window of the child instead, which only polls every
+ *  APP_LINK_CSL_KEEPALIVE_MS to stay attached.
+ *
+ *  Reports polls per day, the average current of the polls and CSL windows (sleep,
+ *  the sensor and uplink are the same for all), the latency from a frame
+ *  reaching the parent to its delivery, and the duration of the server
+ *  transactions.
+ *
+ *  usage: poll_sim [-d days] [-r reports_per_day] [-t transactions_per_day] [-s seed]
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "app_link.h"
+#include "app_poll.h"
+#include "app_txq.h"
+
+#define SERVER_RTT_MIN_MS   40
+#define SERVER_RTT_MAX_MS   250
+#define SERVER_THINK_MS     300  // server turnaround within a transaction, at most
+#define PATH_MS             20   // border router to parent, either way
+#define MAX_TXN_REQUESTS    4
+#define MAX_PENDING         16
+
+typedef struct
+{
+    const char *name;
+    uint32_t fixedMs; // 0: adaptive
+    uint32_t cslMs;   // CSL period, polling at the keepalive period
+} policy_t;
+
+static const policy_t policies[] = {
+    { "fixed 5000 ms", 5000, 0 },
+    { "fixed 500 ms", 500, 0 },
+    { "adaptive", 0, 0 },
+    { "csl 500 ms", APP_LINK_CSL_KEEPALIVE_MS, 500 },
+    { "csl 1000 ms", APP_LINK_CSL_KEEPALIVE_MS, 1000 },
+};
+
+typedef struct
+{
+    uint64_t readyMs;
+    bool ack;
+    uint16_t seq;      // ack: the attempt it answers
+    uint8_t left;      // request: requests left in the transaction, this one included
+    uint64_t txnStartMs;
+} frame_t;
+
+typedef struct
+{
+    uint32_t *v;
+    size_t n, cap;
+} series_t;
+
+typedef struct
+{
+    uint64_t *reportMs;
+    size_t reports;
+    uint64_t *txnMs;
+    uint8_t *txnLen;
+    size_t txns;
+    unsigned seed;
+} traffic_t;
+
+static void seriesAdd(series_t *s, uint32_t v)
+{
+    if (s->n == s->cap)
+    {
+        s->cap = s->cap ? 2 * s->cap : 256;
+        s->v = realloc(s->v, s->cap * sizeof(*s->v));
+    }
+    s->v[s->n++] = v;
+}
+
+static int cmpU32(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *) a, y = *(const uint32_t *) b;
+    return (x > y) - (x < y);
+}
+
+static double seriesMean(const series_t *s)
+{
+    double sum = 0;
+    for (size_t i = 0; i < s->n; i++) sum += s->v[i];
+    return s->n ? sum / s->n : 0.0;
+}
+
+static uint32_t seriesPct(series_t *s, unsigned pct)
+{
+    if (s->n == 0) return 0;
+    qsort(s->v, s->n, sizeof(*s->v), cmpU32);
+    return s->v[(s->n - 1) * pct / 100];
+}
+
+static double uniform(unsigned *seed)
+{
+    return (double) rand_r(seed) / RAND_MAX;
+}
+
+static uint32_t between(unsigned *seed, uint32_t lo, uint32_t hi)
+{
+    return lo + (uint32_t) (uniform(seed) * (hi - lo));
+}
+
+/* Poisson arrivals over durMs */
+static size_t arrivals(unsigned *seed, double perDay, uint64_t durMs, uint64_t **out)
+{
+    size_t n = 0, cap = 64;
+    uint64_t *t = malloc(cap * sizeof(*t));
+    double meanMs = 86400000.0 / perDay;
+    for (double at = 0;;)
+    {
+        double u = uniform(seed);
+        at += -meanMs * log(u > 0 ? u : 1e-12);
+        if (at >= durMs) break;
+        if (n == cap) t = realloc(t, (cap *= 2) * sizeof(*t));
+        t[n++] = (uint64_t) at;
+    }
+    *out = t;
+    return n;
+}
+
+static void run(const policy_t *policy, const traffic_t *traffic, uint64_t durMs)
+{
+    appPoll_t poll;
+    appTxq_t txq;
+    frame_t pending[MAX_PENDING];
+    size_t npending = 0, nextReport = 0, nextTxn = 0;
+    series_t ackLat = { 0 }, reqLat = { 0 }, exchange = { 0 }, txnDur = { 0 };
+    uint64_t polls = 0, frames = 0;
+    unsigned seed = traffic->seed;
+    uint8_t report[8] = { 0 };
+
+    appPollInit(&poll, 0);
+    appTxqInit(&txq, traffic->seed);
+    uint32_t period = policy->fixedMs ? policy->fixedMs : poll.periodMs;
+    uint64_t lastPollMs = 0, nextPollMs = period;
+
+    for (;;)
+    {
+        uint64_t t = nextPollMs, sampleMs = UINT64_MAX;
+        for (size_t i = 0; policy->cslMs && i < npending; i++)
+        {
+            uint64_t w = (pending[i].readyMs + policy->cslMs - 1) / policy->cslMs * policy->cslMs;
+            if (w < sampleMs) sampleMs = w;
+        }
+        if (sampleMs < t) t = sampleMs;
+        if (nextReport < traffic->reports && traffic->reportMs[nextReport] < t) t = traffic->reportMs[nextReport];
+        if (nextTxn < traffic->txns && traffic->txnMs[nextTxn] < t) t = traffic->txnMs[nextTxn];
+        if (t >= durMs) break;
+
+        if (nextReport < traffic->reports && traffic->reportMs[nextReport] == t)
+        {
+            nextReport++;
+            appTxqPush(&txq, report, sizeof(report), 0, APP_TXQ_KEY_STATE, (uint32_t) t);
+        }
+        else if (nextTxn < traffic->txns && traffic->txnMs[nextTxn] == t)
+        {
+            if (npending < MAX_PENDING)
+            {
+                pending[npending++] = (frame_t) { .readyMs = t + PATH_MS, .ack = false,
+                                                  .left = traffic->txnLen[nextTxn], .txnStartMs = t };
+            }
+            nextTxn++;
+        }
+        else
+        {
+            // Poll: the parent hands over every frame that is ready, one poll each after the first.
+            // CSL window: the parent sends every frame that is ready
+            bool isPoll = t == nextPollMs;
+            if (isPoll)
+            {
+                polls++;
+                lastPollMs = t;
+            }
+            unsigned delivered = 0;
+            for (size_t i = 0; i < npending;)
+            {
+                frame_t f = pending[i];
+                if (f.readyMs > t)
+                {
+                    i++;
+                    continue;
+                }
+                pending[i] = pending[--npending];
+                frames++;
+                if (delivered++ && isPoll && !policy->cslMs) polls++;
+                if (f.ack)
+                {
+                    seriesAdd(&ackLat, (uint32_t) (t - f.readyMs));
+                    if (txq.inFlight && txq.msg[0].seq == f.seq) seriesAdd(&exchange, (uint32_t) t - txq.msg[0].sentMs);
+                    appTxqAck(&txq, f.seq, (uint32_t) t);
+                    continue;
+                }
+                seriesAdd(&reqLat, (uint32_t) (t - f.readyMs));
+                appPollServer(&poll, (uint32_t) t);
+                // The response goes up at once, the server sends the next request after its turnaround
+                if (f.left > 1 && npending < MAX_PENDING)
+                {
+                    pending[npending++] = (frame_t) { .readyMs = t + 2 * PATH_MS + between(&seed, 0, SERVER_THINK_MS),
+                                                      .ack = false, .left = (uint8_t) (f.left - 1),
+                                                      .txnStartMs = f.txnStartMs };
+                }
+                else if (f.left <= 1)
+                {
+                    seriesAdd(&txnDur, (uint32_t) (t + PATH_MS - f.txnStartMs));
+                }
+            }
+            if (isPoll) nextPollMs = t + period;
+        }
+
+        // Send the next report; the ack reaches the parent after the server RTT
+        const appTxqMsg_t *msg = appTxqNext(&txq, (uint32_t) t);
+        if (msg != NULL && npending < MAX_PENDING)
+        {
+            pending[npending++] = (frame_t) { .readyMs = t + between(&seed, SERVER_RTT_MIN_MS, SERVER_RTT_MAX_MS),
+                                              .ack = true, .seq = msg->seq };
+        }
+
+        if (policy->fixedMs == 0)
+        {
+            appPollSetRtt(&poll, txq.stats.srttMs);
+            appPollExchange(&poll, txq.inFlight, (uint32_t) t);
+            if (appPollUpdate(&poll, (uint32_t) t))
+            {
+                // OpenThread restarts the poll timer from the last poll with the new period
+                period = poll.periodMs;
+                nextPollMs = lastPollMs + period > t ? lastPollMs + period : t;
+            }
+        }
+    }
+
+    double days = durMs / 86400000.0;
+    double samples = policy->cslMs ? (double) (durMs / policy->cslMs) : 0.0;
+    double ua = (polls * APP_LINK_POLL_CHARGE_UC + samples * APP_LINK_SAMPLE_CHARGE_UC
+            + frames * APP_LINK_FRAME_CHARGE_UC) / (durMs / 1000.0);
+    printf("%-14s %9.0f %9.2f %9.0f %9u %9.0f %9u %9u %9.0f %9.0f %9u\n",
+           policy->name, polls / days, ua,
+           seriesMean(&ackLat), seriesPct(&ackLat, 95),
+           seriesMean(&reqLat), seriesPct(&reqLat, 95), seriesPct(&reqLat, 100),
+           seriesMean(&exchange), seriesMean(&txnDur), seriesPct(&txnDur, 95));
+    free(ackLat.v);
+    free(reqLat.v);
+    free(exchange.v);
+    free(txnDur.v);
+}
+
+int main(int argc, char **argv)
+{
+    double days = 7, reportsPerDay = 30, txnsPerDay = 24;
+    unsigned seed = 1;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "d:r:t:s:h")) != -1)
+    {
+        switch (opt)
+        {
+        case 'd': days = atof(optarg); break;
+        case 'r': reportsPerDay = atof(optarg); break;
+        case 't': txnsPerDay = atof(optarg); break;
+        case 's': seed = (unsigned) strtoul(optarg, NULL, 0); break;
+        default:
+            fprintf(stderr, "usage: %s [-d days] [-r reports_per_day] [-t transactions_per_day] [-s seed]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (days <= 0 || reportsPerDay <= 0 || txnsPerDay <= 0)
+    {
+        fprintf(stderr, "days and rates must be positive\n");
+        return 2;
+    }
+
+    uint64_t durMs = (uint64_t) (days * 86400000.0);
+    traffic_t traffic = { .seed = seed };
+    unsigned gen = seed;
+    traffic.reports = arrivals(&gen, reportsPerDay, durMs, &traffic.reportMs);
+    traffic.txns = arrivals(&gen, txnsPerDay, durMs, &traffic.txnMs);
+    traffic.txnLen = malloc(traffic.txns ? traffic.txns : 1);
+    for (size_t i = 0; i < traffic.txns; i++) traffic.txnLen[i] = (uint8_t) between(&gen, 1, MAX_TXN_REQUESTS + 1);
+
+    printf("%.1f days, %zu reports, %zu server transactions, seed %u\n\n", days, traffic.reports, traffic.txns, seed);
+    printf("%-14s %9s %9s %9s %9s %9s %9s %9s %9s %9s %9s\n", "downlink", "polls/d", "radio[uA]",
+           "ack[ms]", "ack p95", "req[ms]", "req p95", "req max", "exch[ms]", "txn[ms]", "txn p95");
+    for (size_t i = 0; i < sizeof(policies) / sizeof(policies[0]); i++) run(&policies[i], &traffic, durMs);
+
+    free(traffic.reportMs);
+    free(traffic.txnMs);
+    free(traffic.txnLen);
+    return 0;
+}
@@ -0,0 +1,88 @@
+/*
+ * radar_bench.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: edward62740
+ *
+ *  Sweeps TH+/TH-/IFD over a set of recorded traces and prints the aggregate
+ *  frame rate, CoAP send rate and detection latency for each combination, so
+ *  the energy/latency trade-off of a room can be read off one table.
+ *
+ *  usage: radar_bench trace.csv...
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "sim.h"
+
+static const uint8_t posThs[] = { 40, 60, 80, 100 };
+static const uint8_t negThs[] = { 15, 20, 30, 40 };
+static const uint32_t spacings[] = { 2000, 3000, 4000, 6000 };
+
+#define COUNT(a) (sizeof(a) / sizeof((a)[0]))
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        fprintf(stderr, "usage: %s trace...\n", argv[0]);
+        return 2;
+    }
+
+    int nTraces = argc - 1;
+    trace_t *traces = calloc((size_t) nTraces, sizeof(*traces));
+    if (traces == NULL) return 1;
+    for (int i = 0; i < nTraces; i++)
+    {
+        if (!traceLoad(&traces[i], argv[i + 1]))
+        {
+            fprintf(stderr, "%s: cannot load trace\n", argv[i + 1]);
+            return 1;
+        }
+    }
+
+    printf("%4s %4s %6s %10s %10s %8s %8s %8s %8s\n",
+           "TH+", "TH-", "IFD", "frames/h", "sends/h", "det[%]", "ttd[s]", "ttdmax", "ttc[s]");
+
+    uint64_t totalFrames = 0;
+    clock_t begin = clock();
+
+    for (size_t a = 0; a < COUNT(posThs); a++)
+    for (size_t b = 0; b < COUNT(negThs); b++)
+    for (size_t c = 0; c < COUNT(spacings); c++)
+    {
+        radarAlgoParams_t params;
+        radarAlgoDefaultParams(&params);
+        params.posTh = posThs[a];
+        params.negTh = negThs[b];
+        params.frameSpacingMs = spacings[c];
+
+        simResult_t sum = { 0 };
+        for (int i = 0; i < nTraces; i++)
+        {
+            simResult_t r;
+            simRun(&traces[i], &params, &r);
+            simAccumulate(&sum, &r);
+        }
+        totalFrames += sum.frames;
+
+        double hours = sum.durationMs / 3600000.0;
+        printf("%4u %4u %6lu %10.1f %10.1f %8.1f %8.2f %8.2f %8.2f\n",
+               params.posTh, params.negTh, (unsigned long) params.frameSpacingMs,
+               hours > 0 ? sum.frames / hours : 0.0,
+               hours > 0 ? simCoapSends(&sum) / hours : 0.0,
+               sum.onsets ? 100.0 * sum.detected / sum.onsets : 0.0,
+               sum.detected ? (double) sum.ttdSumMs / sum.detected / 1000.0 : 0.0,
+               sum.ttdMaxMs / 1000.0,
+               sum.cleared ? (double) sum.ttcSumMs / sum.cleared / 1000.0 : 0.0);
+    }
+
+    double secs = (double) (clock() - begin) / CLOCKS_PER_SEC;
+    printf("\n%llu frames simulated in %.3f s (%.1f Mframes/s)\n",
+           (unsigned long long) totalFrames, secs, secs > 0 ? totalFrames / secs / 1e6 : 0.0);
+
+    for (int i = 0; i < nTraces; i++) traceFree(&traces[i]);
+    free(traces);
+    return 0;
+}
@@ -0,0 +1,261 @@
+/*
+ * recover_sim.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: edward62740
+ *
+ *  A fleet of sleepy end devices through a border router restart that takes
+ *  their parents down for the outage. Each node notices the loss within one poll
+ *  period and is then recovered either by:
+ *  - the former path: a full stack restart on every report while not a child,
+ *    the reports come every alive interval;
+ *  - the staged recovery (app_recover.c): wait, parent searches, and a reattach
+ *    or reset only for a stack that hears its parents and still does not attach.
+ *  OpenThread keeps trying to attach by itself in both, with its attach backoff
+ *  doubling from OT_BACKOFF_MIN_MS to OT_BACKOFF_MAX_MS and restarting whenever
+ *  MLE is restarted. An attach attempt succeeds ATTACH_MIN_MS..ATTACH_MAX_MS
+ *  after it was made if the network is up by then; a restart of MLE or the stack
+ *  aborts the attempt in progress. With -w, that share of the nodes has a wedged
+ *  stack: it hears the parents' answers but only attaches after a stack restart.
+ *
+ *  Reports the time to recover, the stack restarts and attach attempts of the
+ *  fleet, and the largest number of them within one STORM_WINDOW_MS, which is
+ *  what the parents and the border router see after the restart.
+ *
+ *  usage: recover_sim [-n nodes] [-o outage_s] [-a alive_s] [-w wedged_pct] [-s seed]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "app_recover.h"
+
+#define STEP_MS            100
+#define DETECT_MS          10000   // parent loss noticed within one idle poll period
+#define OT_BACKOFF_MIN_MS  1000
+#define OT_BACKOFF_MAX_MS  1200000 // OPENTHREAD_CONFIG_MLE_ATTACH_BACKOFF_MAXIMUM_INTERVAL
+#define ATTACH_MIN_MS      1000
+#define ATTACH_MAX_MS      3000
+#define RESTART_MS         2000    // stack restart before MLE attaches again
+#define STORM_WINDOW_MS    10000
+#define TAIL_MS            7200000 // simulated after the outage
+
+typedef enum
+{
+    POLICY_RESTART = 0,
+    POLICY_STAGED,
+} policy_t;
+
+static const char *policyNames[] = { "restart", "staged" };
+
+typedef struct
+{
+    uint32_t recovered;
+    uint64_t sumMs;
+    uint32_t maxMs;
+    uint32_t restarts;
+    uint32_t reattaches;
+    uint32_t searches;
+    uint32_t attempts;
+    uint32_t *restartBins;
+    uint32_t *attemptBins;
+    uint32_t stage[APP_RECOVER_STAGES];
+} fleet_t;
+
+typedef struct
+{
+    uint64_t nextOwnMs;    // OpenThread's next attach attempt
+    uint32_t backoffMs;
+    uint64_t attachDoneMs; // attempt in progress, 0 if none
+    uint64_t restartDoneMs;
+    bool wedged;           // needs a stack restart to attach
+    bool heard;            // an answer came in since the last step
+} node_t;
+
+static uint32_t between(unsigned *seed, uint32_t lo, uint32_t hi)
+{
+    return lo + (uint32_t) ((double) rand_r(seed) / ((double) RAND_MAX + 1) * (hi - lo));
+}
+
+static void attempt(node_t *n, fleet_t *f, unsigned *seed, uint64_t t)
+{
+    f->attempts++;
+    f->attemptBins[t / STORM_WINDOW_MS]++;
+    if (n->attachDoneMs == 0) n->attachDoneMs = t + between(seed, ATTACH_MIN_MS, ATTACH_MAX_MS);
+}
+
+/* MLE restarted: attempt in progress aborted, OpenThread's backoff starts over */
+static void restartMle(node_t *n, uint64_t atMs)
+{
+    n->attachDoneMs = 0;
+    n->backoffMs = OT_BACKOFF_MIN_MS;
+    n->nextOwnMs = atMs;
+}
+
+static int cmpU32(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *) a, y = *(const uint32_t *) b;
+    return (x > y) - (x < y);
+}
+
+static uint32_t peak(const uint32_t *bins, size_t n)
+{
+    uint32_t m = 0;
+    for (size_t i = 0; i < n; i++) if (bins[i] > m) m = bins[i];
+    return m;
+}
+
+static void run(policy_t policy, unsigned nodes, uint64_t outageMs, uint32_t aliveMs, double wedgedPct, unsigned seed)
+{
+    uint64_t endMs = outageMs + TAIL_MS;
+    size_t bins = endMs / STORM_WINDOW_MS + 1;
+    fleet_t f;
+    memset(&f, 0, sizeof(f));
+    f.restartBins = calloc(bins, sizeof(uint32_t));
+    f.attemptBins = calloc(bins, sizeof(uint32_t));
+    uint32_t *times = calloc(nodes, sizeof(uint32_t));
+    unsigned stuck = 0;
+
+    for (unsigned i = 0; i < nodes; i++)
+    {
+        unsigned rs = seed * 7919u + i;
+        node_t n;
+        appRecover_t rec;
+        appRecoverInit(&rec, (uint32_t) rand_r(&rs), nodes);
+        uint64_t lostMs = between(&rs, 0, DETECT_MS);
+        uint64_t nextReportMs = lostMs + between(&rs, 0, aliveMs);
+        memset(&n, 0, sizeof(n));
+        n.wedged = between(&rs, 0, 10000) < wedgedPct * 100;
+        restartMle(&n, lostMs);
+        bool attached = false;
+        uint64_t t;
+
+        for (t = lostMs; t < endMs; t += STEP_MS)
+        {
+            if (n.attachDoneMs && t >= n.attachDoneMs)
+            {
+                n.attachDoneMs = 0;
+                if (t >= outageMs && n.wedged)
+                {
+                    n.heard = true;
+                }
+                else if (t >= outageMs)
+                {
+                    attached = true;
+                    if (policy == POLICY_STAGED) appRecoverUpdate(&rec, true, false, (uint32_t) (t - lostMs));
+                    break;
+                }
+            }
+            if (n.restartDoneMs && t >= n.restartDoneMs)
+            {
+                n.restartDoneMs = 0;
+                n.wedged = false;
+                restartMle(&n, t);
+            }
+            if (n.restartDoneMs == 0 && t >= n.nextOwnMs)
+            {
+                attempt(&n, &f, &rs, t);
+                n.nextOwnMs = t + n.backoffMs + between(&rs, 0, n.backoffMs / 2 + 1);
+                n.backoffMs = n.backoffMs * 2 < OT_BACKOFF_MAX_MS ? n.backoffMs * 2 : OT_BACKOFF_MAX_MS;
+            }
+
+            if (policy == POLICY_RESTART)
+            {
+                if (t < nextReportMs) continue;
+                nextReportMs += aliveMs;
+                f.restarts++;
+                f.restartBins[t / STORM_WINDOW_MS]++;
+                n.attachDoneMs = 0;
+                n.restartDoneMs = t + RESTART_MS;
+                continue;
+            }
+
+            bool heard = n.heard;
+            n.heard = false;
+            switch (appRecoverUpdate(&rec, false, heard, (uint32_t) (t - lostMs)))
+            {
+            case APP_RECOVER_DO_SEARCH:
+                f.searches++;
+                attempt(&n, &f, &rs, t);
+                break;
+            case APP_RECOVER_DO_REATTACH:
+                f.reattaches++;
+                restartMle(&n, t);
+                break;
+            case APP_RECOVER_DO_RESET:
+                f.restarts++;
+                f.restartBins[t / STORM_WINDOW_MS]++;
+                n.attachDoneMs = 0;
+                n.restartDoneMs = t + RESTART_MS;
+                break;
+            default:
+                break;
+            }
+        }
+
+        if (!attached)
+        {
+            stuck++;
+            continue;
+        }
+        uint32_t ms = (uint32_t) (t - lostMs);
+        times[f.recovered++] = ms;
+        f.sumMs += ms;
+        if (ms > f.maxMs) f.maxMs = ms;
+        for (int k = APP_RECOVER_WAIT; k < APP_RECOVER_STAGES; k++) f.stage[k] += rec.stats[k].recovered;
+    }
+
+    qsort(times, f.recovered, sizeof(*times), cmpU32);
+    printf("%-8s %9u %8.1f %8.1f %8.1f %9u %9u %9u %9u %9u %9u",
+           policyNames[policy], f.recovered,
+           f.recovered ? f.sumMs / 1000.0 / f.recovered : 0.0,
+           f.recovered ? times[(f.recovered - 1) * 95 / 100] / 1000.0 : 0.0, f.maxMs / 1000.0,
+           f.restarts, peak(f.restartBins, bins), f.reattaches, f.searches, f.attempts, peak(f.attemptBins, bins));
+    if (policy == POLICY_STAGED)
+    {
+        printf("   %u/%u/%u/%u", f.stage[APP_RECOVER_WAIT], f.stage[APP_RECOVER_SEARCH],
+               f.stage[APP_RECOVER_REATTACH], f.stage[APP_RECOVER_RESET]);
+    }
+    if (stuck) printf("   (%u not recovered)", stuck);
+    printf("\n");
+
+    free(times);
+    free(f.restartBins);
+    free(f.attemptBins);
+}
+
+int main(int argc, char **argv)
+{
+    unsigned nodes = 200, seed = 1;
+    double outageS = 300, aliveS = 60, wedgedPct = 0;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "n:o:a:w:s:h")) != -1)
+    {
+        switch (opt)
+        {
+        case 'n': nodes = (unsigned) strtoul(optarg, NULL, 0); break;
+        case 'o': outageS = atof(optarg); break;
+        case 'a': aliveS = atof(optarg); break;
+        case 'w': wedgedPct = atof(optarg); break;
+        case 's': seed = (unsigned) strtoul(optarg, NULL, 0); break;
+        default:
+            fprintf(stderr, "usage: %s [-n nodes] [-o outage_s] [-a alive_s] [-w wedged_pct] [-s seed]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (nodes == 0 || outageS < 0 || aliveS <= 0 || wedgedPct < 0 || wedgedPct > 100)
+    {
+        fprintf(stderr, "nodes and the alive interval must be positive, wedged_pct 0-100\n");
+        return 2;
+    }
+
+    printf("%u nodes, %.0f s outage, alive every %.0f s, %.0f%% wedged, seed %u\n\n",
+           nodes, outageS, aliveS, wedgedPct, seed);
+    printf("%-8s %9s %8s %8s %8s %9s %9s %9s %9s %9s %9s   %s\n", "recovery", "recovered", "mean[s]",
+           "p95[s]", "max[s]", "restarts", "peak", "reattach", "search", "attempts", "peak", "by stage");
+    run(POLICY_RESTART, nodes, (uint64_t) (outageS * 1000), (uint32_t) (aliveS * 1000), wedgedPct, seed);
+    run(POLICY_STAGED, nodes, (uint64_t) (outageS * 1000), (uint32_t) (aliveS * 1000), wedgedPct, seed);
+    return 0;
+}
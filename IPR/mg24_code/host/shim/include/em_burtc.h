@@ -0,0 +1,22 @@
+/*
+ * em_burtc.h (host shim)
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: edward62740
+ *
+ *  BURTC on the 1 kHz ULFRCO with compare0Top, as set up by initBURTC(): the
+ *  counter restarts on every compare match. See shim_platform.c.
+ */
+
+#ifndef SHIM_EM_BURTC_H_
+#define SHIM_EM_BURTC_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+void BURTC_CounterReset(void);
+void BURTC_CompareSet(unsigned int comp, uint32_t value);
+uint32_t BURTC_CounterGet(void);
+void BURTC_Enable(bool enable);
+
+#endif /* SHIM_EM_BURTC_H_ */
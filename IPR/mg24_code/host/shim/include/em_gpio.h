@@ -0,0 +1,26 @@
+/*
+ * em_gpio.h (host shim)
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: edward62740
+ *
+ *  Pin output state only, see shim_platform.c.
+ */
+
+#ifndef SHIM_EM_GPIO_H_
+#define SHIM_EM_GPIO_H_
+
+typedef enum
+{
+    gpioPortA,
+    gpioPortB,
+    gpioPortC,
+    gpioPortD,
+} GPIO_Port_TypeDef;
+
+void GPIO_PinOutSet(GPIO_Port_TypeDef port, unsigned int pin);
+void GPIO_PinOutClear(GPIO_Port_TypeDef port, unsigned int pin);
+void GPIO_PinOutToggle(GPIO_Port_TypeDef port, unsigned int pin);
+unsigned int GPIO_PinInGet(GPIO_Port_TypeDef port, unsigned int pin);
+
+#endif /* SHIM_EM_GPIO_H_ */
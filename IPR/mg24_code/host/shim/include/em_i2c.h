@@ -0,0 +1,24 @@
+/*
+ * em_i2c.h (host shim)
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: edward62740
+ *
+ *  Transfer status only, for app_i2c.h. The OPT3001 is stubbed in shim_app.c.
+ */
+
+#ifndef SHIM_EM_I2C_H_
+#define SHIM_EM_I2C_H_
+
+typedef enum
+{
+    i2cTransferInProgress = 1,
+    i2cTransferDone = 0,
+    i2cTransferNack = -1,
+    i2cTransferBusErr = -2,
+    i2cTransferArbLost = -3,
+    i2cTransferUsageFault = -4,
+    i2cTransferSwFault = -5,
+} I2C_TransferReturn_TypeDef;
+
+#endif /* SHIM_EM_I2C_H_ */
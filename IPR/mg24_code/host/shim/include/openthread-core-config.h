@@ -0,0 +1,13 @@
+/*
+ * openthread-core-config.h (host shim)
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: edward62740
+ *
+ *  Empty stand-in so that app_main.h can be included on the host.
+ */
+
+#ifndef SHIM_OPENTHREAD_CORE_CONFIG_H_
+#define SHIM_OPENTHREAD_CORE_CONFIG_H_
+
+#endif /* SHIM_OPENTHREAD_CORE_CONFIG_H_ */
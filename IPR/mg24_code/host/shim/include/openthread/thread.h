@@ -0,0 +1,40 @@
+/*
+ * thread.h (host shim)
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: edward62740
+ *
+ *  The OpenThread types and calls used by the radar application loop, see shim_app.c.
+ */
+
+#ifndef SHIM_OPENTHREAD_THREAD_H_
+#define SHIM_OPENTHREAD_THREAD_H_
+
+#include <stdint.h>
+
+typedef enum
+{
+    OT_ERROR_NONE = 0,
+    OT_ERROR_FAILED = 1,
+    OT_ERROR_NO_BUFS = 3,
+} otError;
+
+typedef struct otInstance otInstance;
+typedef struct otMessage otMessage;
+
+typedef struct
+{
+    uint8_t m8[16];
+} otIp6Address;
+
+typedef struct
+{
+    otIp6Address mSockAddr;
+    otIp6Address mPeerAddr;
+    uint16_t mSockPort;
+    uint16_t mPeerPort;
+} otMessageInfo;
+
+otError otThreadGetParentLastRssi(otInstance *aInstance, int8_t *aLastRssi);
+
+#endif /* SHIM_OPENTHREAD_THREAD_H_ */
@@ -0,0 +1,50 @@
+/*
+ * sl_sleeptimer.h (host shim)
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: edward62740
+ *
+ *  Sleeptimer on the shim's virtual clock (32768 Hz ticks), see shim_platform.c.
+ *  Timer callbacks run from shimSleep(), like they would from the RTCC ISR.
+ */
+
+#ifndef SHIM_SL_SLEEPTIMER_H_
+#define SHIM_SL_SLEEPTIMER_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef uint32_t sl_status_t;
+#define SL_STATUS_OK              0x0000
+#define SL_STATUS_INVALID_STATE   0x0002
+#define SL_STATUS_NULL_POINTER    0x0022
+
+struct sl_sleeptimer_timer_handle;
+typedef void (*sl_sleeptimer_timer_callback_t)(struct sl_sleeptimer_timer_handle *handle, void *data);
+
+typedef struct sl_sleeptimer_timer_handle
+{
+    void *callback_data;
+    sl_sleeptimer_timer_callback_t callback;
+    uint64_t expiry;       // virtual time [us]
+    uint32_t period_us;    // 0 for one-shot
+    bool running;
+    struct sl_sleeptimer_timer_handle *next;
+} sl_sleeptimer_timer_handle_t;
+
+uint32_t sl_sleeptimer_get_timer_frequency(void);
+uint32_t sl_sleeptimer_get_tick_count(void);
+uint64_t sl_sleeptimer_get_tick_count64(void);
+uint32_t sl_sleeptimer_tick_to_ms(uint32_t tick);
+uint32_t sl_sleeptimer_ms_to_tick(uint16_t time_ms);
+
+sl_status_t sl_sleeptimer_start_timer_ms(sl_sleeptimer_timer_handle_t *handle, uint32_t timeout_ms,
+                                         sl_sleeptimer_timer_callback_t callback, void *callback_data,
+                                         uint8_t priority, uint16_t option_flags);
+sl_status_t sl_sleeptimer_start_periodic_timer_ms(sl_sleeptimer_timer_handle_t *handle, uint32_t timeout_ms,
+                                                  sl_sleeptimer_timer_callback_t callback, void *callback_data,
+                                                  uint8_t priority, uint16_t option_flags);
+sl_status_t sl_sleeptimer_stop_timer(sl_sleeptimer_timer_handle_t *handle);
+sl_status_t sl_sleeptimer_is_timer_running(sl_sleeptimer_timer_handle_t *handle, bool *running);
+
+#endif /* SHIM_SL_SLEEPTIMER_H_ */
@@ -0,0 +1,93 @@
+/*
+ * shim.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: edward62740
+ *
+ *  Host shim for the IPR application loop (../../ipr/radar_app.c).
+ *
+ *  Everything runs on a virtual clock. Calls that keep the MCU awake on target
+ *  (get_next, CoAP TX) advance it by a modelled duration; shimSleep() stands in
+ *  for sl_power_manager_sleep() and jumps to the next BURTC or sleeptimer event,
+ *  running its handler. The RSS entry points replay a recorded trace (trace.h).
+ */
+
+#ifndef SHIM_H_
+#define SHIM_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "trace.h"
+#include "app_txq.h"
+
+/* Nominal A111 presence detector timing (sparse, profile 4, 0.2-1.75 m, 63 HWAAS).
+ * The wake cost depends on the power save mode between frames. */
+typedef struct
+{
+    uint32_t wakeOffUs;       // ACC_POWER_SAVE_MODE_OFF: power on, reload and start
+    uint32_t wakeSleepUs;     // SLEEP
+    uint32_t wakeReadyUs;     // READY, ACTIVE
+    uint32_t wakeHibernateUs; // HIBERNATE exit
+    uint32_t sweepUs;         // sensor measuring one frame
+    uint32_t processUs;       // RSS processing of the frame data on the MCU
+    uint32_t coapTxUs;        // awake time of one CoAP send (SED data request + TX)
+} shimTiming_t;
+
+typedef struct
+{
+    uint64_t awakeUs;       // virtual time spent in modelled busy calls
+    uint64_t sleepUs;       // virtual time skipped by shimSleep()
+    uint32_t getNextCalls;
+    uint64_t getNextUs;     // time blocked in acc_detector_presence_get_next()
+    uint64_t overlapUs;     // async only: sweep time hidden behind host work
+    uint32_t burtcEvents;
+    uint32_t timerEvents;
+} shimStats_t;
+
+typedef struct
+{
+    uint32_t sends;
+    uint32_t confirmable;
+    uint32_t bytes;      // CoAP payload
+    uint32_t wakes;      // radio wakes, back-to-back sends share one
+    uint32_t frames;     // 802.15.4 frames incl. 6LoWPAN fragments
+    uint32_t airBytes;   // on air incl. headers, PHY and MAC acks
+    uint32_t lost;       // confirmable exchanges that timed out
+    uint32_t delivered;  // confirmable exchanges the server answered
+    uint64_t staleUs;    // time the server did not have the latest state report
+    void (*onSend)(uint64_t tUs, const uint8_t *payload, size_t len, uint32_t contentFormat, bool confirmable);
+} shimCoapStats_t;
+
+void shimTimingDefault(shimTiming_t *timing);
+
+/* Reset the clock and all peripherals, t = 0 is the first trace sample */
+void shimInit(const trace_t *trace, const shimTiming_t *timing);
+
+uint64_t shimNowUs(void);
+
+/* Busy-wait the virtual clock, counted as awake time */
+void shimBusy(uint32_t us);
+
+/* Advance to the next BURTC/sleeptimer event and run it; false if there is none */
+bool shimSleep(void);
+
+/* The firmware's BURTC_IRQHandler(), called by shimSleep() on a compare match */
+void shimSetBurtcHandler(void (*handler)(void));
+
+const shimStats_t *shimGetStats(void);
+
+/* CoAP side: link state seen by the application and captured sends */
+void shimCoapSetConnected(bool connected);
+void shimCoapSetBinary(bool binary); // the server accepts the binary payload (app_payload.h)
+void shimCoapSetBatch(bool batch);   // the server accepts batched alive telemetry (app_batch.h)
+shimCoapStats_t *shimCoapGetStats(void);
+
+/* Link model for confirmable reports: each exchange is lost with lossPct, and the
+ * node is detached for the last outageForS of every outageEveryS (0: never).
+ * queue false models the sender before the delivery queue: one attempt, no retry */
+void shimCoapSetLink(uint8_t lossPct, uint32_t outageEveryS, uint32_t outageForS, bool queue);
+/* Queue statistics; also closes the staleness interval open at the time of the call */
+const appTxqStats_t *shimCoapQueueStats(void);
+
+#endif /* SHIM_H_ */
@@ -0,0 +1,397 @@
+/*
+ * shim_app.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: edward62740
+ *
+ *  Board and network side of the host shim (shim.h): the A111 HAL integration
+ *  calls, calibration, OPT3001 and its I2C queue, supply voltage, NVM for the trace
+ *  blocks and the CoAP sender used by radar_app.c. CoAP sends are captured instead of transmitted; confirmable
+ *  reports go through the firmware's delivery queue (app_txq.h) over a link
+ *  model with random loss and periodic outages.
+ */
+
+#include <string.h>
+#include "shim.h"
+#include "shim_internal.h"
+#include "app_main.h"
+#include "app_coap.h"
+#include "acc_hal_integration.h"
+#include "opt3001.h"
+#include "app_i2c.h"
+#include "radar_app.h"
+#include "radar_calib.h"
+#include "app_nvm.h"
+#include "trace_rec.h"
+#include "sl_sleeptimer.h"
+
+#define SHIM_VDD_MV    1800   // AVDD is the regulated rail
+#define SHIM_LUX       120000 // mlux, as opt3001_conv(); traces with a lux column override it
+#define SHIM_RSSI      (-62)
+#define SHIM_RSSI_JITTER 3    // +- dB, deterministic
+
+/* Air-time model of one CoAP PUT (see README, Report Payload) */
+#define SHIM_FRAME_MAX       127 // 802.15.4 PSDU
+#define SHIM_FRAME_MAC       21  // MAC header with short addresses, aux security header, MIC, FCS
+#define SHIM_FRAME_PHY       6   // preamble, SFD, PHR
+#define SHIM_FRAME_ACK       11  // MAC ack incl. PHY
+#define SHIM_FRAG1_HDR       4
+#define SHIM_FRAGN_HDR       5
+#define SHIM_MESH_HDR        33  // IPHC with the server address inline, NHC UDP
+#define SHIM_COAP_HDR        24  // header, token, 16 byte Uri-Path, payload marker
+#define SHIM_COAP_FORMAT     3   // Content-Format option
+
+/* Confirmable exchange as OpenThread reports it: a response after a nominal RTT,
+ * or a timeout after all of its retransmissions (MAX_TRANSMIT_WAIT, RFC 7252 defaults) */
+#define SHIM_COAP_RTT_MS        250
+#define SHIM_COAP_RTT_JITTER_MS 250
+#define SHIM_COAP_TIMEOUT_MS    93000
+
+volatile uint32_t vdd_meas = SHIM_VDD_MV;
+bool appCoapConnectionEstablished = false;
+bool appCoapBinaryPayload = false;
+bool appCoapBatchAlive = false;
+
+static acc_hal_t shimHal;
+static shimCoapStats_t coapStats;
+static uint32_t coapTxUs;
+static uint64_t coapLastEndUs;
+static const trace_t *appTrace;
+static size_t appCursor;
+static uint32_t rssiSeed;
+static uint8_t nvmTrace[APP_NVM_TRACE_BLOCKS][TRACE_REC_BLOCK_SIZE];
+static bool nvmTraceValid[APP_NVM_TRACE_BLOCKS];
+
+/* Link model and the report queue, see shimCoapSetLink() */
+static appTxq_t txq;
+static bool txqEnabled;
+static uint8_t linkLossPct;
+static uint32_t linkOutageEveryS, linkOutageForS;
+static uint32_t linkSeed;
+static sl_sleeptimer_timer_handle_t txqTimer, responseTimer;
+static struct
+{
+    uint16_t seq;
+    bool delivered;
+    uint16_t len;
+    uint8_t buf[APP_TXQ_MAX_LEN];
+} response;
+static uint8_t latest[APP_TXQ_MAX_LEN]; // last state report, the server is stale until it has it
+static uint16_t latestLen;
+static uint64_t staleSinceUs;
+static bool stale;
+
+void shimAppInit(const trace_t *trace, const shimTiming_t *timing)
+{
+    vdd_meas = SHIM_VDD_MV;
+    appCoapConnectionEstablished = false;
+    appCoapBinaryPayload = false;
+    appCoapBatchAlive = false;
+    shimCoapStats_t keep = { .onSend = coapStats.onSend };
+    coapStats = keep;
+    coapTxUs = timing->coapTxUs;
+    coapLastEndUs = 0;
+    appTrace = trace;
+    appCursor = 0;
+    rssiSeed = 1;
+    memset(nvmTraceValid, 0, sizeof(nvmTraceValid));
+    appTxqInit(&txq, 1);
+    txqEnabled = true;
+    linkLossPct = 0;
+    linkOutageEveryS = linkOutageForS = 0;
+    linkSeed = 1;
+    latestLen = 0;
+    stale = false;
+}
+
+const acc_hal_t *acc_hal_integration_get_implementation(void)
+{
+    return &shimHal;
+}
+
+void acc_hal_integration_frame_end(void)
+{
+}
+
+radarCalibStatus_t radarCalibApply(acc_sensor_id_t sensor_id, uint32_t vddMv)
+{
+    (void) sensor_id;
+    (void) vddMv;
+    return RADAR_CALIB_FRESH;
+}
+
+radarCalibStatus_t radarCalibLastStatus(void)
+{
+    return RADAR_CALIB_FRESH;
+}
+
+void opt3001_process(void)
+{
+}
+
+float opt3001_lux(void)
+{
+    const traceSample_t *s = traceAt(appTrace, (uint32_t) (shimNowUs() / 1000), &appCursor);
+    if (s == NULL || s->lux == TRACE_NO_LUX) return SHIM_LUX;
+    return s->lux * 1000.0f;
+}
+
+/* Constant light, the limit never trips */
+void opt3001_set_wake(bool enable, float mlux)
+{
+    (void) enable;
+    (void) mlux;
+}
+
+bool opt3001_wake_hint(void)
+{
+    return false;
+}
+
+/* The cached OPT3001 reading never touches the bus */
+void appI2cGetStats(appI2cStats_t *stats)
+{
+    memset(stats, 0, sizeof(*stats));
+}
+
+/* Trace blocks are kept in RAM, the node's other objects are not: every run
+ * starts with fresh cells */
+static bool shimNvmTrace(uint32_t key, size_t len)
+{
+    return key >= APP_NVM_KEY_TRACE && key < APP_NVM_KEY_TRACE + APP_NVM_TRACE_BLOCKS && len == TRACE_REC_BLOCK_SIZE;
+}
+
+bool appNvmRead(uint32_t key, void *buf, size_t len)
+{
+    if (!shimNvmTrace(key, len) || !nvmTraceValid[key - APP_NVM_KEY_TRACE]) return false;
+    memcpy(buf, nvmTrace[key - APP_NVM_KEY_TRACE], len);
+    return true;
+}
+
+bool appNvmWrite(uint32_t key, const void *buf, size_t len)
+{
+    if (shimNvmTrace(key, len))
+    {
+        memcpy(nvmTrace[key - APP_NVM_KEY_TRACE], buf, len);
+        nvmTraceValid[key - APP_NVM_KEY_TRACE] = true;
+    }
+    return true;
+}
+
+/* The shim supply never sags: every sample reads SHIM_VDD_MV */
+void vddMonitorRequestIdle(void)
+{
+    appBattSample(&radarBatt, vdd_meas, false);
+}
+
+void sleepySetPollScale(uint8_t scale)
+{
+    (void) scale;
+}
+
+otInstance *otGetInstance(void)
+{
+    return NULL;
+}
+
+otError otThreadGetParentLastRssi(otInstance *aInstance, int8_t *aLastRssi)
+{
+    (void) aInstance;
+    rssiSeed = rssiSeed * 1103515245u + 12345u;
+    *aLastRssi = (int8_t) (SHIM_RSSI + (int) ((rssiSeed >> 16) % (2 * SHIM_RSSI_JITTER + 1)) - SHIM_RSSI_JITTER);
+    return OT_ERROR_NONE;
+}
+
+void shimCoapSetConnected(bool connected)
+{
+    appCoapConnectionEstablished = connected;
+}
+
+shimCoapStats_t *shimCoapGetStats(void)
+{
+    return &coapStats;
+}
+
+void shimCoapSetBinary(bool binary)
+{
+    appCoapBinaryPayload = binary;
+}
+
+void shimCoapSetBatch(bool batch)
+{
+    appCoapBatchAlive = batch;
+}
+
+/* 802.15.4 frames of one PUT, 6LoWPAN fragments carry multiples of 8 bytes */
+static uint32_t shimCoapFrames(uint32_t datagram)
+{
+    const uint32_t room = SHIM_FRAME_MAX - SHIM_FRAME_MAC;
+    if (datagram <= room) return 1;
+    uint32_t first = (room - SHIM_FRAG1_HDR) & ~7u;
+    uint32_t next = (room - SHIM_FRAGN_HDR) & ~7u;
+    return 1 + (datagram - first + next - 1) / next;
+}
+
+void appCoapRadarSender(char *buf, bool require_ack)
+{
+    appCoapRadarSendPayload((const uint8_t *) buf, strlen(buf), APP_COAP_NO_CONTENT_FORMAT, require_ack);
+}
+
+void appCoapRadarSendPayload(const uint8_t *buf, uint16_t len, uint32_t contentFormat, bool require_ack)
+{
+    // A send right after another one rides on the same radio wake
+    if (coapStats.sends == 0 || shimNowUs() > coapLastEndUs + coapTxUs) coapStats.wakes++;
+    shimBusy(coapTxUs);
+    coapLastEndUs = shimNowUs();
+
+    uint32_t datagram = SHIM_MESH_HDR + SHIM_COAP_HDR + len
+            + (contentFormat != APP_COAP_NO_CONTENT_FORMAT ? SHIM_COAP_FORMAT : 0);
+    uint32_t frames = shimCoapFrames(datagram);
+    coapStats.sends++;
+    coapStats.bytes += len;
+    coapStats.frames += frames;
+    coapStats.airBytes += datagram + frames * (SHIM_FRAME_MAC + SHIM_FRAME_PHY + SHIM_FRAME_ACK)
+            + (frames > 1 ? SHIM_FRAG1_HDR + (frames - 1) * SHIM_FRAGN_HDR : 0);
+    if (require_ack) coapStats.confirmable++;
+    if (coapStats.onSend) coapStats.onSend(shimNowUs(), buf, len, contentFormat, require_ack);
+}
+
+static uint32_t shimNowMs(void)
+{
+    return (uint32_t) (shimNowUs() / 1000);
+}
+
+/* The node is detached for the last linkOutageForS of every linkOutageEveryS */
+static bool shimLinkDown(void)
+{
+    if (linkOutageEveryS == 0) return false;
+    return (shimNowUs() / 1000000) % linkOutageEveryS >= linkOutageEveryS - linkOutageForS;
+}
+
+static uint32_t shimLinkRand(void)
+{
+    linkSeed = linkSeed * 1103515245u + 12345u;
+    return linkSeed >> 16;
+}
+
+static void shimStaleUpdate(bool pushed)
+{
+    if (pushed && !stale)
+    {
+        stale = true;
+        staleSinceUs = shimNowUs();
+    }
+    else if (!pushed && stale)
+    {
+        stale = false;
+        coapStats.staleUs += shimNowUs() - staleSinceUs;
+    }
+}
+
+static void responseCb(sl_sleeptimer_timer_handle_t *handle, void *data)
+{
+    (void) handle;
+    (void) data;
+    if (response.delivered)
+    {
+        coapStats.delivered++;
+        if (response.len == latestLen && memcmp(response.buf, latest, latestLen) == 0) shimStaleUpdate(false);
+    }
+    if (!txqEnabled) return;
+    if (response.delivered) appTxqAck(&txq, response.seq, shimNowMs());
+    else appTxqFail(&txq, response.seq, shimNowMs());
+}
+
+/* One confirmable exchange, its outcome arrives through responseCb() */
+static void shimCoapExchange(const uint8_t *buf, uint16_t len, uint32_t contentFormat, uint16_t seq)
+{
+    appCoapRadarSendPayload(buf, len, contentFormat, true);
+    response.seq = seq;
+    response.delivered = !shimLinkDown() && shimLinkRand() % 100 >= linkLossPct;
+    response.len = len;
+    memcpy(response.buf, buf, len);
+    if (!response.delivered) coapStats.lost++;
+    // Without the queue nobody waits for a loss
+    if (!txqEnabled && !response.delivered) return;
+    uint32_t ms = response.delivered ? SHIM_COAP_RTT_MS + shimLinkRand() % (SHIM_COAP_RTT_JITTER_MS + 1)
+            : SHIM_COAP_TIMEOUT_MS;
+    sl_sleeptimer_start_timer_ms(&responseTimer, ms, responseCb, NULL, 0, 0);
+}
+
+static void txqTimerCb(sl_sleeptimer_timer_handle_t *handle, void *data)
+{
+    (void) handle;
+    (void) data;
+}
+
+void appCoapQueueReport(const uint8_t *buf, uint16_t len, uint32_t contentFormat, uint8_t key)
+{
+    if (key != APP_TXQ_KEY_NONE && len <= APP_TXQ_MAX_LEN)
+    {
+        memcpy(latest, buf, len);
+        latestLen = len;
+        shimStaleUpdate(true);
+    }
+    if (!txqEnabled)
+    {
+        // The fire-and-forget sender the queue replaced
+        shimCoapExchange(buf, len, contentFormat, 0);
+        return;
+    }
+    appTxqPush(&txq, buf, len, contentFormat, key, shimNowMs());
+    appCoapProcessQueue();
+}
+
+void appCoapProcessQueue(void)
+{
+    if (!txqEnabled || shimLinkDown()) return;
+
+    const appTxqMsg_t *msg = appTxqNext(&txq, shimNowMs());
+    if (msg != NULL) shimCoapExchange(msg->buf, msg->len, msg->contentFormat, msg->seq);
+
+    uint32_t wait = appTxqWaitMs(&txq, shimNowMs());
+    sl_sleeptimer_stop_timer(&txqTimer);
+    if (wait != UINT32_MAX) sl_sleeptimer_start_timer_ms(&txqTimer, wait, txqTimerCb, NULL, 0, 0);
+}
+
+void shimCoapSetLink(uint8_t lossPct, uint32_t outageEveryS, uint32_t outageForS, bool queue)
+{
+    linkLossPct = lossPct;
+    linkOutageEveryS = outageEveryS;
+    linkOutageForS = outageForS < outageEveryS ? outageForS : outageEveryS;
+    txqEnabled = queue;
+}
+
+const appTxqStats_t *shimCoapQueueStats(void)
+{
+    if (stale)
+    {
+        coapStats.staleUs += shimNowUs() - staleSinceUs;
+        staleSinceUs = shimNowUs();
+    }
+    return &txq.stats;
+}
+
+void shimTimingDefault(shimTiming_t *timing)
+{
+    timing->wakeOffUs = 7000;
+    timing->wakeSleepUs = 1500;
+    timing->wakeReadyUs = 300;
+    timing->wakeHibernateUs = 1000;
+    timing->sweepUs = 9000;
+    timing->processUs = 2500;
+    timing->coapTxUs = 6000;
+}
+
+void shimInit(const trace_t *trace, const shimTiming_t *timing)
+{
+    shimTiming_t def;
+    if (timing == NULL)
+    {
+        shimTimingDefault(&def);
+        timing = &def;
+    }
+    shimPlatformInit();
+    shimRssInit(trace, timing);
+    shimAppInit(trace, timing);
+}
@@ -0,0 +1,19 @@
+/*
+ * shim_internal.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: edward62740
+ */
+
+#ifndef SHIM_INTERNAL_H_
+#define SHIM_INTERNAL_H_
+
+#include "shim.h"
+
+/* Shared between the shim translation units only */
+void shimPlatformInit(void);
+void shimRssInit(const trace_t *trace, const shimTiming_t *timing);
+void shimAppInit(const trace_t *trace, const shimTiming_t *timing);
+shimStats_t *shimStatsMut(void);
+
+#endif /* SHIM_INTERNAL_H_ */
@@ -0,0 +1,232 @@
+/*
+ * shim_platform.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: edward62740
+ *
+ *  Virtual clock, BURTC, GPIO and sleeptimer for the host shim (shim.h).
+ */
+
+#include <string.h>
+#include "shim.h"
+#include "shim_internal.h"
+#include "em_burtc.h"
+#include "em_gpio.h"
+#include "sl_sleeptimer.h"
+
+#define SLEEPTIMER_FREQ 32768
+
+static uint64_t nowUs;
+static shimStats_t stats;
+
+/* BURTC, 1 ms per count */
+static struct
+{
+    bool enabled;
+    uint32_t compare;
+    uint64_t startUs; // time of the last counter reset or compare match
+    void (*handler)(void);
+} burtc;
+
+static sl_sleeptimer_timer_handle_t *timers;
+static unsigned gpioOut[4];
+
+void shimPlatformInit(void)
+{
+    nowUs = 0;
+    memset(&stats, 0, sizeof(stats));
+    memset(&burtc, 0, sizeof(burtc));
+    memset(gpioOut, 0, sizeof(gpioOut));
+    for (sl_sleeptimer_timer_handle_t *t = timers; t != NULL; t = t->next) t->running = false;
+    timers = NULL;
+}
+
+uint64_t shimNowUs(void)
+{
+    return nowUs;
+}
+
+void shimBusy(uint32_t us)
+{
+    nowUs += us;
+    stats.awakeUs += us;
+}
+
+shimStats_t *shimStatsMut(void)
+{
+    return &stats;
+}
+
+const shimStats_t *shimGetStats(void)
+{
+    return &stats;
+}
+
+void shimSetBurtcHandler(void (*handler)(void))
+{
+    burtc.handler = handler;
+}
+
+static void timerUnlink(sl_sleeptimer_timer_handle_t *handle)
+{
+    for (sl_sleeptimer_timer_handle_t **p = &timers; *p != NULL; p = &(*p)->next)
+    {
+        if (*p == handle)
+        {
+            *p = handle->next;
+            break;
+        }
+    }
+    handle->running = false;
+}
+
+bool shimSleep(void)
+{
+    uint64_t burtcDue = burtc.enabled && burtc.compare ? burtc.startUs + (uint64_t) burtc.compare * 1000 : UINT64_MAX;
+    sl_sleeptimer_timer_handle_t *next = NULL;
+
+    for (sl_sleeptimer_timer_handle_t *t = timers; t != NULL; t = t->next)
+    {
+        if (next == NULL || t->expiry < next->expiry) next = t;
+    }
+
+    uint64_t due = burtcDue;
+    if (next != NULL && next->expiry < due) due = next->expiry;
+    if (due == UINT64_MAX) return false;
+
+    if (due > nowUs)
+    {
+        stats.sleepUs += due - nowUs;
+        nowUs = due;
+    }
+
+    if (next != NULL && next->expiry == due)
+    {
+        stats.timerEvents++;
+        if (next->period_us) next->expiry += next->period_us;
+        else timerUnlink(next);
+        next->callback(next, next->callback_data);
+    }
+    else
+    {
+        stats.burtcEvents++;
+        burtc.startUs = burtcDue; // compare0Top
+        if (burtc.handler) burtc.handler();
+    }
+    return true;
+}
+
+void BURTC_CounterReset(void)
+{
+    burtc.startUs = nowUs;
+}
+
+void BURTC_CompareSet(unsigned int comp, uint32_t value)
+{
+    (void) comp;
+    burtc.compare = value;
+}
+
+uint32_t BURTC_CounterGet(void)
+{
+    return (uint32_t) ((nowUs - burtc.startUs) / 1000);
+}
+
+void BURTC_Enable(bool enable)
+{
+    burtc.enabled = enable;
+}
+
+void GPIO_PinOutSet(GPIO_Port_TypeDef port, unsigned int pin)
+{
+    gpioOut[port] |= 1u << pin;
+}
+
+void GPIO_PinOutClear(GPIO_Port_TypeDef port, unsigned int pin)
+{
+    gpioOut[port] &= ~(1u << pin);
+}
+
+void GPIO_PinOutToggle(GPIO_Port_TypeDef port, unsigned int pin)
+{
+    gpioOut[port] ^= 1u << pin;
+}
+
+unsigned int GPIO_PinInGet(GPIO_Port_TypeDef port, unsigned int pin)
+{
+    return (gpioOut[port] >> pin) & 1;
+}
+
+uint32_t sl_sleeptimer_get_timer_frequency(void)
+{
+    return SLEEPTIMER_FREQ;
+}
+
+uint64_t sl_sleeptimer_get_tick_count64(void)
+{
+    return nowUs * SLEEPTIMER_FREQ / 1000000;
+}
+
+uint32_t sl_sleeptimer_get_tick_count(void)
+{
+    return (uint32_t) sl_sleeptimer_get_tick_count64();
+}
+
+uint32_t sl_sleeptimer_tick_to_ms(uint32_t tick)
+{
+    return (uint32_t) ((uint64_t) tick * 1000 / SLEEPTIMER_FREQ);
+}
+
+uint32_t sl_sleeptimer_ms_to_tick(uint16_t time_ms)
+{
+    return (uint32_t) ((uint64_t) time_ms * SLEEPTIMER_FREQ / 1000);
+}
+
+static sl_status_t timerStart(sl_sleeptimer_timer_handle_t *handle, uint32_t timeout_ms, uint32_t period_ms,
+                              sl_sleeptimer_timer_callback_t callback, void *callback_data)
+{
+    if (handle == NULL) return SL_STATUS_NULL_POINTER;
+    if (handle->running) return SL_STATUS_INVALID_STATE;
+
+    handle->callback = callback;
+    handle->callback_data = callback_data;
+    handle->expiry = nowUs + (uint64_t) timeout_ms * 1000;
+    handle->period_us = period_ms * 1000;
+    handle->running = true;
+    handle->next = timers;
+    timers = handle;
+    return SL_STATUS_OK;
+}
+
+sl_status_t sl_sleeptimer_start_timer_ms(sl_sleeptimer_timer_handle_t *handle, uint32_t timeout_ms,
+                                         sl_sleeptimer_timer_callback_t callback, void *callback_data,
+                                         uint8_t priority, uint16_t option_flags)
+{
+    (void) priority;
+    (void) option_flags;
+    return timerStart(handle, timeout_ms, 0, callback, callback_data);
+}
+
+sl_status_t sl_sleeptimer_start_periodic_timer_ms(sl_sleeptimer_timer_handle_t *handle, uint32_t timeout_ms,
+                                                  sl_sleeptimer_timer_callback_t callback, void *callback_data,
+                                                  uint8_t priority, uint16_t option_flags)
+{
+    (void) priority;
+    (void) option_flags;
+    return timerStart(handle, timeout_ms, timeout_ms, callback, callback_data);
+}
+
+sl_status_t sl_sleeptimer_stop_timer(sl_sleeptimer_timer_handle_t *handle)
+{
+    if (handle == NULL) return SL_STATUS_NULL_POINTER;
+    if (!handle->running) return SL_STATUS_INVALID_STATE;
+    timerUnlink(handle);
+    return SL_STATUS_OK;
+}
+
+sl_status_t sl_sleeptimer_is_timer_running(sl_sleeptimer_timer_handle_t *handle, bool *running)
+{
+    if (handle == NULL || running == NULL) return SL_STATUS_NULL_POINTER;
+    *running = handle->running;
+    return SL_STATUS_OK;
+}
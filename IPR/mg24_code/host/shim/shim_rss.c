@@ -0,0 +1,219 @@
+/*
+ * shim_rss.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: edward62740
+ *
+ *  acc_rss_* and acc_detector_presence_* for the host shim (shim.h).
+ *
+ *  get_next returns the trace sample in effect when the sweep was taken and
+ *  advances the virtual clock by the modelled blocking time:
+ *      synchronous:  wake(power save mode) + sweep + process, sweep taken at call time
+ *      asynchronous: the next sweep starts when get_next returns; the following
+ *                    call only blocks for what is left of it, then processes
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "shim.h"
+#include "shim_internal.h"
+#include "acc_detector_presence.h"
+#include "acc_rss.h"
+
+struct acc_detector_presence_configuration
+{
+    acc_power_save_mode_t powerSaveMode;
+    bool async;
+};
+
+struct acc_detector_presence_handle
+{
+    struct acc_detector_presence_configuration cfg;
+    bool active;
+    bool sweepPending;   // async: a sweep was started by the previous get_next
+    uint64_t sweepStart; // async: virtual time the pending sweep started [us]
+};
+
+static const trace_t *rssTrace;
+static size_t rssCursor;
+static shimTiming_t rssTiming;
+static bool rssActive;
+
+void shimRssInit(const trace_t *trace, const shimTiming_t *timing)
+{
+    rssTrace = trace;
+    rssCursor = 0;
+    rssTiming = *timing;
+    rssActive = false;
+}
+
+bool acc_rss_activate(const acc_hal_t *hal)
+{
+    (void) hal;
+    rssActive = true;
+    return true;
+}
+
+void acc_rss_deactivate(void)
+{
+    rssActive = false;
+}
+
+acc_detector_presence_configuration_t acc_detector_presence_configuration_create(void)
+{
+    acc_detector_presence_configuration_t cfg = calloc(1, sizeof(*cfg));
+    if (cfg != NULL) cfg->powerSaveMode = ACC_POWER_SAVE_MODE_OFF;
+    return cfg;
+}
+
+void acc_detector_presence_configuration_destroy(acc_detector_presence_configuration_t *presence_configuration)
+{
+    free(*presence_configuration);
+    *presence_configuration = NULL;
+}
+
+void acc_detector_presence_configuration_power_save_mode_set(acc_detector_presence_configuration_t configuration,
+                                                             acc_power_save_mode_t power_save_mode)
+{
+    configuration->powerSaveMode = power_save_mode;
+}
+
+void acc_detector_presence_configuration_asynchronous_measurement_set(acc_detector_presence_configuration_t configuration,
+                                                                      bool asynchronous_measurement)
+{
+    configuration->async = asynchronous_measurement;
+}
+
+/* Detector tuning has no effect on a replayed trace */
+void acc_detector_presence_configuration_update_rate_set(acc_detector_presence_configuration_t configuration,
+                                                         float update_rate)
+{
+    (void) configuration;
+    (void) update_rate;
+}
+
+void acc_detector_presence_configuration_detection_threshold_set(acc_detector_presence_configuration_t configuration,
+                                                                 float detection_threshold)
+{
+    (void) configuration;
+    (void) detection_threshold;
+}
+
+void acc_detector_presence_configuration_start_set(acc_detector_presence_configuration_t configuration, float start)
+{
+    (void) configuration;
+    (void) start;
+}
+
+void acc_detector_presence_configuration_length_set(acc_detector_presence_configuration_t configuration, float length)
+{
+    (void) configuration;
+    (void) length;
+}
+
+void acc_detector_presence_configuration_nbr_removed_pc_set(acc_detector_presence_configuration_t configuration,
+                                                            uint8_t nbr_removed_pc)
+{
+    (void) configuration;
+    (void) nbr_removed_pc;
+}
+
+void acc_detector_presence_configuration_service_profile_set(acc_detector_presence_configuration_t configuration,
+                                                             acc_service_profile_t service_profile)
+{
+    (void) configuration;
+    (void) service_profile;
+}
+
+void acc_detector_presence_configuration_hw_accelerated_average_samples_set(acc_detector_presence_configuration_t configuration,
+                                                                            uint8_t samples)
+{
+    (void) configuration;
+    (void) samples;
+}
+
+acc_detector_presence_handle_t acc_detector_presence_create(acc_detector_presence_configuration_t presence_configuration)
+{
+    if (!rssActive || presence_configuration == NULL) return NULL;
+
+    acc_detector_presence_handle_t handle = calloc(1, sizeof(*handle));
+    if (handle != NULL) handle->cfg = *presence_configuration;
+    return handle;
+}
+
+void acc_detector_presence_destroy(acc_detector_presence_handle_t *presence_handle)
+{
+    free(*presence_handle);
+    *presence_handle = NULL;
+}
+
+bool acc_detector_presence_activate(acc_detector_presence_handle_t presence_handle)
+{
+    if (presence_handle == NULL) return false;
+    presence_handle->active = true;
+    presence_handle->sweepPending = false;
+    return true;
+}
+
+bool acc_detector_presence_deactivate(acc_detector_presence_handle_t presence_handle)
+{
+    if (presence_handle == NULL) return false;
+    presence_handle->active = false;
+    return true;
+}
+
+static uint32_t wakeUs(acc_power_save_mode_t mode)
+{
+    switch (mode)
+    {
+        case ACC_POWER_SAVE_MODE_OFF: return rssTiming.wakeOffUs;
+        case ACC_POWER_SAVE_MODE_SLEEP: return rssTiming.wakeSleepUs;
+        case ACC_POWER_SAVE_MODE_HIBERNATE: return rssTiming.wakeHibernateUs;
+        default: return rssTiming.wakeReadyUs;
+    }
+}
+
+bool acc_detector_presence_get_next(acc_detector_presence_handle_t presence_handle, acc_detector_presence_result_t *result)
+{
+    if (presence_handle == NULL || !presence_handle->active) return false;
+
+    shimStats_t *stats = shimStatsMut();
+    const uint64_t begin = shimNowUs();
+    const uint32_t measureUs = wakeUs(presence_handle->cfg.powerSaveMode) + rssTiming.sweepUs;
+    uint64_t sweepAt;
+
+    if (presence_handle->cfg.async && presence_handle->sweepPending)
+    {
+        // Sweep has been running since the previous call returned
+        uint64_t ready = presence_handle->sweepStart + measureUs;
+        uint64_t hidden = begin - presence_handle->sweepStart;
+        stats->overlapUs += hidden < measureUs ? hidden : measureUs;
+        if (ready > begin) shimBusy((uint32_t) (ready - begin));
+        sweepAt = presence_handle->sweepStart;
+    }
+    else
+    {
+        sweepAt = begin;
+        shimBusy(measureUs);
+    }
+    shimBusy(rssTiming.processUs);
+
+    memset(result, 0, sizeof(*result));
+    const traceSample_t *s = traceAt(rssTrace, (uint32_t) (sweepAt / 1000), &rssCursor);
+    if (s != NULL)
+    {
+        result->presence_detected = s->detected;
+        result->presence_score = s->score;
+        result->presence_distance = s->distance;
+    }
+
+    if (presence_handle->cfg.async)
+    {
+        presence_handle->sweepPending = true;
+        presence_handle->sweepStart = shimNowUs();
+    }
+
+    stats->getNextCalls++;
+    stats->getNextUs += shimNowUs() - begin;
+    return true;
+}
@@ -0,0 +1,208 @@
+/*
+ * sim.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: edward62740
+ */
+
+#include <string.h>
+#include "sim.h"
+
+#define SIM_NO_EDGE UINT32_MAX
+
+static float simLux(const traceSample_t *s)
+{
+    return s && s->lux != TRACE_NO_LUX ? s->lux : RADAR_NIGHT_DARK_LUX;
+}
+
+/* Hint time for the first light-on in (fromMs, toMs), SIM_NO_EDGE if none. The
+ * hint itself may land after toMs, the limit fires whatever the radar does */
+static uint32_t simNextHint(const trace_t *trace, uint32_t fromMs, uint32_t toMs, size_t *idx)
+{
+    for (; *idx < trace->count && trace->samples[*idx].tMs <= fromMs; (*idx)++);
+    for (size_t i = *idx; i < trace->count && trace->samples[i].tMs < toMs; i++)
+    {
+        if (simLux(&trace->samples[i]) < RADAR_NIGHT_WAKE_LUX) continue;
+        return trace->samples[i].tMs + SIM_LIGHT_HINT_LATENCY_MS;
+    }
+    return SIM_NO_EDGE;
+}
+
+static void simRunGated(const trace_t *trace, const radarAlgoParams_t *params, radarNight_t *night, bool lightHint,
+                        simResult_t *res)
+{
+    radarAlgoState_t state;
+    radarAlgoInit(&state, params);
+    memset(res, 0, sizeof(*res));
+    res->durationMs = traceDurationMs(trace);
+
+    uint32_t pendingOnset = SIM_NO_EDGE;
+    uint32_t pendingOffset = SIM_NO_EDGE;
+    bool pendingOnsetNight = false;
+    bool pendingOnsetLit = false;
+    bool truth = false;
+    size_t edgeIdx = 0;
+    size_t cursor = 0;
+    bool lastDetected = false; // result is zero-initialised before the first frame
+    float lastScore = 0;
+    size_t hintIdx = 0;
+    uint32_t hint = SIM_NO_EDGE;
+
+    for (uint32_t t = state.delayMs; t <= res->durationMs; t += state.delayMs)
+    {
+        /* Ground-truth edges up to now */
+        for (; edgeIdx < trace->count && trace->samples[edgeIdx].tMs <= t; edgeIdx++)
+        {
+            const traceSample_t *s = &trace->samples[edgeIdx];
+            if (s->truth == truth) continue;
+            truth = s->truth;
+            if (truth)
+            {
+                res->onsets++;
+                pendingOnset = s->tMs;
+                pendingOnsetNight = night != NULL && night->active;
+                pendingOnsetLit = edgeIdx > 0 && simLux(s) >= RADAR_NIGHT_WAKE_LUX
+                        && simLux(&trace->samples[edgeIdx - 1]) < RADAR_NIGHT_DARK_LUX;
+                if (pendingOnsetLit) res->litOnsets++;
+                pendingOffset = SIM_NO_EDGE;
+            }
+            else
+            {
+                if (pendingOnset != SIM_NO_EDGE && pendingOnsetNight) res->nightMissed++;
+                res->offsets++;
+                pendingOffset = s->tMs;
+                pendingOnset = SIM_NO_EDGE;
+            }
+        }
+
+        /* BURTC_IRQHandler() */
+        radarAlgoStep(&state, lastDetected, lastScore);
+        res->frames++;
+
+        /* radarAppAlgo(), assuming the CoAP binding is established */
+        radarAlgoReport_t report = radarAlgoTakeReport(&state);
+        if (report == RADAR_ALGO_REPORT_ACTIVE)
+        {
+            res->reportsActive++;
+            if (pendingOnset != SIM_NO_EDGE)
+            {
+                uint32_t ttd = t - pendingOnset;
+                res->detected++;
+                res->ttdSumMs += ttd;
+                if (ttd > res->ttdMaxMs) res->ttdMaxMs = ttd;
+                if (pendingOnsetLit)
+                {
+                    res->litDetected++;
+                    res->litTtdSumMs += ttd;
+                }
+                pendingOnset = SIM_NO_EDGE;
+            }
+            else res->spuriousReports++;
+        }
+        else if (report == RADAR_ALGO_REPORT_INACTIVE)
+        {
+            res->reportsInactive++;
+            if (pendingOffset != SIM_NO_EDGE)
+            {
+                uint32_t ttc = t - pendingOffset;
+                res->cleared++;
+                res->ttcSumMs += ttc;
+                if (ttc > res->ttcMaxMs) res->ttcMaxMs = ttc;
+                pendingOffset = SIM_NO_EDGE;
+            }
+            else res->spuriousReports++;
+        }
+
+        const traceSample_t *s = traceAt(trace, t, &cursor);
+        lastDetected = s ? s->detected : false;
+        lastScore = s ? s->score : 0;
+
+        /* radarAppAlgo(), after the measurement */
+        float lux = simLux(s);
+        if (night != NULL)
+        {
+            if (radarNightStep(night, t / 1000, lastDetected, state.hystTrigFlag, lux)) radarNightApply(night, &state, 1);
+        }
+
+        /* radarAppLightHint(), armed while dark */
+        if (lightHint && hint == SIM_NO_EDGE && lux < RADAR_NIGHT_DARK_LUX)
+        {
+            hint = simNextHint(trace, t, t + state.delayMs, &hintIdx);
+        }
+        if (hint != SIM_NO_EDGE && hint < t + state.delayMs)
+        {
+            const traceSample_t *h = traceAt(trace, hint, &cursor);
+            if (night != NULL) radarNightLightHint(night, &state, hint / 1000, simLux(h), 1);
+            else radarAlgoBoost(&state, RADAR_APP_DEFAULT_BOOST_FRAMES);
+            lastDetected = h ? h->detected : false;
+            lastScore = h ? h->score : 0;
+            res->frames++;
+            res->hints++;
+            t = hint; // the BURTC counter restarts at the hint
+            hint = SIM_NO_EDGE;
+        }
+    }
+
+    if (pendingOnset != SIM_NO_EDGE && pendingOnsetNight) res->nightMissed++;
+    res->aliveSends = res->durationMs / SIM_ALIVE_INTERVAL_MS;
+    if (night != NULL)
+    {
+        res->nightMs = night->activeS * 1000;
+        res->nightEnters = night->enters;
+    }
+}
+
+void simRun(const trace_t *trace, const radarAlgoParams_t *params, simResult_t *res)
+{
+    simRunGated(trace, params, NULL, false, res);
+}
+
+void simRunNight(const trace_t *trace, const radarAlgoParams_t *params, radarNight_t *night, bool lightHint,
+                 simResult_t *res)
+{
+    simRunGated(trace, params, night, lightHint, res);
+}
+
+uint32_t simCoapSends(const simResult_t *res)
+{
+    return res->reportsActive + res->reportsInactive + res->aliveSends;
+}
+
+void simAccumulate(simResult_t *sum, const simResult_t *r)
+{
+    sum->durationMs += r->durationMs;
+    sum->frames += r->frames;
+    sum->reportsActive += r->reportsActive;
+    sum->reportsInactive += r->reportsInactive;
+    sum->aliveSends += r->aliveSends;
+    sum->onsets += r->onsets;
+    sum->detected += r->detected;
+    sum->ttdSumMs += r->ttdSumMs;
+    if (r->ttdMaxMs > sum->ttdMaxMs) sum->ttdMaxMs = r->ttdMaxMs;
+    sum->offsets += r->offsets;
+    sum->cleared += r->cleared;
+    sum->ttcSumMs += r->ttcSumMs;
+    if (r->ttcMaxMs > sum->ttcMaxMs) sum->ttcMaxMs = r->ttcMaxMs;
+    sum->spuriousReports += r->spuriousReports;
+    sum->nightMs += r->nightMs;
+    sum->nightEnters += r->nightEnters;
+    sum->nightMissed += r->nightMissed;
+    sum->hints += r->hints;
+    sum->litOnsets += r->litOnsets;
+    sum->litDetected += r->litDetected;
+    sum->litTtdSumMs += r->litTtdSumMs;
+}
+
+void simDefaultEnergyModel(simEnergyModel_t *model)
+{
+    model->baseCurrentUa = SIM_DEFAULT_BASE_CURRENT_UA;
+    model->frameChargeUc = SIM_DEFAULT_FRAME_CHARGE_UC;
+    model->sendChargeUc = SIM_DEFAULT_SEND_CHARGE_UC;
+}
+
+double simAverageCurrentUa(const simResult_t *res, const simEnergyModel_t *model)
+{
+    if (res->durationMs == 0) return model->baseCurrentUa;
+    double charge = res->frames * model->frameChargeUc + simCoapSends(res) * model->sendChargeUc;
+    return model->baseCurrentUa + charge / (res->durationMs / 1000.0);
+}
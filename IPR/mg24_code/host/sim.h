@@ -0,0 +1,98 @@
+/*
+ * sim.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: edward62740
+ */
+
+#ifndef SIM_H_
+#define SIM_H_
+
+#include <stdint.h>
+#include "trace.h"
+#include "radar_algo.h"
+#include "radar_night.h"
+
+/* Same cadence as ALIVE_SLEEPTIMER_INTERVAL_MS in main.c */
+#define SIM_ALIVE_INTERVAL_MS 60000
+
+/* OPT3001 limit to light-change hint: one 800 ms conversion plus the INT read */
+#define SIM_LIGHT_HINT_LATENCY_MS 900
+
+/* Charge model for the expected average current. Defaults are rough figures for the
+ * IPR v2 at 1.8 V (63 HWAAS sparse frame, SED with 5 s polling); override per board. */
+#define SIM_DEFAULT_BASE_CURRENT_UA  30.0  // sleep, data polling, OPT3001 continuous
+#define SIM_DEFAULT_FRAME_CHARGE_UC  300.0 // sensor power-up, sweep and processing
+#define SIM_DEFAULT_SEND_CHARGE_UC   150.0 // CoAP PUT incl. ack/poll
+
+typedef struct
+{
+    double baseCurrentUa;
+    double frameChargeUc;
+    double sendChargeUc;
+} simEnergyModel_t;
+
+typedef struct
+{
+    uint32_t durationMs;
+    uint32_t frames;
+    uint32_t reportsActive;
+    uint32_t reportsInactive;
+    uint32_t aliveSends;
+
+    /* Ground-truth onsets (0 -> 1) and their matching ACTIVE reports */
+    uint32_t onsets;
+    uint32_t detected;
+    uint64_t ttdSumMs;
+    uint32_t ttdMaxMs;
+
+    /* Ground-truth offsets (1 -> 0) and their matching INACTIVE reports */
+    uint32_t offsets;
+    uint32_t cleared;
+    uint64_t ttcSumMs;
+    uint32_t ttcMaxMs;
+
+    /* Reports with no pending ground-truth edge */
+    uint32_t spuriousReports;
+
+    /* simRunNight() only */
+    uint32_t nightMs;      // time spent in night mode
+    uint32_t nightEnters;
+    uint32_t nightMissed;  // onsets starting in night mode that were never reported
+    uint32_t hints;        // light-change hints, each took an extra frame
+
+    /* Onsets where the light went on in the dark, the subset a hint can speed up */
+    uint32_t litOnsets;
+    uint32_t litDetected;
+    uint64_t litTtdSumMs;
+} simResult_t;
+
+/**
+ * Replay a trace through the radar state machine the way main.c drives it:
+ * the BURTC compare fires, the state machine steps on the previous frame's
+ * result, a report is sent if one is pending, then the next frame is measured.
+ */
+void simRun(const trace_t *trace, const radarAlgoParams_t *params, simResult_t *res);
+
+/**
+ * simRun() with the night-mode scheduler (radar_night.c) stepped after every frame
+ * on the trace's lux column, as radarAppAlgo() does. Traces without lux count as lit.
+ * night may be NULL to replay the light-change hint alone.
+ *
+ * With lightHint, the OPT3001 limit is armed while the last frame was dark. The
+ * first sample rising above RADAR_NIGHT_WAKE_LUX raises the hint
+ * SIM_LIGHT_HINT_LATENCY_MS later. The hint takes a frame at once, boosts the rate
+ * and restarts the frame timer, as radarAppLightHint() does.
+ */
+void simRunNight(const trace_t *trace, const radarAlgoParams_t *params, radarNight_t *night, bool lightHint,
+                 simResult_t *res);
+
+uint32_t simCoapSends(const simResult_t *res);
+
+/* Add the counters of r to sum (max fields take the maximum) */
+void simAccumulate(simResult_t *sum, const simResult_t *r);
+
+void simDefaultEnergyModel(simEnergyModel_t *model);
+double simAverageCurrentUa(const simResult_t *res, const simEnergyModel_t *model);
+
+#endif /* SIM_H_ */
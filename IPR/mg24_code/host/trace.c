@@ -0,0 +1,80 @@
+/*
+ * trace.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: edward62740
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "trace.h"
+
+bool traceLoad(trace_t *trace, const char *path)
+{
+    FILE *f = fopen(path, "r");
+    if (f == NULL) return false;
+
+    memset(trace, 0, sizeof(*trace));
+    const char *base = strrchr(path, '/');
+    snprintf(trace->name, sizeof(trace->name), "%s", base ? base + 1 : path);
+
+    size_t cap = 0;
+    char line[256];
+    while (fgets(line, sizeof(line), f) != NULL)
+    {
+        char *hash = strchr(line, '#');
+        if (hash) *hash = '\0';
+
+        unsigned long t;
+        int detected, truth;
+        float score, distance, lux;
+        int n = sscanf(line, "%lu,%d,%f,%f,%d,%f", &t, &detected, &score, &distance, &truth, &lux);
+        if (n < 4) continue;
+
+        if (trace->count == cap)
+        {
+            cap = cap ? cap * 2 : 1024;
+            traceSample_t *grown = realloc(trace->samples, cap * sizeof(*grown));
+            if (grown == NULL)
+            {
+                fclose(f);
+                traceFree(trace);
+                return false;
+            }
+            trace->samples = grown;
+        }
+        traceSample_t *s = &trace->samples[trace->count++];
+        s->tMs = (uint32_t) t;
+        s->detected = detected != 0;
+        s->score = score;
+        s->distance = distance;
+        s->truth = n >= 5 ? truth != 0 : s->detected;
+        s->lux = n == 6 ? lux : TRACE_NO_LUX;
+    }
+    fclose(f);
+    return trace->count > 0;
+}
+
+void traceFree(trace_t *trace)
+{
+    free(trace->samples);
+    trace->samples = NULL;
+    trace->count = 0;
+}
+
+const traceSample_t *traceAt(const trace_t *trace, uint32_t tMs, size_t *cursor)
+{
+    size_t i = cursor ? *cursor : 0;
+    if (trace->count == 0 || tMs < trace->samples[0].tMs) return NULL;
+    if (i >= trace->count || trace->samples[i].tMs > tMs) i = 0;
+
+    while (i + 1 < trace->count && trace->samples[i + 1].tMs <= tMs) i++;
+    if (cursor) *cursor = i;
+    return &trace->samples[i];
+}
+
+uint32_t traceDurationMs(const trace_t *trace)
+{
+    return trace->count ? trace->samples[trace->count - 1].tMs : 0;
+}
@@ -0,0 +1,51 @@
+/*
+ * trace.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: edward62740
+ */
+
+#ifndef TRACE_H_
+#define TRACE_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Recorded acc_detector_presence_result_t trace.
+ *
+ * Text format, one sample per line, '#' starts a comment:
+ *     t_ms,presence_detected,presence_score,presence_distance[,truth[,lux]]
+ * The optional truth column (0/1) is the ground-truth occupancy used for latency
+ * metrics; when absent presence_detected is used. The optional lux column is the
+ * ambient light; when absent it is TRACE_NO_LUX. Samples must be sorted by t_ms.
+ * A sample holds until the next one, so traces can be replayed at any frame rate. */
+
+#define TRACE_NO_LUX (-1.0f)
+
+typedef struct
+{
+    uint32_t tMs;
+    bool detected;
+    float score;
+    float distance;
+    bool truth;
+    float lux;
+} traceSample_t;
+
+typedef struct
+{
+    char name[128];
+    traceSample_t *samples;
+    size_t count;
+} trace_t;
+
+bool traceLoad(trace_t *trace, const char *path);
+void traceFree(trace_t *trace);
+
+/* Sample in effect at time tMs (zero-order hold), NULL before the first sample */
+const traceSample_t *traceAt(const trace_t *trace, uint32_t tMs, size_t *cursor);
+
+uint32_t traceDurationMs(const trace_t *trace);
+
+#endif /* TRACE_H_ */
@@ -0,0 +1,144 @@
+/*
+ * trace_decode.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: edward62740
+ *
+ *  Decodes a binary trace dump (the concatenated Block2 payloads of a GET on
+ *  the IPR "trace" resource, see trace_rec.h) into the text trace format read
+ *  by radar_replay/radar_bench.
+ *
+ *  usage: trace_decode [-x] dump.bin > trace.csv
+ *      -x  also print delay_ms and detect_conf (not replayable)
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include "trace_rec.h"
+
+/* Block times wrap after TRACE_REC_T0_WRAP_MS, frame times are printed unwrapped */
+static uint64_t wrapBaseMs;
+static uint32_t lastT0;
+
+static int decodeBlock(const uint8_t *blk, bool extended)
+{
+    uint32_t t0 = (uint32_t) blk[2] | (uint32_t) blk[3] << 8 | (uint32_t) blk[4] << 16 | (uint32_t) blk[5] << 24;
+    if (t0 < lastT0) wrapBaseMs += TRACE_REC_T0_WRAP_MS;
+    lastT0 = t0;
+    uint64_t t = wrapBaseMs + t0;
+    size_t used = blk[6];
+    if (used > TRACE_REC_PAYLOAD_SIZE) return -1;
+
+    const uint8_t *p = &blk[TRACE_REC_HEADER_SIZE];
+    const uint8_t *end = p + used;
+    int32_t score = 0, idleScore = 0, distance = 0;
+    uint32_t delay = 0, v;
+    uint8_t conf = 0;
+    size_t n;
+
+    while (p < end)
+    {
+        uint8_t hdr = *p++;
+        bool detected = hdr & TRACE_REC_HDR_DETECTED;
+
+        if (hdr & TRACE_REC_HDR_CONF)
+        {
+            if (p >= end) return -1;
+            conf = *p++;
+        }
+        if (hdr & TRACE_REC_HDR_DELAY)
+        {
+            if ((n = traceRecGetVarint(p, (size_t) (end - p), &v)) == 0) return -1;
+            p += n;
+            delay += (uint32_t) traceRecUnzigzag(v);
+        }
+        int32_t scoreDelta = (int32_t) (hdr & TRACE_REC_HDR_SCORE_MASK);
+        if (scoreDelta & 0x08) scoreDelta -= 0x10;
+        if (scoreDelta == TRACE_REC_SCORE_ESCAPE)
+        {
+            if ((n = traceRecGetVarint(p, (size_t) (end - p), &v)) == 0) return -1;
+            p += n;
+            scoreDelta = traceRecUnzigzag(v);
+        }
+        if (detected)
+        {
+            score += scoreDelta;
+            if ((n = traceRecGetVarint(p, (size_t) (end - p), &v)) == 0) return -1;
+            p += n;
+            distance += traceRecUnzigzag(v);
+        }
+        else idleScore += scoreDelta;
+        uint32_t repeat = 0;
+        if (hdr & TRACE_REC_HDR_REPEAT)
+        {
+            if ((n = traceRecGetVarint(p, (size_t) (end - p), &repeat)) == 0) return -1;
+            p += n;
+        }
+
+        for (uint32_t k = 0; k <= repeat; k++)
+        {
+            printf("%llu,%d,%.3f,%.3f", (unsigned long long) t, detected ? 1 : 0,
+                   detected ? (double) score / TRACE_REC_SCORE_SCALE : (double) idleScore / TRACE_REC_IDLE_SCORE_SCALE,
+                   detected ? (double) distance / TRACE_REC_DIST_SCALE : 0.0);
+            if (extended) printf(",%lu,%u", (unsigned long) delay, conf);
+            printf("\n");
+            t += delay;
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    bool extended = false;
+    int opt;
+    while ((opt = getopt(argc, argv, "xh")) != -1)
+    {
+        if (opt == 'x') extended = true;
+        else
+        {
+            fprintf(stderr, "usage: %s [-x] dump.bin\n", argv[0]);
+            return 2;
+        }
+    }
+    if (optind >= argc)
+    {
+        fprintf(stderr, "usage: %s [-x] dump.bin\n", argv[0]);
+        return 2;
+    }
+
+    FILE *f = fopen(argv[optind], "rb");
+    if (f == NULL)
+    {
+        perror(argv[optind]);
+        return 1;
+    }
+
+    printf("# decoded from %s\n", argv[optind]);
+    printf(extended ? "# t_ms,presence_detected,presence_score,presence_distance,delay_ms,detect_conf\n"
+                    : "# t_ms,presence_detected,presence_score,presence_distance\n");
+
+    uint8_t blk[TRACE_REC_BLOCK_SIZE];
+    bool haveSeq = false;
+    uint16_t lastSeq = 0;
+    int status = 0;
+    while (fread(blk, 1, sizeof(blk), f) == sizeof(blk))
+    {
+        uint16_t seq = (uint16_t) (blk[0] | blk[1] << 8);
+        /* Blocks evicted or re-sent while the dump was in progress */
+        if (haveSeq && (int16_t) (seq - lastSeq) <= 0) continue;
+        if (haveSeq && seq != (uint16_t) (lastSeq + 1))
+            printf("# gap: %u block(s) missing\n", (unsigned) (uint16_t) (seq - lastSeq - 1));
+        haveSeq = true;
+        lastSeq = seq;
+
+        if (decodeBlock(blk, extended) != 0)
+        {
+            fprintf(stderr, "block %u: malformed\n", seq);
+            status = 1;
+        }
+    }
+    fclose(f);
+    return status;
+}
@@ -0,0 +1,221 @@
+/*
+ * txq_check.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: edward62740
+ *
+ *  Checks the delivery queue (app_txq.c):
+ *  - a state report that supersedes the head, in flight or waiting for its
+ *    retry, starts over with its own APP_TXQ_MAX_TRIES attempts;
+ *  - the limit only drops the message that failed, a newer report queued
+ *    behind one on its last attempt is still sent;
+ *  - retries back off from APP_TXQ_BACKOFF_MS with up to 25 % jitter, an
+ *    attempt without a result fails after APP_TXQ_LOST_MS;
+ *  - messages without a key are never coalesced, a full queue drops the oldest
+ *    one that is not in flight, and results of older attempts are ignored.
+ *  Prints each failed check and exits non-zero if there was any.
+ *
+ *  usage: txq_check [seed]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "app_txq.h"
+
+static unsigned errors;
+
+#define CHECK(cond, ...)                                         \
+    do                                                           \
+    {                                                            \
+        if (!(cond))                                             \
+        {                                                        \
+            errors++;                                            \
+            printf("FAIL %s:%d: ", __func__, __LINE__);          \
+            printf(__VA_ARGS__);                                 \
+            printf("\n");                                        \
+        }                                                        \
+    } while (0)
+
+static void push(appTxq_t *q, const char *text, uint8_t key, uint32_t nowMs)
+{
+    appTxqPush(q, (const uint8_t *) text, (uint16_t) strlen(text), 0, key, nowMs);
+}
+
+static bool headIs(const appTxq_t *q, const char *text)
+{
+    return q->count > 0 && q->msg[0].len == strlen(text) && memcmp(q->msg[0].buf, text, strlen(text)) == 0;
+}
+
+/* Sends the head once it is due and fails it, returns the time of the failure */
+static uint32_t sendFail(appTxq_t *q, uint32_t nowMs)
+{
+    nowMs += appTxqWaitMs(q, nowMs);
+    const appTxqMsg_t *m = appTxqNext(q, nowMs);
+    CHECK(m != NULL, "head not sent at %u", nowMs);
+    if (m != NULL) appTxqFail(q, m->seq, nowMs + 100);
+    return nowMs + 100;
+}
+
+static void checkSupersedeLast(uint32_t seed)
+{
+    appTxq_t q;
+    appTxqInit(&q, seed);
+    uint32_t now = 0;
+
+    // "occupied" fails up to its last attempt, "vacant" is queued while that is in flight
+    push(&q, "occupied", APP_TXQ_KEY_STATE, now);
+    for (unsigned k = 0; k < APP_TXQ_MAX_TRIES - 1; k++) now = sendFail(&q, now);
+    CHECK(q.msg[0].tries == APP_TXQ_MAX_TRIES - 1, "tries %u before the last attempt", q.msg[0].tries);
+    now += appTxqWaitMs(&q, now);
+    const appTxqMsg_t *m = appTxqNext(&q, now);
+    CHECK(m != NULL, "last attempt not sent");
+    if (m == NULL) return;
+    uint16_t seq = m->seq;
+    push(&q, "vacant", APP_TXQ_KEY_STATE, now + 50);
+    CHECK(q.count == 2, "in-flight report overwritten, count %u", q.count);
+    appTxqFail(&q, seq, now + 100);
+    now += 100;
+
+    // The failed one is given up, the newer one goes out with fresh attempts
+    CHECK(q.stats.failed == 1, "failed %u, expected 1", q.stats.failed);
+    CHECK(q.count == 1 && headIs(&q, "vacant"), "newer report dropped with the failed one");
+    CHECK(q.msg[0].tries == 0, "newer report inherited %u tries", q.msg[0].tries);
+    CHECK(q.msg[0].queuedMs == now - 50, "queued at %u", q.msg[0].queuedMs);
+
+    // It has all of its attempts, and is dropped after the last one
+    for (unsigned k = 0; k < APP_TXQ_MAX_TRIES - 1; k++) now = sendFail(&q, now);
+    CHECK(q.count == 1 && headIs(&q, "vacant") && q.stats.failed == 1,
+          "newer report dropped after %u attempts", APP_TXQ_MAX_TRIES - 1);
+    now = sendFail(&q, now);
+    CHECK(q.count == 0 && q.stats.failed == 2, "count %u failed %u after the last attempt", q.count, q.stats.failed);
+    CHECK(appTxqWaitMs(&q, now) == UINT32_MAX, "empty queue waits");
+}
+
+static void checkSupersedeWaiting(uint32_t seed)
+{
+    appTxq_t q;
+    appTxqInit(&q, seed);
+    uint32_t now = 1000;
+
+    // Overwritten while it waits for a retry: same due time, attempts start over
+    push(&q, "occupied", APP_TXQ_KEY_STATE, now);
+    for (unsigned k = 0; k < APP_TXQ_MAX_TRIES - 1; k++) now = sendFail(&q, now);
+    uint32_t due = q.msg[0].dueMs;
+    push(&q, "vacant", APP_TXQ_KEY_STATE, now);
+    CHECK(q.count == 1 && headIs(&q, "vacant"), "waiting report not overwritten");
+    CHECK(q.msg[0].tries == 0, "overwritten report kept %u tries", q.msg[0].tries);
+    CHECK(q.msg[0].dueMs == due, "due moved from %u to %u", due, q.msg[0].dueMs);
+    CHECK(q.stats.coalesced == 1, "coalesced %u, expected 1", q.stats.coalesced);
+
+    // Not counted as a retry, and its first ack is an RTT sample (Karn)
+    now += appTxqWaitMs(&q, now);
+    uint32_t retries = q.stats.retries;
+    const appTxqMsg_t *m = appTxqNext(&q, now);
+    CHECK(m != NULL && q.stats.retries == retries, "first attempt counted as a retry");
+    if (m == NULL) return;
+    appTxqAck(&q, m->seq, now + 300);
+    CHECK(q.stats.acked == 1 && q.stats.failed == 0, "acked %u failed %u", q.stats.acked, q.stats.failed);
+    CHECK(q.stats.rttSamples == 1 && q.stats.srttMs == 300, "RTT samples %u srtt %u", q.stats.rttSamples, q.stats.srttMs);
+}
+
+static void checkSupersedeFailed(uint32_t seed)
+{
+    appTxq_t q;
+    appTxqInit(&q, seed);
+    uint32_t now = 0;
+
+    // A failure before the last attempt: the newer report replaces it and is not a retry
+    push(&q, "occupied", APP_TXQ_KEY_STATE, now);
+    now = sendFail(&q, now);
+    now = sendFail(&q, now);
+    now += appTxqWaitMs(&q, now);
+    const appTxqMsg_t *m = appTxqNext(&q, now);
+    CHECK(m != NULL, "retry not sent");
+    if (m == NULL) return;
+    uint16_t seq = m->seq;
+    push(&q, "vacant", APP_TXQ_KEY_STATE, now);
+    appTxqFail(&q, seq, now + 100);
+    now += 100;
+    CHECK(q.count == 1 && headIs(&q, "vacant") && q.msg[0].tries == 0, "count %u tries %u", q.count, q.msg[0].tries);
+    CHECK(q.stats.coalesced == 1 && q.stats.failed == 0, "coalesced %u failed %u", q.stats.coalesced, q.stats.failed);
+
+    // Its first attempt follows the first backoff, not the third
+    uint32_t wait = appTxqWaitMs(&q, now);
+    CHECK(wait >= APP_TXQ_BACKOFF_MS && wait <= APP_TXQ_BACKOFF_MS * 5 / 4, "replacement waits %u", wait);
+}
+
+static void checkBackoff(uint32_t seed)
+{
+    appTxq_t q;
+    appTxqInit(&q, seed);
+    uint32_t now = 0, backoff = APP_TXQ_BACKOFF_MS;
+
+    // Doubling up to the cap, plus jitter; the message without a key is kept apart
+    push(&q, "alive", APP_TXQ_KEY_NONE, now);
+    push(&q, "alive", APP_TXQ_KEY_NONE, now);
+    CHECK(q.count == 2 && q.stats.coalesced == 0, "messages without a key coalesced");
+    for (unsigned k = 0; k < APP_TXQ_MAX_TRIES - 1; k++)
+    {
+        now = sendFail(&q, now);
+        uint32_t wait = appTxqWaitMs(&q, now);
+        CHECK(wait >= backoff && wait <= backoff + backoff / 4, "retry %u waits %u, expected %u..%u", k, wait, backoff,
+              backoff + backoff / 4);
+        backoff = backoff * 2 < APP_TXQ_BACKOFF_MAX_MS ? backoff * 2 : APP_TXQ_BACKOFF_MAX_MS;
+    }
+    CHECK(q.stats.retries == APP_TXQ_MAX_TRIES - 2, "retries %u", q.stats.retries);
+
+    // An attempt without a result fails once APP_TXQ_LOST_MS is up
+    now += appTxqWaitMs(&q, now);
+    const appTxqMsg_t *m = appTxqNext(&q, now);
+    CHECK(m != NULL, "last attempt not sent");
+    uint16_t seq = m ? m->seq : 0;
+    CHECK(appTxqWaitMs(&q, now) == APP_TXQ_LOST_MS, "in flight waits %u", appTxqWaitMs(&q, now));
+    CHECK(appTxqNext(&q, now + APP_TXQ_LOST_MS - 1) == NULL, "second message sent while one is in flight");
+    m = appTxqNext(&q, now + APP_TXQ_LOST_MS);
+    CHECK(q.stats.failed == 1 && m != NULL && m->seq != seq, "lost attempt not failed");
+
+    // A late result of the given up attempt changes nothing
+    appTxqAck(&q, seq, now + APP_TXQ_LOST_MS + 10);
+    CHECK(q.stats.acked == 0 && q.count == 1 && q.inFlight, "stale ack taken");
+}
+
+static void checkFull(uint32_t seed)
+{
+    appTxq_t q;
+    appTxqInit(&q, seed);
+    char text[8];
+
+    // The head in flight stays, the oldest one behind it goes
+    for (unsigned k = 0; k < APP_TXQ_SLOTS; k++)
+    {
+        snprintf(text, sizeof(text), "m%u", k);
+        push(&q, text, APP_TXQ_KEY_NONE, k);
+    }
+    CHECK(appTxqNext(&q, 10) != NULL, "head not sent");
+    push(&q, "new", APP_TXQ_KEY_NONE, 20);
+    CHECK(q.count == APP_TXQ_SLOTS && q.stats.dropped == 1, "count %u dropped %u", q.count, q.stats.dropped);
+    CHECK(headIs(&q, "m0") && q.msg[1].len == 2 && q.msg[1].buf[1] == '2', "wrong message dropped");
+
+    uint8_t big[APP_TXQ_MAX_LEN + 1] = { 0 };
+    CHECK(!appTxqPush(&q, big, sizeof(big), 0, APP_TXQ_KEY_STATE, 30), "too long message queued");
+    CHECK(q.stats.dropped == 2 && !appTxqPending(&q, APP_TXQ_KEY_STATE), "too long message counted %u", q.stats.dropped);
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t seed = argc > 1 ? (uint32_t) strtoul(argv[1], NULL, 0) : 1;
+    if (argc > 2)
+    {
+        fprintf(stderr, "usage: %s [seed]\n", argv[0]);
+        return 2;
+    }
+
+    checkSupersedeLast(seed);
+    checkSupersedeWaiting(seed);
+    checkSupersedeFailed(seed);
+    checkBackoff(seed);
+    checkFull(seed);
+    printf("%s, %u failed checks\n", errors ? "FAILED" : "ok", errors);
+    return errors == 0 ? 0 : 1;
+}
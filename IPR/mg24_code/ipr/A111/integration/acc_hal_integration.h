@@ -14,4 +14,80 @@
 const acc_hal_t *acc_hal_integration_get_implementation(void);
 
 
+/**
+ * @brief HAL instrumentation counters
+ */
+typedef struct
+{
+	/** Power-on to the first data-ready interrupt, last frame [us] */
+	uint32_t wake_to_data_us_last;
+	/** Maximum of the above since boot [us] */
+	uint32_t wake_to_data_us_max;
+	/** Number of power-ons */
+	uint32_t wakes;
+
+	/** SPI cost of the last frame, see acc_hal_integration_frame_end() */
+	uint32_t spi_transfers;
+	uint32_t spi_bytes;
+	/** Core cycles spent outside EM1 in the transfer functions */
+	uint32_t spi_cpu_cycles;
+	/** Wall time from first CS assert to last CS release, summed over transfers [us] */
+	uint32_t spi_us;
+	/** Frame width in use, 8 (byte path) or 16 (transfer16) */
+	uint8_t spi_width;
+
+	/** Time spent sleeping on the sensor interrupt in the last frame [us] */
+	uint32_t wait_us;
+	/** Sensor interrupt waits that ended in a timeout */
+	uint32_t wait_timeouts;
+} acc_hal_integration_stats_t;
+
+
+/**
+ * @brief Get a snapshot of the HAL instrumentation counters
+ */
+void acc_hal_integration_get_stats(acc_hal_integration_stats_t *stats);
+
+
+/**
+ * @brief Latch the SPI and wait counters accumulated since the previous call as the last frame's cost
+ */
+void acc_hal_integration_frame_end(void);
+
+
+/**
+ * @brief Power manager hook, false while a sensor wait has already been satisfied
+ *
+ * Closes the window between the ready check and the sleep entry, call it from app_is_ok_to_sleep().
+ */
+bool acc_hal_integration_ok_to_sleep(void);
+
+
+/**
+ * @brief Per-frame result of acc_hal_integration_spi_bench()
+ */
+typedef struct
+{
+	uint32_t transfers;
+	uint32_t cpu_cycles;
+	uint32_t us;
+} acc_hal_integration_spi_bench_t;
+
+
+/**
+ * @brief Measure the SPI cost of moving a frame of frame_bytes in transfers of at most chunk_bytes
+ *
+ * Runs with the sensor deselected, so it can be called between frames. chunk_bytes = 2048
+ * reproduces the single-descriptor split, chunk_bytes = frame_bytes the chained transfer.
+ *
+ * @param[in]  frame_bytes Bytes per simulated frame, at most two max_spi_transfer_size
+ * @param[in]  chunk_bytes Bytes per transfer, at most the advertised max_spi_transfer_size
+ * @param[in]  iterations  Number of frames to average over, at most 64
+ * @param[out] result      Averages per frame
+ * @return False if the arguments are out of range
+ */
+bool acc_hal_integration_spi_bench(size_t frame_bytes, size_t chunk_bytes, uint32_t iterations,
+                                   acc_hal_integration_spi_bench_t *result);
+
+
 #endif
@@ -22,8 +22,13 @@
 #include "acc_definitions_common.h"
 #include "acc_hal_definitions.h"
 #include "acc_hal_integration.h"
+#include "acc_integration.h"
 #include "acc_integration_log.h"
 #include "sl_spidrv_instances.h"
+#include "sl_sleeptimer.h"
+#include "sl_power_manager.h"
+#include "gpiointerrupt.h"
+#include "app_arena.h"
 
 /**
  * @brief The number of sensors available on the board
@@ -34,7 +39,26 @@
  * @brief Size of SPI transfer buffer
  */
 #ifndef A111_SPI_MAX_TRANSFER_SIZE
-#define A111_SPI_MAX_TRANSFER_SIZE 2048 // Maximum LDMA transfer
+#define A111_SPI_MAX_TRANSFER_SIZE 8192 // Whole sweeps in one chained transfer, 2048 for the single-descriptor split
+#endif
+
+/**
+ * @brief Maximum units per LDMA descriptor (XFERCNT is 11 bits), longer transfers are chained
+ */
+#define LDMA_MAX_XFER_UNITS 2048
+#define LDMA_CHAIN_LENGTH   ((A111_SPI_MAX_TRANSFER_SIZE + LDMA_MAX_XFER_UNITS - 1) / LDMA_MAX_XFER_UNITS)
+
+/**
+ * @brief Bounds of acc_hal_integration_spi_bench(), it blocks the main loop while it runs
+ */
+#define SPI_BENCH_MAX_FRAME_BYTES (2 * A111_SPI_MAX_TRANSFER_SIZE)
+#define SPI_BENCH_MAX_ITERATIONS  64
+
+/**
+ * @brief Use 16-bit EUSART frames and half-word LDMA for RSS transfers (0 to compare with the byte path)
+ */
+#ifndef A111_SPI_USE_TRANSFER16
+#define A111_SPI_USE_TRANSFER16 1
 #endif
 
 #define ACC_BOARD_REF_FREQ 26000000
@@ -43,16 +67,38 @@
 #define RX_LDMA_CHANNEL 0
 #define TX_LDMA_CHANNEL 1
 
-// LDMA descriptor and transfer configuration structures for TX channel
-LDMA_Descriptor_t ldmaTXDescriptor;
+// LDMA descriptor chain and transfer configuration structures for TX channel
+LDMA_Descriptor_t ldmaTXDescriptor[LDMA_CHAIN_LENGTH];
 LDMA_TransferCfg_t ldmaTXConfig;
 
-// LDMA descriptor and transfer configuration structures for RX channel
-LDMA_Descriptor_t ldmaRXDescriptor;
+// LDMA descriptor chain and transfer configuration structures for RX channel
+LDMA_Descriptor_t ldmaRXDescriptor[LDMA_CHAIN_LENGTH];
 LDMA_TransferCfg_t ldmaRXConfig;
 
 volatile bool _await_ldma_spi;
 
+static acc_hal_integration_stats_t hal_stats;
+
+/* SPI and wait cost of the frame in progress, latched by acc_hal_integration_frame_end() */
+typedef struct
+{
+    uint32_t transfers;
+    uint32_t bytes;
+    uint32_t cpu_cycles;
+    uint32_t ticks;
+    uint32_t wait_ticks; // sensor interrupt waits
+} spi_counters_t;
+
+static spi_counters_t spi_frame;
+
+/* Sensor interrupt wait, see acc_hal_integration_wait_for_sensor_interrupt() */
+static sl_sleeptimer_timer_handle_t sensor_timeout_timer;
+static volatile bool sensor_ready;
+static volatile bool sensor_timed_out;
+static volatile bool sensor_waiting;
+static uint32_t wake_begin_tick;
+static bool wake_pending;
+
 static inline void disable_interrupts(void) {
 	__disable_irq();
 }
@@ -89,41 +135,142 @@ void LDMA_IRQHandler()
 // Implementation of RSS HAL handlers
 //----------------------------------------
 
-static void acc_hal_integration_sensor_transfer(acc_sensor_id_t sensor_id,
-        uint8_t *buffer, size_t buffer_size) {
-    (void) sensor_id;  // Ignore parameter sensor_id
+/* FRAMECFG is only writable while the EUSART is disabled, so only touch it on a width change */
+static void eusart_set_databits(uint32_t databits)
+{
+    if ((EUSART1->FRAMECFG & _EUSART_FRAMECFG_DATABITS_MASK) == databits) return;
+
+    EUSART_Enable(EUSART1, eusartDisable);
+    EUSART1->FRAMECFG = (EUSART1->FRAMECFG & ~_EUSART_FRAMECFG_DATABITS_MASK) | databits;
+    EUSART_Enable(EUSART1, eusartEnable);
+}
+
+/*
+ * Fill both descriptor chains for count units of the given size. Every descriptor but
+ * the last links to the next one, so the whole transfer runs without CPU involvement
+ * and only the last RX descriptor raises the done interrupt. With increment false the
+ * buffer is a single unit that is sent repeatedly and overwritten (benchmark only).
+ */
+static void spi_ldma_build_chain(void *buffer, size_t count, LDMA_CtrlSize_t size, bool increment)
+{
+    const size_t unit = (size == ldmaCtrlSizeHalf) ? 2 : 1;
+    uint8_t *p = buffer;
+    size_t n = 0;
 
-    GPIO_PinOutClear(A111_CS_PORT, A111_CS_PIN);
+    while (count > 0)
+    {
+        const size_t units = count > LDMA_MAX_XFER_UNITS ? LDMA_MAX_XFER_UNITS : count;
+        const bool last = (units == count);
+
+        // Source is the buffer, destination is EUSART1_TXDATA
+        ldmaTXDescriptor[n] = (LDMA_Descriptor_t)LDMA_DESCRIPTOR_LINKREL_M2P_BYTE(p, &(EUSART1->TXDATA), units, 1);
+        // Source is EUSART1_RXDATA, destination is the buffer
+        ldmaRXDescriptor[n] = (LDMA_Descriptor_t)LDMA_DESCRIPTOR_LINKREL_P2M_BYTE(&(EUSART1->RXDATA), p, units, 1);
+
+        ldmaTXDescriptor[n].xfer.size = size;
+        ldmaRXDescriptor[n].xfer.size = size;
+        ldmaTXDescriptor[n].xfer.link = !last;
+        ldmaRXDescriptor[n].xfer.link = !last;
+        ldmaTXDescriptor[n].xfer.doneIfs = last;
+        ldmaRXDescriptor[n].xfer.doneIfs = last;
+        if (!increment)
+        {
+            ldmaTXDescriptor[n].xfer.srcInc = ldmaCtrlSrcIncNone;
+            ldmaRXDescriptor[n].xfer.dstInc = ldmaCtrlDstIncNone;
+        }
+        else
+        {
+            p += units * unit;
+        }
+
+        count -= units;
+        n++;
+    }
+}
+
+/* Full-duplex transfer of count units of the given LDMA unit size, in place */
+static void spi_ldma_run(void *buffer, size_t count, LDMA_CtrlSize_t size, bool select, bool increment)
+{
+    const uint32_t cycles_begin = DWT->CYCCNT;
+    const uint32_t ticks_begin = sl_sleeptimer_get_tick_count();
+    uint32_t sleep_cycles = 0;
+
+    if (select) GPIO_PinOutClear(A111_CS_PORT, A111_CS_PIN);
 
     _await_ldma_spi = false;
 
-    // Source is outbuf, destination is EUSART1_TXDATA, and length if BUFLEN
-    ldmaTXDescriptor = (LDMA_Descriptor_t)LDMA_DESCRIPTOR_SINGLE_M2P_BYTE(buffer, &(EUSART1->TXDATA), buffer_size);
+    spi_ldma_build_chain(buffer, count, size, increment);
 
-    // Transfer a byte on free space in the EUSART FIFO
+    // Transfer a frame on free space in the EUSART FIFO
     ldmaTXConfig = (LDMA_TransferCfg_t)LDMA_TRANSFER_CFG_PERIPHERAL(ldmaPeripheralSignal_EUSART1_TXFL);
 
-    // Source is EUSART1_RXDATA, destination is inbuf, and length if BUFLEN
-    ldmaRXDescriptor = (LDMA_Descriptor_t)LDMA_DESCRIPTOR_SINGLE_P2M_BYTE(&(EUSART1->RXDATA), buffer, buffer_size);
-
-    // Transfer a byte on receive FIFO level event
+    // Transfer a frame on receive FIFO level event
     ldmaRXConfig = (LDMA_TransferCfg_t)LDMA_TRANSFER_CFG_PERIPHERAL(ldmaPeripheralSignal_EUSART1_RXFL);
 
-    LDMA_StartTransfer(RX_LDMA_CHANNEL, &ldmaRXConfig, &ldmaRXDescriptor);
-    LDMA_StartTransfer(TX_LDMA_CHANNEL, &ldmaTXConfig, &ldmaTXDescriptor);
+    LDMA_StartTransfer(RX_LDMA_CHANNEL, &ldmaRXConfig, ldmaRXDescriptor);
+    LDMA_StartTransfer(TX_LDMA_CHANNEL, &ldmaTXConfig, ldmaTXDescriptor);
 
-    // Wait in EM1 until all data is received
+    // Wait in EM1 until all data is received, CYCCNT keeps running only while the core is clocked
     while (!_await_ldma_spi)
-      EMU_EnterEM1();
+    {
+        uint32_t c = DWT->CYCCNT;
+        EMU_EnterEM1();
+        sleep_cycles += DWT->CYCCNT - c;
+    }
 
     // De-assert chip select upon transfer completion (drive high)
-    GPIO_PinOutSet(A111_CS_PORT, A111_CS_PIN);
+    if (select) GPIO_PinOutSet(A111_CS_PORT, A111_CS_PIN);
+
+    spi_frame.transfers++;
+    spi_frame.bytes += count * (size == ldmaCtrlSizeHalf ? 2 : 1);
+    spi_frame.cpu_cycles += DWT->CYCCNT - cycles_begin - sleep_cycles;
+    spi_frame.ticks += sl_sleeptimer_get_tick_count() - ticks_begin;
+}
+
+static void acc_hal_integration_sensor_transfer(acc_sensor_id_t sensor_id,
+        uint8_t *buffer, size_t buffer_size) {
+    (void) sensor_id;  // Ignore parameter sensor_id
+
+    eusart_set_databits(EUSART_FRAMECFG_DATABITS_EIGHT);
+    spi_ldma_run(buffer, buffer_size, ldmaCtrlSizeByte, true, true);
+}
+
+#if A111_SPI_USE_TRANSFER16
+/* 16-bit frames, MSB first: one LDMA request and one FIFO entry per half-word */
+static void acc_hal_integration_sensor_transfer16(acc_sensor_id_t sensor_id,
+        uint16_t *buffer, size_t buffer_length) {
+    (void) sensor_id;  // Ignore parameter sensor_id
+
+    eusart_set_databits(EUSART_FRAMECFG_DATABITS_SIXTEEN);
+    spi_ldma_run(buffer, buffer_length, ldmaCtrlSizeHalf, true, true);
 }
+#endif
 
 
+/* Start of a wake-to-data measurement, ends at the next sensor interrupt */
+static void wake_mark(void)
+{
+    wake_begin_tick = sl_sleeptimer_get_tick_count();
+    wake_pending = true;
+    hal_stats.wakes++;
+}
+
+static void wake_complete(void)
+{
+    if (!wake_pending) return;
+    wake_pending = false;
+
+    uint32_t ticks = sl_sleeptimer_get_tick_count() - wake_begin_tick;
+    uint32_t us = (uint32_t) (((uint64_t) ticks * 1000000) / sl_sleeptimer_get_timer_frequency());
+    hal_stats.wake_to_data_us_last = us;
+    if (us > hal_stats.wake_to_data_us_max) hal_stats.wake_to_data_us_max = us;
+}
+
 static void acc_hal_integration_sensor_power_on(acc_sensor_id_t sensor_id) {
 	(void) sensor_id;  // Ignore parameter sensor_id
 
+	wake_mark();
+
 	GPIO_PinOutSet(A111_EN_PORT, A111_EN_PIN);
 	GPIO_PinOutSet(A111_CS_PORT, A111_CS_PIN);
 	// Wait 3 ms to make sure that the sensor crystal have time to stabilize
@@ -138,26 +285,57 @@ static void acc_hal_integration_sensor_power_off(acc_sensor_id_t sensor_id) {
 	//acc_integration_sleep_ms(5);
 }
 
+static void sensor_int_callback(uint8_t int_no)
+{
+    (void) int_no;
+    sensor_ready = true;
+}
+
+static void sensor_timeout_callback(sl_sleeptimer_timer_handle_t *handle, void *data)
+{
+    (void) handle;
+    (void) data;
+    sensor_timed_out = true;
+}
+
+/*
+ * Sleep until the A111 raises its interrupt (GPIOINT callback) or the one-shot
+ * timeout expires. Both wake sources work in EM2, so the power manager is free to
+ * pick the deepest energy mode allowed by the current requirements.
+ */
 static bool acc_hal_integration_wait_for_sensor_interrupt(acc_sensor_id_t sensor_id, uint32_t timeout_ms) {
     (void) sensor_id; // Ignore parameter sensor_id
 
-    const uint32_t wait_begin_ms = sl_sleeptimer_get_tick_count();
-    while ((GPIO_PinInGet(A111_INT_PORT, A111_INT_PIN) != 1)
-            && ((sl_sleeptimer_get_tick_count() - wait_begin_ms) < timeout_ms))
+    const uint32_t wait_begin = sl_sleeptimer_get_tick_count();
+
+    sensor_timed_out = false;
+    sensor_ready = false;
+    sensor_waiting = true;
+
+    // The edge may have come before the flag was cleared
+    if (GPIO_PinInGet(A111_INT_PORT, A111_INT_PIN) != 1)
     {
-        // Wait for the GPIO interrupt
-        disable_interrupts();
-        // Check again so that IRQ did not occur
-        if (GPIO_PinInGet(A111_INT_PORT, A111_INT_PIN) != 1)
+        sl_sleeptimer_start_timer_ms(&sensor_timeout_timer, timeout_ms, sensor_timeout_callback, NULL, 0, 0);
+
+        while (!sensor_ready && !sensor_timed_out)
         {
-            __asm__("wfi"); // wait for interrupt
+            sl_power_manager_sleep();
         }
 
-        // Enable interrupts again to allow pending interrupt to be handled
-        enable_interrupts();
+        sl_sleeptimer_stop_timer(&sensor_timeout_timer);
     }
+    sensor_waiting = false;
+
+    bool ready = GPIO_PinInGet(A111_INT_PORT, A111_INT_PIN) == 1;
+    if (ready) wake_complete();
+    else hal_stats.wait_timeouts++;
+
+    spi_frame.wait_ticks += sl_sleeptimer_get_tick_count() - wait_begin;
+    return ready;
+}
 
-    return GPIO_PinInGet(A111_INT_PORT, A111_INT_PIN) == 1;
+bool acc_hal_integration_ok_to_sleep(void) {
+    return !(sensor_waiting && (sensor_ready || sensor_timed_out));
 }
 
 static float acc_hal_integration_get_reference_frequency(void) {
@@ -176,13 +354,68 @@ static const acc_hal_t hal = { .properties.sensor_count = SENSOR_COUNT,
 	.sensor_device.get_reference_frequency =
 			acc_hal_integration_get_reference_frequency,
 
-	.os.mem_alloc = malloc, .os.mem_free = free, .os.gettime =
+	.os.mem_alloc = appArenaRssAlloc, .os.mem_free = appArenaRssFree, .os.gettime =
 			acc_integration_get_time,
 
 	.log.log_level = ACC_LOG_LEVEL_INFO, .log.log = acc_integration_log,
 
+#if A111_SPI_USE_TRANSFER16
+	.optimization.transfer16 = acc_hal_integration_sensor_transfer16, };
+#else
 	.optimization.transfer16 = NULL, };
+#endif
 
 const acc_hal_t* acc_hal_integration_get_implementation(void) {
+    // Cycle counter for the SPI instrumentation
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    // Sensor interrupt, the edge itself is configured in initGPIO()
+    GPIOINT_CallbackRegister(A111_INT_PIN, sensor_int_callback);
     return &hal;
 }
+
+void acc_hal_integration_get_stats(acc_hal_integration_stats_t *stats) {
+    *stats = hal_stats;
+}
+
+void acc_hal_integration_frame_end(void) {
+    hal_stats.spi_transfers = spi_frame.transfers;
+    hal_stats.spi_bytes = spi_frame.bytes;
+    hal_stats.spi_cpu_cycles = spi_frame.cpu_cycles;
+    hal_stats.spi_us = (uint32_t) (((uint64_t) spi_frame.ticks * 1000000) / sl_sleeptimer_get_timer_frequency());
+    hal_stats.spi_width = A111_SPI_USE_TRANSFER16 ? 16 : 8;
+    hal_stats.wait_us = (uint32_t) (((uint64_t) spi_frame.wait_ticks * 1000000) / sl_sleeptimer_get_timer_frequency());
+    memset(&spi_frame, 0, sizeof(spi_frame));
+}
+
+bool acc_hal_integration_spi_bench(size_t frame_bytes, size_t chunk_bytes, uint32_t iterations,
+        acc_hal_integration_spi_bench_t *result) {
+    uint16_t dummy = 0xFFFF;
+
+    if (frame_bytes == 0 || chunk_bytes == 0 || iterations == 0 || chunk_bytes > A111_SPI_MAX_TRANSFER_SIZE
+            || frame_bytes > SPI_BENCH_MAX_FRAME_BYTES || iterations > SPI_BENCH_MAX_ITERATIONS) {
+        return false;
+    }
+
+    // Run with CS released so the sensor ignores the clocks, on the same path RSS would use
+    const LDMA_CtrlSize_t size = A111_SPI_USE_TRANSFER16 ? ldmaCtrlSizeHalf : ldmaCtrlSizeByte;
+    const size_t unit = A111_SPI_USE_TRANSFER16 ? 2 : 1;
+    eusart_set_databits(A111_SPI_USE_TRANSFER16 ? EUSART_FRAMECFG_DATABITS_SIXTEEN : EUSART_FRAMECFG_DATABITS_EIGHT);
+
+    // Keep the counters of the frame in progress
+    const spi_counters_t saved = spi_frame;
+    memset(&spi_frame, 0, sizeof(spi_frame));
+
+    for (uint32_t i = 0; i < iterations; i++) {
+        for (size_t done = 0; done < frame_bytes; done += chunk_bytes) {
+            size_t bytes = frame_bytes - done < chunk_bytes ? frame_bytes - done : chunk_bytes;
+            spi_ldma_run(&dummy, (bytes + unit - 1) / unit, size, false, false);
+        }
+    }
+
+    result->transfers = spi_frame.transfers / iterations;
+    result->cpu_cycles = spi_frame.cpu_cycles / iterations;
+    result->us = (uint32_t) (((uint64_t) spi_frame.ticks * 1000000) / sl_sleeptimer_get_timer_frequency() / iterations);
+    spi_frame = saved;
+    return true;
+}
@@ -0,0 +1,175 @@
+/*
+ * app_arena.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: edward62740
+ */
+
+#include <string.h>
+#include "app_arena.h"
+
+/* Boundary tag in front of every block. size includes the tag and is a multiple of
+ * APP_ARENA_ALIGN, so bit 0 is free to mark the block as used. A zero-size used tag
+ * terminates the arena. */
+typedef struct
+{
+    uint32_t size;
+    uint32_t prevSize;
+} appArenaTag_t;
+
+#define TAG_SIZE   ((uint32_t) sizeof(appArenaTag_t))
+#define TAG_USED   1u
+#define MIN_BLOCK  (TAG_SIZE + APP_ARENA_ALIGN)
+
+static inline uint32_t blockSize(const appArenaTag_t *t)
+{
+    return t->size & ~TAG_USED;
+}
+
+static inline appArenaTag_t *blockNext(appArenaTag_t *t)
+{
+    return (appArenaTag_t*) ((uint8_t*) t + blockSize(t));
+}
+
+static inline appArenaTag_t *blockPrev(appArenaTag_t *t)
+{
+    return t->prevSize ? (appArenaTag_t*) ((uint8_t*) t - t->prevSize) : NULL;
+}
+
+void appArenaInit(appArena_t *arena, void *buf, size_t size)
+{
+    size &= ~(size_t) (APP_ARENA_ALIGN - 1);
+    arena->base = buf;
+    arena->size = size;
+    memset(&arena->stats, 0, sizeof(arena->stats));
+
+    appArenaTag_t *first = (appArenaTag_t*) arena->base;
+    first->size = (uint32_t) size - TAG_SIZE;
+    first->prevSize = 0;
+
+    appArenaTag_t *end = blockNext(first);
+    end->size = TAG_USED;
+    end->prevSize = first->size;
+
+    arena->stats.capacity = first->size;
+    arena->stats.largestFree = first->size - TAG_SIZE;
+}
+
+void *appArenaAlloc(appArena_t *arena, size_t size)
+{
+    if (size == 0 || size > arena->size)
+    {
+        arena->stats.failed++;
+        return NULL;
+    }
+
+    uint32_t need = (uint32_t) ((size + APP_ARENA_ALIGN - 1) & ~(size_t) (APP_ARENA_ALIGN - 1)) + TAG_SIZE;
+
+    for (appArenaTag_t *t = (appArenaTag_t*) arena->base; t->size != TAG_USED; t = blockNext(t))
+    {
+        if ((t->size & TAG_USED) || t->size < need) continue;
+
+        if (t->size - need >= MIN_BLOCK)
+        {
+            // Split, the remainder stays free
+            appArenaTag_t *rest = (appArenaTag_t*) ((uint8_t*) t + need);
+            rest->size = t->size - need;
+            rest->prevSize = need;
+            blockNext(rest)->prevSize = rest->size;
+            t->size = need;
+        }
+        t->size |= TAG_USED;
+
+        arena->stats.allocs++;
+        arena->stats.inUse += blockSize(t);
+        if (arena->stats.inUse > arena->stats.peak) arena->stats.peak = arena->stats.inUse;
+        return t + 1;
+    }
+
+    arena->stats.failed++;
+    return NULL;
+}
+
+void appArenaFree(appArena_t *arena, void *ptr)
+{
+    if (ptr == NULL) return;
+
+    appArenaTag_t *t = (appArenaTag_t*) ptr - 1;
+    t->size &= ~TAG_USED;
+    arena->stats.frees++;
+    arena->stats.inUse -= t->size;
+
+    appArenaTag_t *next = blockNext(t);
+    if (!(next->size & TAG_USED))
+    {
+        t->size += next->size;
+        blockNext(t)->prevSize = t->size;
+    }
+
+    appArenaTag_t *prev = blockPrev(t);
+    if (prev != NULL && !(prev->size & TAG_USED))
+    {
+        prev->size += t->size;
+        blockNext(prev)->prevSize = prev->size;
+    }
+}
+
+void appArenaGetStats(appArena_t *arena, appArenaStats_t *stats)
+{
+    uint32_t freeBytes = 0, largest = 0;
+
+    for (appArenaTag_t *t = (appArenaTag_t*) arena->base; t->size != TAG_USED; t = blockNext(t))
+    {
+        if (t->size & TAG_USED) continue;
+        freeBytes += t->size - TAG_SIZE;
+        if (t->size - TAG_SIZE > largest) largest = t->size - TAG_SIZE;
+    }
+
+    arena->stats.largestFree = largest;
+    arena->stats.fragPct = freeBytes ? (uint8_t) (100 - (100 * (uint64_t) largest) / freeBytes) : 0;
+    *stats = arena->stats;
+}
+
+bool appArenaCheck(const appArena_t *arena)
+{
+    const uint8_t *end = arena->base + arena->size - TAG_SIZE;
+    uint32_t prevSize = 0, used = 0;
+    bool prevFree = false;
+
+    appArenaTag_t *t;
+
+    for (t = (appArenaTag_t*) arena->base; t->size != TAG_USED; t = blockNext(t))
+    {
+        uint32_t size = blockSize(t);
+        bool isFree = !(t->size & TAG_USED);
+
+        if (size < MIN_BLOCK || size % APP_ARENA_ALIGN) return false;
+        if (t->prevSize != prevSize) return false;
+        if (isFree && prevFree) return false; // missed merge
+        if ((uint8_t*) t + size > end) return false;
+
+        if (!isFree) used += size;
+        prevSize = size;
+        prevFree = isFree;
+    }
+    return (uint8_t*) t == end && t->prevSize == prevSize && used == arena->stats.inUse;
+}
+
+
+static uint64_t appArenaRssBuf[APP_ARENA_RSS_SIZE / sizeof(uint64_t)];
+appArena_t appArenaRss;
+
+void appArenaRssInit(void)
+{
+    appArenaInit(&appArenaRss, appArenaRssBuf, sizeof(appArenaRssBuf));
+}
+
+void *appArenaRssAlloc(size_t size)
+{
+    return appArenaAlloc(&appArenaRss, size);
+}
+
+void appArenaRssFree(void *ptr)
+{
+    appArenaFree(&appArenaRss, ptr);
+}
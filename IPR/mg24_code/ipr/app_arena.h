@@ -0,0 +1,67 @@
+/*
+ * app_arena.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: edward62740
+ */
+
+#ifndef APP_ARENA_H_
+#define APP_ARENA_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Fixed-size arena allocator for long-running allocation users (RSS, app).
+ *
+ * The arena is a caller-provided static buffer split into blocks, each with an
+ * 8 byte boundary tag holding its own size and the size of the block before it.
+ * Allocation is first fit over the blocks with splitting; free merges with both
+ * neighbours in O(1), so there are never two adjacent free blocks. The walk is
+ * bounded by the (small, build-time) arena size and never touches the newlib heap.
+ * Not reentrant: only call from the main loop. */
+
+#define APP_ARENA_ALIGN 8
+
+/* Arena for the RSS (acc_hal_t.os.mem_alloc) */
+#ifndef APP_ARENA_RSS_SIZE
+#define APP_ARENA_RSS_SIZE (24 * 1024)
+#endif
+
+typedef struct
+{
+    uint32_t capacity;    // usable bytes after the first tag
+    uint32_t inUse;       // bytes in allocated blocks, including tags
+    uint32_t peak;        // high-water mark of inUse
+    uint32_t allocs;
+    uint32_t frees;
+    uint32_t failed;      // allocations that returned NULL
+    uint32_t largestFree; // largest allocatable request right now
+    uint8_t fragPct;      // 100 * (1 - largest free block / all free bytes)
+} appArenaStats_t;
+
+typedef struct
+{
+    uint8_t *base;
+    size_t size;
+    appArenaStats_t stats;
+} appArena_t;
+
+/* buf must be APP_ARENA_ALIGN aligned, size is rounded down to APP_ARENA_ALIGN */
+void appArenaInit(appArena_t *arena, void *buf, size_t size);
+void *appArenaAlloc(appArena_t *arena, size_t size);
+void appArenaFree(appArena_t *arena, void *ptr);
+
+/* Refreshes largestFree/fragPct (walks the arena) and copies the counters */
+void appArenaGetStats(appArena_t *arena, appArenaStats_t *stats);
+
+/* Walks the arena and checks all boundary tags, for the host stress test */
+bool appArenaCheck(const appArena_t *arena);
+
+/* The RSS arena and its malloc/free compatible wrappers for acc_hal_t */
+extern appArena_t appArenaRss;
+void appArenaRssInit(void);
+void *appArenaRssAlloc(size_t size);
+void appArenaRssFree(void *ptr);
+
+#endif /* APP_ARENA_H_ */
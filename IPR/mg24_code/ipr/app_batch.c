@@ -0,0 +1,133 @@
+/*
+ * app_batch.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: edward62740
+ */
+
+#include <string.h>
+#include "app_batch.h"
+#include "trace_rec.h"
+
+void appBatchInit(appBatch_t *batch)
+{
+    memset(batch, 0, sizeof(*batch));
+}
+
+static size_t appBatchPutDelta(uint8_t *p, int32_t *prev, int32_t v)
+{
+    size_t n = traceRecPutVarint(p, traceRecZigzag(v - *prev));
+    *prev = v;
+    return n;
+}
+
+bool appBatchAdd(appBatch_t *batch, const appBatchSample_t *sample, uint32_t nowS)
+{
+    uint8_t tmp[APP_BATCH_MAX_SAMPLE_BYTES];
+    appBatch_t next = *batch;
+    size_t n = 0;
+
+    // The delta base restarts with every batch
+    if (next.count == 0) next.score = next.lux = next.vddMv = next.rssi = 0;
+    n += appBatchPutDelta(&tmp[n], &next.score, (int32_t) ((sample->score + 5) / (1000 / APP_BATCH_SCORE_SCALE)));
+    n += appBatchPutDelta(&tmp[n], &next.lux, (int32_t) (sample->lux / APP_BATCH_LUX_DIV));
+    n += appBatchPutDelta(&tmp[n], &next.vddMv, (int32_t) sample->vddMv);
+    n += appBatchPutDelta(&tmp[n], &next.rssi, sample->rssi);
+
+    // No room: keep the batch as it is and have it sent
+    if (batch->used + n > APP_BATCH_MAX_BYTES) return true;
+
+    memcpy(&next.buf[next.used], tmp, n);
+    next.used += n;
+    next.count++;
+    next.lastS = nowS;
+    *batch = next;
+    return batch->count >= APP_BATCH_SAMPLES || batch->used + APP_BATCH_MAX_SAMPLE_BYTES > APP_BATCH_MAX_BYTES;
+}
+
+static uint8_t *appBatchPut(uint8_t *p, uint64_t v, size_t n)
+{
+    for (size_t i = 0; i < n; i++) *p++ = (uint8_t) (v >> (8 * i));
+    return p;
+}
+
+static uint64_t appBatchGet(const uint8_t **p, size_t n)
+{
+    uint64_t v = 0;
+    for (size_t i = 0; i < n; i++) v |= (uint64_t) (*p)[i] << (8 * i);
+    *p += n;
+    return v;
+}
+
+size_t appBatchEncode(const appBatch_t *batch, appBatchHeader_t *hdr, uint32_t nowS, uint8_t *out, size_t len)
+{
+    if (len < APP_BATCH_HEADER_SIZE + batch->used) return 0;
+
+    uint32_t age = batch->count ? nowS - batch->lastS : 0;
+    hdr->count = batch->count;
+    hdr->ageS = age > UINT16_MAX ? UINT16_MAX : (uint16_t) age;
+
+    uint8_t *w = out;
+    w = appBatchPut(w, APP_BATCH_VERSION, 1);
+    w = appBatchPut(w, hdr->deviceType, 1);
+    w = appBatchPut(w, hdr->eui64, 8);
+    w = appBatchPut(w, hdr->txCtr, 4);
+    w = appBatchPut(w, hdr->intervalS, 2);
+    w = appBatchPut(w, hdr->ageS, 2);
+    w = appBatchPut(w, hdr->count, 1);
+    w = appBatchPut(w, hdr->eolDays, 2);
+    w = appBatchPut(w, hdr->soc, 1);
+    w = appBatchPut(w, hdr->battLevel, 1);
+    w = appBatchPut(w, hdr->arenaPeak, 2);
+    w = appBatchPut(w, hdr->arenaFailed, 2);
+    w = appBatchPut(w, hdr->arenaFragPct, 1);
+    memcpy(w, batch->buf, batch->used);
+    return (size_t) (w - out) + batch->used;
+}
+
+static bool appBatchGetDelta(const uint8_t **p, const uint8_t *end, int32_t *v)
+{
+    uint32_t raw;
+    size_t n = traceRecGetVarint(*p, (size_t) (end - *p), &raw);
+    if (n == 0) return false;
+    *p += n;
+    *v += traceRecUnzigzag(raw);
+    return true;
+}
+
+bool appBatchDecode(const uint8_t *buf, size_t len, appBatchHeader_t *hdr, appBatchSample_t *samples, size_t max)
+{
+    const uint8_t *r = buf;
+    const uint8_t *end = buf + len;
+    if (len < APP_BATCH_HEADER_SIZE || buf[0] != APP_BATCH_VERSION) return false;
+
+    r++;
+    hdr->deviceType = (uint8_t) appBatchGet(&r, 1);
+    hdr->eui64 = appBatchGet(&r, 8);
+    hdr->txCtr = (uint32_t) appBatchGet(&r, 4);
+    hdr->intervalS = (uint16_t) appBatchGet(&r, 2);
+    hdr->ageS = (uint16_t) appBatchGet(&r, 2);
+    hdr->count = (uint8_t) appBatchGet(&r, 1);
+    hdr->eolDays = (uint16_t) appBatchGet(&r, 2);
+    hdr->soc = (uint8_t) appBatchGet(&r, 1);
+    hdr->battLevel = (uint8_t) appBatchGet(&r, 1);
+    hdr->arenaPeak = (uint16_t) appBatchGet(&r, 2);
+    hdr->arenaFailed = (uint16_t) appBatchGet(&r, 2);
+    hdr->arenaFragPct = (uint8_t) appBatchGet(&r, 1);
+    if (hdr->count > max) return false;
+
+    int32_t score = 0, lux = 0, vddMv = 0, rssi = 0;
+    for (uint8_t i = 0; i < hdr->count; i++)
+    {
+        if (!appBatchGetDelta(&r, end, &score) || !appBatchGetDelta(&r, end, &lux)
+                || !appBatchGetDelta(&r, end, &vddMv) || !appBatchGetDelta(&r, end, &rssi))
+        {
+            return false;
+        }
+        samples[i].score = (uint32_t) score * (1000 / APP_BATCH_SCORE_SCALE);
+        samples[i].lux = (uint32_t) lux * APP_BATCH_LUX_DIV;
+        samples[i].vddMv = (uint32_t) vddMv;
+        samples[i].rssi = (int8_t) rssi;
+    }
+    return r == end;
+}
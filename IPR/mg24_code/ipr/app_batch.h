@@ -0,0 +1,111 @@
+/*
+ * app_batch.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: edward62740
+ */
+
+#ifndef APP_BATCH_H_
+#define APP_BATCH_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Batched alive telemetry. Hardware free, shared with the host decoder
+ * (../host/payload_decode.c).
+ *
+ * Instead of one alive PUT per interval, a sample is delta-encoded into a RAM
+ * buffer every interval. The buffer is sent as one message once it holds
+ * APP_BATCH_SAMPLES samples or has no room for another, and right after every
+ * state report, while the radio is awake anyway. Sent with Content-Format
+ * APP_BATCH_CONTENT_FORMAT when the server accepts it, see
+ * appCoapPermissionsHandler().
+ *
+ * Layout, version 1 (little endian):
+ *     u8  version      APP_BATCH_VERSION
+ *     u8  deviceType
+ *     u64 eui64
+ *     u32 txCtr        total CoAP transmissions
+ *     u16 intervalS    sample spacing
+ *     u16 ageS         time from the newest sample to the send
+ *     u8  count        samples that follow
+ *     u16 eolDays      \
+ *     u8  soc           |
+ *     u8  battLevel     | latest values only, they change slowly
+ *     u16 arenaPeak     |
+ *     u16 arenaFailed   |
+ *     u8  arenaFragPct /
+ * then per sample, oldest first, each field as a zigzag varint delta to the
+ * previous sample (the first to zero), trace_rec.h varints:
+ *     score        presence score in 1 / APP_BATCH_SCORE_SCALE units
+ *     lux          opt3001_lux() / APP_BATCH_LUX_DIV
+ *     vddMv
+ *     rssi
+ * A quiet minute costs 4 bytes. */
+
+#define APP_BATCH_VERSION          1
+#define APP_BATCH_CONTENT_FORMAT   65001 // experimental use range, next to APP_PAYLOAD_CONTENT_FORMAT
+#define APP_BATCH_HEADER_SIZE      28
+#ifndef APP_BATCH_SAMPLES
+#define APP_BATCH_SAMPLES          10    // flush every 10 alive intervals
+#endif
+#define APP_BATCH_MAX_BYTES        72    // sample bytes, keeps a batch within two 6LoWPAN fragments
+#define APP_BATCH_MAX_SAMPLE_BYTES 17    // 5 + 5 + 5 + 2 byte varints
+#define APP_BATCH_SCORE_SCALE      100
+#define APP_BATCH_LUX_DIV          1000  // opt3001_lux() is in mlux
+
+typedef struct
+{
+    uint32_t score;  // presence score * 1000, as appPayload_t
+    uint32_t lux;    // opt3001_lux()
+    uint32_t vddMv;
+    int8_t rssi;
+} appBatchSample_t;
+
+typedef struct
+{
+    uint8_t deviceType;
+    uint64_t eui64;
+    uint32_t txCtr;
+    uint16_t intervalS;
+    uint16_t ageS;
+    uint8_t count;
+    uint16_t eolDays;
+    uint8_t soc;
+    uint8_t battLevel;
+    uint16_t arenaPeak;
+    uint16_t arenaFailed;
+    uint8_t arenaFragPct;
+} appBatchHeader_t;
+
+typedef struct
+{
+    uint8_t buf[APP_BATCH_MAX_BYTES];
+    size_t used;
+    uint8_t count;
+    uint32_t lastS;  // time of the newest sample
+
+    /* Delta base, quantised */
+    int32_t score;
+    int32_t lux;
+    int32_t vddMv;
+    int32_t rssi;
+} appBatch_t;
+
+void appBatchInit(appBatch_t *batch);
+
+/* Appends a sample taken at nowS. Returns true if the batch should be sent now.
+ * There is always room for the next sample as long as the caller sends and
+ * re-initialises the batch when told; otherwise the sample is dropped. */
+bool appBatchAdd(appBatch_t *batch, const appBatchSample_t *sample, uint32_t nowS);
+
+/* Header plus samples into out, returns the length or 0 if len is too small.
+ * hdr->count and hdr->ageS are filled in from the batch. Does not reset it */
+size_t appBatchEncode(const appBatch_t *batch, appBatchHeader_t *hdr, uint32_t nowS, uint8_t *out, size_t len);
+
+/* Decodes a batch message into hdr and up to max samples (quantised values
+ * scaled back). Returns false on an unknown version or a malformed message */
+bool appBatchDecode(const uint8_t *buf, size_t len, appBatchHeader_t *hdr, appBatchSample_t *samples, size_t max);
+
+#endif /* APP_BATCH_H_ */
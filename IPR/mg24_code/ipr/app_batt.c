@@ -0,0 +1,182 @@
+/*
+ * app_batt.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: edward62740
+ */
+
+#include <string.h>
+#include "app_batt.h"
+
+/* Two LR03 in series, open-circuit voltage at low drain over depth of discharge */
+static const struct
+{
+    uint16_t mv;
+    uint8_t soc;
+} appBattCurve[] = {
+    { 3160, 100 }, { 2840, 90 }, { 2720, 80 }, { 2640, 70 }, { 2560, 60 }, { 2500, 50 },
+    { 2420, 40 }, { 2340, 30 }, { 2240, 20 }, { 2120, 10 }, { APP_BATT_CUTOFF_MV, 0 },
+};
+
+#define APP_BATT_CURVE_LEN (sizeof(appBattCurve) / sizeof(appBattCurve[0]))
+
+void appBattInit(appBatt_t *batt, bool packSense)
+{
+    memset(batt, 0, sizeof(*batt));
+    batt->level = APP_BATT_NORMAL;
+    batt->packSense = packSense;
+}
+
+static uint32_t appBattFilter(uint32_t avg, uint32_t mv)
+{
+    if (avg == 0) return mv;
+    return avg - (avg >> APP_BATT_FILTER_SHIFT) + (mv >> APP_BATT_FILTER_SHIFT);
+}
+
+void appBattSample(appBatt_t *batt, uint32_t mv, bool underLoad)
+{
+    if (underLoad)
+    {
+        batt->loadMv = appBattFilter(batt->loadMv, mv);
+        batt->loadSamples++;
+    }
+    else
+    {
+        batt->idleMv = appBattFilter(batt->idleMv, mv);
+        batt->idleSamples++;
+    }
+}
+
+uint8_t appBattSocFromMv(uint32_t packMv)
+{
+    if (packMv >= appBattCurve[0].mv) return appBattCurve[0].soc;
+    for (unsigned i = 1; i < APP_BATT_CURVE_LEN; i++)
+    {
+        if (packMv >= appBattCurve[i].mv)
+        {
+            uint32_t dv = appBattCurve[i - 1].mv - appBattCurve[i].mv;
+            uint32_t ds = appBattCurve[i - 1].soc - appBattCurve[i].soc;
+            return (uint8_t) (appBattCurve[i].soc + (packMv - appBattCurve[i].mv) * ds / dv);
+        }
+    }
+    return 0;
+}
+
+static appBattLevel_t appBattLevelFor(appBattLevel_t level, uint8_t soc)
+{
+    switch (level)
+    {
+        case APP_BATT_NORMAL:
+            if (soc <= APP_BATT_CRITICAL_PCT) return APP_BATT_CRITICAL;
+            if (soc <= APP_BATT_LOW_PCT) return APP_BATT_LOW;
+            return APP_BATT_NORMAL;
+        case APP_BATT_LOW:
+            if (soc <= APP_BATT_CRITICAL_PCT) return APP_BATT_CRITICAL;
+            if (soc >= APP_BATT_LOW_PCT + APP_BATT_HYST_PCT) return APP_BATT_NORMAL;
+            return APP_BATT_LOW;
+        default:
+            if (soc >= APP_BATT_LOW_PCT + APP_BATT_HYST_PCT) return APP_BATT_NORMAL;
+            if (soc >= APP_BATT_CRITICAL_PCT + APP_BATT_HYST_PCT) return APP_BATT_LOW;
+            return APP_BATT_CRITICAL;
+    }
+}
+
+/* Average current at a throttle level, in % of the full-rate current */
+static uint32_t appBattRelCurrent(appBattLevel_t level)
+{
+    return (100 - APP_BATT_SCALED_PCT) + APP_BATT_SCALED_PCT / (1u << level);
+}
+
+/* Without the pack voltage: the charge used at the nominal current, no throttle */
+static void appBattUpdateCharge(appBatt_t *batt, uint32_t nowS)
+{
+    const uint64_t capacityUas = (uint64_t) APP_BATT_CAPACITY_MAH * 1000 * 3600;
+
+    if (batt->valid) batt->usedUas += (uint64_t) (nowS - batt->lastS) * APP_BATT_NOMINAL_UA;
+    batt->lastS = nowS;
+    batt->valid = true;
+
+    uint64_t left = batt->usedUas < capacityUas ? capacityUas - batt->usedUas : 0;
+    batt->soc = (uint8_t) ((left * 100 + capacityUas - 1) / capacityUas);
+    batt->eolDays = (uint32_t) (left / APP_BATT_NOMINAL_UA / 86400);
+    batt->trend = false;
+}
+
+uint32_t appBattUsedUah(const appBatt_t *batt)
+{
+    return (uint32_t) (batt->usedUas / 3600);
+}
+
+void appBattSetUsed(appBatt_t *batt, uint32_t usedUah)
+{
+    batt->usedUas = (uint64_t) usedUah * 3600;
+}
+
+bool appBattUpdate(appBatt_t *batt, uint32_t nowS)
+{
+    if (!batt->packSense)
+    {
+        appBattUpdateCharge(batt, nowS);
+        return false;
+    }
+
+    uint32_t mv;
+    if (batt->idleMv) mv = batt->idleMv;
+    else if (batt->loadMv) mv = batt->loadMv + APP_BATT_DEFAULT_SAG_MV;
+    else return false;
+
+    uint8_t soc = appBattSocFromMv(mv);
+    if (!batt->valid || soc >= batt->soc + APP_BATT_REPLACED_PCT)
+    {
+        // First estimate or fresh cells: restart the trend
+        batt->soc = soc;
+        batt->anchorS = nowS;
+        batt->anchorSoc = soc;
+        batt->valid = true;
+    }
+    else if (soc < batt->soc)
+    {
+        batt->soc = soc; // recovery after rest or warming is not charge
+    }
+
+    appBattLevel_t level = appBattLevelFor(batt->level, batt->soc);
+    bool changed = level != batt->level;
+    batt->level = level;
+    if (changed)
+    {
+        // The measured rate only holds for the current throttle level
+        batt->anchorS = nowS;
+        batt->anchorSoc = batt->soc;
+    }
+
+    // Seconds per % SoC at full rate
+    uint8_t drop = batt->anchorSoc - batt->soc;
+    uint32_t elapsed = nowS - batt->anchorS;
+    uint64_t secPerPct;
+    batt->trend = drop >= APP_BATT_TREND_MIN_DROP && elapsed > 0;
+    if (batt->trend)
+    {
+        secPerPct = (uint64_t) elapsed * appBattRelCurrent(level) / 100 / drop;
+    }
+    else
+    {
+        // mAh * 1000 / uA = hours
+        secPerPct = (uint64_t) APP_BATT_CAPACITY_MAH * 1000 * 3600 / 100 / APP_BATT_NOMINAL_UA;
+    }
+
+    // Remaining SoC per level it will be spent at
+    uint32_t spanNormal = batt->soc > APP_BATT_LOW_PCT ? batt->soc - APP_BATT_LOW_PCT : 0;
+    uint32_t spanCritical = batt->soc < APP_BATT_CRITICAL_PCT ? batt->soc : APP_BATT_CRITICAL_PCT;
+    uint32_t spanLow = batt->soc - spanNormal - spanCritical;
+    uint64_t seconds = secPerPct * 100 * spanNormal / appBattRelCurrent(APP_BATT_NORMAL)
+            + secPerPct * 100 * spanLow / appBattRelCurrent(APP_BATT_LOW)
+            + secPerPct * 100 * spanCritical / appBattRelCurrent(APP_BATT_CRITICAL);
+    batt->eolDays = (uint32_t) (seconds / 86400);
+
+    return changed;
+}
+
+uint8_t appBattScale(const appBatt_t *batt)
+{
+    return (uint8_t) (1u << batt->level);
+}
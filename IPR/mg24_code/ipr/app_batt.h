@@ -0,0 +1,105 @@
+/*
+ * app_batt.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: edward62740
+ */
+
+#ifndef APP_BATT_H_
+#define APP_BATT_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* State-of-charge and end-of-life estimate for the 2 x LR03 (AAA alkaline) pack.
+ * Hardware free, shared with the host (../host/batt_sim.c).
+ *
+ * AVDD is sampled in two ways. Load samples are PRS-triggered on radio activity
+ * and sag with the cell's internal resistance. Idle samples are software
+ * triggered between radio events and are close to the open-circuit voltage.
+ * Each kind has its own EMA. State of charge comes from the idle voltage through
+ * an LR03 discharge table, or from the load voltage plus the last known sag
+ * until an idle sample arrives. It only goes down, except on a jump big enough
+ * to be a battery change.
+ *
+ * The remaining life starts from the nominal average current. Once the
+ * observed SoC drop is large enough, the measured discharge rate is used.
+ * The throttle level scales the frame spacing, alive interval and poll period.
+ * The prediction accounts for the slower discharge at the lower levels the pack
+ * has yet to pass through. The trend restarts at every level change.
+ *
+ * All of this needs the pack voltage. Without it (packSense false) SoC counts
+ * down the charge used at APP_BATT_NOMINAL_UA instead, the caller keeps that
+ * count across resets, and the throttle stays off: a modelled count is no
+ * ground for cutting the frame rate. */
+
+#define APP_BATT_CAPACITY_MAH      1100  // LR03 at < 1 mA drain
+#define APP_BATT_NOMINAL_UA        150   // average current at full rate, see README
+#define APP_BATT_CUTOFF_MV         2000  // 0 % SoC, 1.0 V per cell
+#define APP_BATT_DEFAULT_SAG_MV    60    // load sag assumed until both sample kinds exist
+#define APP_BATT_FILTER_SHIFT      3     // EMA weight 1/8
+#define APP_BATT_REPLACED_PCT      20    // SoC jump treated as fresh cells
+#define APP_BATT_TREND_MIN_DROP    3     // % SoC observed before the measured rate is used
+#define APP_BATT_SCALED_PCT        75    // share of the average current that scales with the throttle
+
+#define APP_BATT_LOW_PCT           30    // throttle x2 at or below
+#define APP_BATT_CRITICAL_PCT      10    // throttle x4 at or below
+#define APP_BATT_HYST_PCT          3     // leave a level only this far above it
+
+/* 1 if the IADC samples the pack, e.g. a divided cell voltage. The IPR v2 board
+ * runs everything, AVDD included, from the regulated 1.8 V rail and has no such
+ * input, so AVDD says nothing about the cells */
+#ifndef APP_BATT_PACK_SENSE
+#define APP_BATT_PACK_SENSE        0
+#endif
+
+typedef enum
+{
+    APP_BATT_NORMAL = 0,
+    APP_BATT_LOW,
+    APP_BATT_CRITICAL,
+} appBattLevel_t;
+
+typedef struct
+{
+    uint32_t idleMv;       // filtered, 0 until the first sample
+    uint32_t loadMv;       // filtered, 0 until the first sample
+    uint32_t idleSamples;
+    uint32_t loadSamples;
+    uint8_t soc;           // %, 0 at APP_BATT_CUTOFF_MV
+    appBattLevel_t level;
+    uint32_t eolDays;      // predicted days until cutoff
+    bool trend;            // eolDays is from the measured rate, not APP_BATT_NOMINAL_UA
+
+    /* Trend anchor, reset on battery change */
+    uint32_t anchorS;
+    uint8_t anchorSoc;
+    bool valid;            // soc holds an estimate
+
+    /* Without pack sense */
+    bool packSense;
+    uint64_t usedUas;      // charge used since the cells were fitted
+    uint32_t lastS;
+} appBatt_t;
+
+/* packSense: the samples are the pack voltage, else SoC is from the charge used */
+void appBattInit(appBatt_t *batt, bool packSense);
+
+/* Feeds one AVDD sample in mV. Cheap enough for the IADC interrupt */
+void appBattSample(appBatt_t *batt, uint32_t mv, bool underLoad);
+
+/* Recomputes soc, level and eolDays at nowS (seconds since boot).
+ * Returns true if the throttle level changed, never without pack sense. */
+bool appBattUpdate(appBatt_t *batt, uint32_t nowS);
+
+/* Charge used, for the caller to keep across resets; 0 for fresh cells */
+uint32_t appBattUsedUah(const appBatt_t *batt);
+void appBattSetUsed(appBatt_t *batt, uint32_t usedUah);
+
+/* Multiplier for the frame spacing, alive interval and poll period: 1, 2 or 4 */
+uint8_t appBattScale(const appBatt_t *batt);
+
+/* LR03 pack open-circuit voltage to SoC in % */
+uint8_t appBattSocFromMv(uint32_t packMv);
+
+#endif /* APP_BATT_H_ */
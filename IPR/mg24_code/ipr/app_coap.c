@@ -19,11 +19,25 @@
 #include "sl_component_catalog.h"
 
 #include <openthread/coap.h>
+#include <openthread/dns_client.h>
+#include <openthread/link.h>
 #include "utils/code_utils.h"
 
 #include "stdio.h"
 #include "string.h"
 #include "app_coap.h"
+#include "trace_rec.h"
+#include "acc_hal_integration.h"
+#include "radar_calib.h"
+#include "radar_app.h"
+#include "app_i2c.h"
+#include "app_payload.h"
+#include "app_batch.h"
+#include "app_txq.h"
+#include "app_recover.h"
+#include "app_nvm.h"
+#include "app_disc.h"
+#include "sl_sleeptimer.h"
 
 
 char resource_name[32];
@@ -34,13 +48,77 @@ char *nack = "nack";
 #define PERMISSIONS_URI "permissions"
 otCoapResource mResource_PERMISSIONS;
 otIp6Address brAddr;
+uint16_t brPort = OT_DEFAULT_COAP_PORT; // the SRV port for a server found by DNS-SD
 otIp6Address selfAddr;
 
 const char mPERMISSIONSUriPath[] = PERMISSIONS_URI;
 
+#define POLICY_URI "policy"
+otCoapResource mResource_POLICY;
+const char mPOLICYUriPath[] = POLICY_URI;
+
+#define DIAG_URI "diag"
+otCoapResource mResource_DIAG;
+const char mDIAGUriPath[] = DIAG_URI;
+
+#define TRACE_URI "trace"
+otCoapResource mResource_TRACE;
+const char mTRACEUriPath[] = TRACE_URI;
+
+#define LINK_URI "link"
+otCoapResource mResource_LINK;
+const char mLINKUriPath[] = LINK_URI;
+
+#define SPIBENCH_URI "spibench"
+otCoapResource mResource_SPIBENCH;
+const char mSPIBENCHUriPath[] = SPIBENCH_URI;
+
 bool appCoapConnectionEstablished = false;
+bool appCoapBinaryPayload = false;
+bool appCoapBatchAlive = false;
 uint32_t appCoapFailCtr = 0;
 
+/* Confirmable reports, static so that they outlive appCoapInit() and a reattach */
+static appTxq_t appCoapTxq;
+static sl_sleeptimer_timer_handle_t appCoapQueueTimer;
+
+/* Server binding learned from the permissions GET, kept in NVM across resets */
+#define APP_COAP_BINDING_FORMAT          2
+#define APP_COAP_BINDING_MAX_UNCONFIRMED 3   // boots reusing it without an answer to the ping
+
+typedef struct
+{
+    uint16_t format;
+    uint8_t binary;          // appCoapBinaryPayload
+    uint8_t batch;           // appCoapBatchAlive
+    uint32_t epoch;          // bindings learned so far, a new one supersedes any older copy
+    uint8_t unconfirmed;     // boots since the server last answered
+    otExtendedPanId extPanId; // network the binding belongs to
+    otIp6Address brAddr;
+    uint16_t brPort;
+    char resource[sizeof(resource_name)];
+} appCoapBindingRecord_t;
+
+appCoapBinding_t appCoapBinding = APP_COAP_BINDING_NONE;
+static appCoapBindingRecord_t appCoapBindingRec;
+static uint32_t appCoapBindingRestoredMs;
+static uint32_t appCoapBindingConfirmMs; // restore to the server answering the ping
+
+/* Servers found by DNS-SD (app_disc.h), registered with by a PUT to REGISTER_URI */
+#ifndef APP_COAP_DISC_SERVICE
+#define APP_COAP_DISC_SERVICE "_ipr-coap._udp.default.service.arpa."
+#endif
+#define REGISTER_URI "register"
+static appDisc_t appCoapDisc;
+static bool appCoapDiscBusy;           // browse, resolve or registration in flight
+static uint32_t appCoapDiscFailed;     // reports given up on by the registered server
+static bool appCoapDiscAttempt;        // the report in flight went to it, attached throughout
+
+/* Staged recovery of a lost parent, see app_recover.h */
+static appRecover_t appCoapRecover;
+static uint32_t appCoapRecoverRxUnicast; // MAC counter at the last step, MLE responses are unicast
+static sl_sleeptimer_timer_handle_t appCoapRecoverTimer;
+
 void appCoapInit()
 {
     GPIO_PinOutSet(IP_LED_PORT, IP_LED_PIN);
@@ -54,16 +132,63 @@ void appCoapInit()
     strncpy((char *)mPERMISSIONSUriPath, PERMISSIONS_URI, sizeof(PERMISSIONS_URI));
     otCoapAddResource(otGetInstance(),&mResource_PERMISSIONS);
 
+    mResource_POLICY.mUriPath = mPOLICYUriPath;
+    mResource_POLICY.mContext = otGetInstance();
+    mResource_POLICY.mHandler = &appCoapPolicyHandler;
+    otCoapAddResource(otGetInstance(),&mResource_POLICY);
+
+    mResource_DIAG.mUriPath = mDIAGUriPath;
+    mResource_DIAG.mContext = otGetInstance();
+    mResource_DIAG.mHandler = &appCoapDiagHandler;
+    otCoapAddResource(otGetInstance(),&mResource_DIAG);
+
+    mResource_TRACE.mUriPath = mTRACEUriPath;
+    mResource_TRACE.mContext = otGetInstance();
+    mResource_TRACE.mHandler = &appCoapTraceHandler;
+    otCoapAddResource(otGetInstance(),&mResource_TRACE);
+
+    mResource_LINK.mUriPath = mLINKUriPath;
+    mResource_LINK.mContext = otGetInstance();
+    mResource_LINK.mHandler = &appCoapLinkHandler;
+    otCoapAddResource(otGetInstance(),&mResource_LINK);
+
+    mResource_SPIBENCH.mUriPath = mSPIBENCHUriPath;
+    mResource_SPIBENCH.mContext = otGetInstance();
+    mResource_SPIBENCH.mHandler = &appCoapSpiBenchHandler;
+    otCoapAddResource(otGetInstance(),&mResource_SPIBENCH);
+
 
     GPIO_PinOutClear(IP_LED_PORT, IP_LED_PIN);
 }
 
 
+/* Report encoding: binary and batched alive telemetry if the server accepts them, text otherwise */
+static void appCoapParseAccept(const otMessage *aMessage)
+{
+    otCoapOptionIterator iterator;
+    appCoapBinaryPayload = false;
+    appCoapBatchAlive = false;
+    if (otCoapOptionIteratorInit(&iterator, aMessage) == OT_ERROR_NONE)
+    {
+        for (const otCoapOption *option = otCoapOptionIteratorGetFirstMatchingOption(&iterator, OT_COAP_OPTION_ACCEPT);
+                option != NULL; option = otCoapOptionIteratorGetNextMatchingOption(&iterator, OT_COAP_OPTION_ACCEPT))
+        {
+            uint64_t accept;
+            if (otCoapOptionIteratorGetOptionUintValue(&iterator, &accept) != OT_ERROR_NONE) continue;
+            if (accept == APP_PAYLOAD_CONTENT_FORMAT) appCoapBinaryPayload = true;
+            if (accept == APP_BATCH_CONTENT_FORMAT) appCoapBatchAlive = true;
+        }
+    }
+}
+
 void appCoapPermissionsHandler(void *aContext, otMessage *aMessage, const otMessageInfo *aMessageInfo)
 {
     GPIO_PinOutSet(IP_LED_PORT, IP_LED_PIN);
+    sleepyPollServer(); // more requests tend to follow, see app_poll.h
     //printIPv6Addr(&aMessageInfo->mPeerAddr);
     brAddr = aMessageInfo->mPeerAddr;
+    brPort = OT_DEFAULT_COAP_PORT;
+    memset(resource_name, 0, sizeof(resource_name));
     selfAddr = aMessageInfo->mSockAddr;
     otError error = OT_ERROR_NONE;
     otMessage *responseMessage;
@@ -81,10 +206,13 @@ void appCoapPermissionsHandler(void *aContext, otMessage *aMessage, const otMess
 
     uint16_t offset = otMessageGetOffset(aMessage);
     otMessageRead(aMessage, offset, resource_name, sizeof(resource_name)-1);
+
+    appCoapParseAccept(aMessage);
     //otCliOutputFormat("Unique resource ID: %s\n", resource_name);
 
     if (OT_COAP_CODE_GET == messageCode)
     {
+        appCoapBindingStore();
 
         error = otMessageAppend(responseMessage, ack, strlen((const char*) ack));
         otEXPECT(OT_ERROR_NONE == error);
@@ -112,26 +240,391 @@ void appCoapPermissionsHandler(void *aContext, otMessage *aMessage, const otMess
 }
 
 
+/* GET returns the active frame-rate policy, PUT selects one by name (see radar_policy.c) */
+void appCoapPolicyHandler(void *aContext, otMessage *aMessage, const otMessageInfo *aMessageInfo)
+{
+    otError error = OT_ERROR_NONE;
+    otMessage *responseMessage;
+    otCoapCode responseCode = OT_COAP_CODE_CONTENT;
+    otCoapCode messageCode = otCoapMessageGetCode(aMessage);
+    char name[16];
+
+    sleepyPollServer();
+    responseMessage = otCoapNewMessage((otInstance*) aContext, NULL);
+    otEXPECT_ACTION(responseMessage != NULL, error = OT_ERROR_NO_BUFS);
+
+    if (OT_COAP_CODE_PUT == messageCode)
+    {
+        memset(name, 0, sizeof(name));
+        otMessageRead(aMessage, otMessageGetOffset(aMessage), name, sizeof(name) - 1);
+        responseCode = radarAppSetPolicy(name) ? OT_COAP_CODE_CHANGED : OT_COAP_CODE_BAD_REQUEST;
+    }
+    else if (OT_COAP_CODE_GET != messageCode)
+    {
+        responseCode = OT_COAP_CODE_METHOD_NOT_ALLOWED;
+    }
+
+    otCoapMessageInitResponse(responseMessage, aMessage,
+                              OT_COAP_TYPE_ACKNOWLEDGMENT, responseCode);
+    error = otCoapMessageSetPayloadMarker(responseMessage);
+    otEXPECT(OT_ERROR_NONE == error);
+    error = otMessageAppend(responseMessage, radarAppGetPolicy(), strlen(radarAppGetPolicy()));
+    otEXPECT(OT_ERROR_NONE == error);
+    error = otCoapSendResponse((otInstance*) aContext, responseMessage, aMessageInfo);
+
+    exit:
+    if (error != OT_ERROR_NONE && responseMessage != NULL)
+    {
+        otMessageFree(responseMessage);
+    }
+}
+
+
+/** Diagnostics Payload String **
+ * wake_to_data_us_last (uint32_t): sensor power-on to data ready, last frame
+ * wake_to_data_us_max (uint32_t): maximum of the above
+ * wakes (uint32_t): sensor power-ons
+ * calib (uint8_t): radar calibration at boot, 0 none, 1 fresh, 2 restored from NVM
+ * spi_width (uint8_t): 16 if transfer16 is used, else 8
+ * spi_transfers (uint32_t): SPI transfers in the last frame
+ * spi_bytes (uint32_t): bytes moved in the last frame
+ * spi_cpu_cycles (uint32_t): core cycles (excluding EM1 waits) spent on SPI in the last frame
+ * spi_us (uint32_t): SPI wall time in the last frame
+ * wait_us (uint32_t): time asleep waiting for the sensor interrupt in the last frame
+ * wait_timeouts (uint32_t): sensor interrupt waits that timed out
+ * async (uint8_t): 1 if the next sweep overlaps processing and TX
+ * get_next_us (uint32_t): blocking time of the last get_next
+ * post_us (uint32_t): processing and TX time after the last get_next
+ * msg_i2c_us (uint32_t): OPT3001 I2C time spent building the last CoAP message
+ * i2c_transfers (uint32_t): app_i2c transactions since boot
+ * i2c_failed (uint32_t): app_i2c transactions that failed or timed out
+ * i2c_bus_us (uint32_t): app_i2c bus time, start to completion, since boot
+ * i2c_awake_us (uint32_t): CPU time spent on app_i2c since boot, the rest of i2c_bus_us is asleep
+ * batt_idle_mv (uint32_t): filtered AVDD between radio events
+ * batt_load_mv (uint32_t): filtered AVDD during radio activity
+ * batt_soc (uint8_t): battery state of charge in %
+ * batt_eol_days (uint32_t): predicted battery life left in days
+ * batt_trend (uint8_t): 1 if batt_eol_days is from the observed discharge rate
+ * batt_level (uint8_t): low-battery throttle level
+ * night (uint8_t): 1 while night mode holds the radar at RADAR_NIGHT_FRAME_SPACING_MS
+ * night_enters (uint32_t): times night mode was entered
+ * night_s (uint32_t): total time in night mode
+ * light_hints (uint32_t): OPT3001 light-change hints that took an early frame
+ * txq_depth (uint8_t): confirmable reports queued or in flight
+ * txq_acked (uint32_t): reports delivered
+ * txq_retries (uint32_t): repeated attempts after a failed exchange
+ * txq_coalesced (uint32_t): reports replaced by a newer one before delivery
+ * txq_dropped (uint32_t): reports dropped from a full queue or given up after APP_TXQ_MAX_TRIES
+ * txq_rtt_last_ms (uint32_t): RTT of the last delivered report
+ * txq_srtt_ms (uint32_t): smoothed RTT
+ * txq_rtt_max_ms (uint32_t): maximum RTT
+ * poll_period_ms (uint32_t): current data poll period
+ * poll_fast_enters (uint32_t): times fast polling started, for an exchange or a server request
+ * poll_fast_ms (uint32_t): total time spent polling fast
+ * poll_backoffs (uint32_t): idle poll period doublings
+ * poll_server_requests (uint32_t): server requests seen by the poll manager
+ * binding (uint8_t): appCoapBinding_t, where the server address and resource came from
+ * binding_epoch (uint32_t): bindings learned from the server, as stored in NVM
+ * binding_confirm_ms (uint32_t): restore at boot to the server answering the ping
+ * disc_servers (uint8_t): CoAP servers from the last DNS-SD browse
+ * disc_browses (uint32_t): browses answered
+ * disc_selections (uint32_t): servers picked for a registration
+ * disc_failovers (uint32_t): servers given up on, registration or reports failed
+ * recover_stage (uint8_t): appRecoverStage_t, 0 while attached
+ * recover_last_ms (uint32_t): time from losing the parent to the next attach, last time
+ * recover_searches, recover_reattaches, recover_resets (uint32_t): recovery actions taken
+ * then per stage (wait, search, reattach, reset), for the losses that got that far before the attach:
+ * recovered (uint32_t): number of them
+ * max_ms (uint32_t): longest time to recover
+ */
+void appCoapDiagHandler(void *aContext, otMessage *aMessage, const otMessageInfo *aMessageInfo)
+{
+    otError error = OT_ERROR_NONE;
+    otMessage *responseMessage;
+    acc_hal_integration_stats_t hal;
+    radarAppTiming_t timing;
+    appI2cStats_t i2c;
+    const appTxqStats_t *txq = &appCoapTxq.stats;
+    const appRecoverStats_t *rec = appCoapRecover.stats;
+    char buf[512];
+
+    sleepyPollServer();
+    responseMessage = otCoapNewMessage((otInstance*) aContext, NULL);
+    otEXPECT_ACTION(responseMessage != NULL, error = OT_ERROR_NO_BUFS);
+
+    if (otCoapMessageGetCode(aMessage) != OT_COAP_CODE_GET)
+    {
+        otCoapMessageInitResponse(responseMessage, aMessage,
+                                  OT_COAP_TYPE_ACKNOWLEDGMENT, OT_COAP_CODE_METHOD_NOT_ALLOWED);
+    }
+    else
+    {
+        acc_hal_integration_get_stats(&hal);
+        radarAppGetTiming(&timing);
+        appI2cGetStats(&i2c);
+        snprintf(buf, sizeof(buf), "%lu,%lu,%lu,%d,%u,%lu,%lu,%lu,%lu,%lu,%lu,%d,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%u,%lu,%d,%d,%d,%lu,%lu,%lu,%u,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%d,%lu,%lu,%u,%lu,%lu,%lu,%d,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu",
+                 hal.wake_to_data_us_last, hal.wake_to_data_us_max,
+                 hal.wakes, (int) radarCalibLastStatus(),
+                 hal.spi_width, hal.spi_transfers, hal.spi_bytes, hal.spi_cpu_cycles, hal.spi_us,
+                 hal.wait_us, hal.wait_timeouts,
+                 timing.async, timing.getNextUs, timing.postUs,
+                 timing.msgI2cUs, i2c.transfers, i2c.failed, i2c.busUs, i2c.awakeUs,
+                 radarBatt.idleMv, radarBatt.loadMv, radarBatt.soc, radarBatt.eolDays,
+                 (int) radarBatt.trend, (int) radarBatt.level,
+                 (int) radarNight.active, radarNight.enters, radarNight.activeS, radarNight.hints,
+                 appCoapTxq.count, txq->acked, txq->retries, txq->coalesced, txq->dropped + txq->failed,
+                 txq->rttLastMs, txq->srttMs, txq->rttMaxMs,
+                 sleepyPoll.periodMs, sleepyPoll.stats.fastEnters, sleepyPoll.stats.fastMs,
+                 sleepyPoll.stats.backoffs, sleepyPoll.stats.serverRequests,
+                 (int) appCoapBinding, appCoapBindingRec.epoch, appCoapBindingConfirmMs,
+                 appCoapDisc.count, appCoapDisc.stats.browses, appCoapDisc.stats.selections,
+                 appCoapDisc.stats.failovers,
+                 (int) appCoapRecover.stage, appCoapRecover.lastMs,
+                 appCoapRecover.searches, appCoapRecover.reattaches, appCoapRecover.resets,
+                 rec[APP_RECOVER_WAIT].recovered, rec[APP_RECOVER_WAIT].maxMs,
+                 rec[APP_RECOVER_SEARCH].recovered, rec[APP_RECOVER_SEARCH].maxMs,
+                 rec[APP_RECOVER_REATTACH].recovered, rec[APP_RECOVER_REATTACH].maxMs,
+                 rec[APP_RECOVER_RESET].recovered, rec[APP_RECOVER_RESET].maxMs);
+
+        otCoapMessageInitResponse(responseMessage, aMessage,
+                                  OT_COAP_TYPE_ACKNOWLEDGMENT, OT_COAP_CODE_CONTENT);
+        error = otCoapMessageSetPayloadMarker(responseMessage);
+        otEXPECT(OT_ERROR_NONE == error);
+        error = otMessageAppend(responseMessage, buf, strlen(buf));
+        otEXPECT(OT_ERROR_NONE == error);
+    }
+    error = otCoapSendResponse((otInstance*) aContext, responseMessage, aMessageInfo);
+
+    exit:
+    if (error != OT_ERROR_NONE && responseMessage != NULL)
+    {
+        otMessageFree(responseMessage);
+    }
+}
+
+
+/* Serves the presence trace (trace_rec.h, stored blocks first) with CoAP Block2. The
+ * block size is the client's, at most one trace block (64 B); a smaller one is a slice of it */
+void appCoapTraceHandler(void *aContext, otMessage *aMessage, const otMessageInfo *aMessageInfo)
+{
+    otError error = OT_ERROR_NONE;
+    otMessage *responseMessage;
+    otCoapOptionIterator iterator;
+    otCoapBlockSzx szx = OT_COAP_OPTION_BLOCK_SZX_64;
+    uint32_t offset = 0;
+    bool badBlock = false;
+    uint8_t block[TRACE_REC_BLOCK_SIZE];
+
+    sleepyPollServer();
+    responseMessage = otCoapNewMessage((otInstance*) aContext, NULL);
+    otEXPECT_ACTION(responseMessage != NULL, error = OT_ERROR_NO_BUFS);
+
+    if (otCoapOptionIteratorInit(&iterator, aMessage) == OT_ERROR_NONE)
+    {
+        uint64_t value;
+        if (otCoapOptionIteratorGetFirstMatchingOption(&iterator, OT_COAP_OPTION_BLOCK2) != NULL
+                && otCoapOptionIteratorGetOptionUintValue(&iterator, &value) == OT_ERROR_NONE)
+        {
+            // NUM counts blocks of the requested size, keep its offset when answering with a smaller one
+            uint8_t reqSzx = (uint8_t) (value & 0x7);
+            badBlock = reqSzx == 7; // reserved
+            offset = (uint32_t) (value >> 4) << (reqSzx + 4);
+            if (reqSzx < szx) szx = (otCoapBlockSzx) reqSzx;
+        }
+    }
+    uint32_t size = 16u << szx;
+
+    if (otCoapMessageGetCode(aMessage) != OT_COAP_CODE_GET)
+    {
+        otCoapMessageInitResponse(responseMessage, aMessage,
+                                  OT_COAP_TYPE_ACKNOWLEDGMENT, OT_COAP_CODE_METHOD_NOT_ALLOWED);
+    }
+    else if (badBlock || !traceRecReadBlock(offset / TRACE_REC_BLOCK_SIZE, block))
+    {
+        otCoapMessageInitResponse(responseMessage, aMessage,
+                                  OT_COAP_TYPE_ACKNOWLEDGMENT, OT_COAP_CODE_BAD_OPTION);
+    }
+    else
+    {
+        otCoapMessageInitResponse(responseMessage, aMessage,
+                                  OT_COAP_TYPE_ACKNOWLEDGMENT, OT_COAP_CODE_CONTENT);
+        error = otCoapMessageAppendContentFormatOption(responseMessage, OT_COAP_OPTION_CONTENT_FORMAT_OCTET_STREAM);
+        otEXPECT(OT_ERROR_NONE == error);
+        error = otCoapMessageAppendBlock2Option(responseMessage, offset / size,
+                                                offset + size < traceRecBlockCount() * TRACE_REC_BLOCK_SIZE, szx);
+        otEXPECT(OT_ERROR_NONE == error);
+        error = otCoapMessageSetPayloadMarker(responseMessage);
+        otEXPECT(OT_ERROR_NONE == error);
+        error = otMessageAppend(responseMessage, block + offset % TRACE_REC_BLOCK_SIZE, size);
+        otEXPECT(OT_ERROR_NONE == error);
+    }
+
+    error = otCoapSendResponse((otInstance*) aContext, responseMessage, aMessageInfo);
+
+    exit:
+    if (error != OT_ERROR_NONE && responseMessage != NULL)
+    {
+        otMessageFree(responseMessage);
+    }
+}
+
+
+/** Link Payload String **
+ * Request (PUT): "poll", or "csl[,period_ms[,channel]]" (channel 0: the operating channel)
+ * Response: mode,csl_state,csl_period_ms,csl_channel,csl_enables,csl_fallbacks, then per mode (poll, csl)
+ * time_s,polls,samples,rtt_mean_ms,rtt_max_ms,radio_na
+ *
+ * mode (uint8_t): 0 polling, 1 CSL, the mode in effect
+ * csl_state (uint8_t): appLinkCslState_t, 3 if the parent does not support CSL
+ * radio_na (uint32_t): modelled average current of polls and CSL windows in nA, see app_link.h
+ */
+void appCoapLinkHandler(void *aContext, otMessage *aMessage, const otMessageInfo *aMessageInfo)
+{
+    otError error = OT_ERROR_NONE;
+    otMessage *responseMessage;
+    otCoapCode responseCode = OT_COAP_CODE_CONTENT;
+    otCoapCode messageCode = otCoapMessageGetCode(aMessage);
+    char buf[200];
+    char mode[8];
+    unsigned long periodMs = APP_LINK_CSL_PERIOD_MS, channel = 0;
+
+    sleepyPollServer();
+    memset(buf, 0, sizeof(buf));
+    responseMessage = otCoapNewMessage((otInstance*) aContext, NULL);
+    otEXPECT_ACTION(responseMessage != NULL, error = OT_ERROR_NO_BUFS);
+
+    if (OT_COAP_CODE_PUT == messageCode)
+    {
+        otMessageRead(aMessage, otMessageGetOffset(aMessage), buf, sizeof(buf) - 1);
+        int n = sscanf(buf, "%7[a-z],%lu,%lu", mode, &periodMs, &channel);
+        bool ok = false;
+        if (n >= 1 && strcmp(mode, "poll") == 0) ok = sleepySetLinkMode(APP_LINK_POLL, sleepyLink.cslPeriodMs, sleepyLink.cslChannel);
+        else if (n >= 1 && strcmp(mode, "csl") == 0 && channel <= 26)
+        {
+            ok = sleepySetLinkMode(APP_LINK_CSL, (uint32_t) periodMs, (uint8_t) channel);
+        }
+        responseCode = ok ? OT_COAP_CODE_CHANGED : OT_COAP_CODE_BAD_REQUEST;
+    }
+    else if (OT_COAP_CODE_GET != messageCode)
+    {
+        responseCode = OT_COAP_CODE_METHOD_NOT_ALLOWED;
+    }
+
+    const appLinkModeStats_t *p = &sleepyLink.mode[APP_LINK_POLL];
+    const appLinkModeStats_t *c = &sleepyLink.mode[APP_LINK_CSL];
+    snprintf(buf, sizeof(buf), "%d,%d,%lu,%u,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu",
+             (int) appLinkActive(&sleepyLink), (int) sleepyLink.csl, sleepyLink.cslPeriodMs, sleepyLink.cslChannel,
+             sleepyLink.enables, sleepyLink.fallbacks,
+             p->timeS, p->polls, p->samples, p->rttCount ? p->rttSumMs / p->rttCount : 0, p->rttMaxMs,
+             (unsigned long) (appLinkCurrentUa(p) * 1000.0f),
+             c->timeS, c->polls, c->samples, c->rttCount ? c->rttSumMs / c->rttCount : 0, c->rttMaxMs,
+             (unsigned long) (appLinkCurrentUa(c) * 1000.0f));
+
+    otCoapMessageInitResponse(responseMessage, aMessage,
+                              OT_COAP_TYPE_ACKNOWLEDGMENT, responseCode);
+    error = otCoapMessageSetPayloadMarker(responseMessage);
+    otEXPECT(OT_ERROR_NONE == error);
+    error = otMessageAppend(responseMessage, buf, strlen(buf));
+    otEXPECT(OT_ERROR_NONE == error);
+    error = otCoapSendResponse((otInstance*) aContext, responseMessage, aMessageInfo);
+
+    exit:
+    if (error != OT_ERROR_NONE && responseMessage != NULL)
+    {
+        otMessageFree(responseMessage);
+    }
+}
+
+
+/** SPI Benchmark Payload String **
+ * Request (POST): frame_bytes,chunk_bytes[,iterations]
+ * Response: transfers,cpu_cycles,us per frame
+ *
+ * e.g. "6144,2048" for the single-descriptor split, "6144,6144" for one chained transfer.
+ * Runs between frames with the sensor deselected. frame_bytes is at most two
+ * A111_SPI_MAX_TRANSFER_SIZE and iterations at most 64, larger requests get 4.00.
+ */
+void appCoapSpiBenchHandler(void *aContext, otMessage *aMessage, const otMessageInfo *aMessageInfo)
+{
+    otError error = OT_ERROR_NONE;
+    otMessage *responseMessage;
+    otCoapCode responseCode = OT_COAP_CODE_CONTENT;
+    acc_hal_integration_spi_bench_t result;
+    unsigned long frameBytes = 0, chunkBytes = 0, iterations = 16;
+    char buf[48];
+
+    sleepyPollServer();
+    memset(buf, 0, sizeof(buf));
+    responseMessage = otCoapNewMessage((otInstance*) aContext, NULL);
+    otEXPECT_ACTION(responseMessage != NULL, error = OT_ERROR_NO_BUFS);
+
+    if (otCoapMessageGetCode(aMessage) != OT_COAP_CODE_POST)
+    {
+        responseCode = OT_COAP_CODE_METHOD_NOT_ALLOWED;
+    }
+    else
+    {
+        otMessageRead(aMessage, otMessageGetOffset(aMessage), buf, sizeof(buf) - 1);
+        if (sscanf(buf, "%lu,%lu,%lu", &frameBytes, &chunkBytes, &iterations) < 2
+                || !acc_hal_integration_spi_bench(frameBytes, chunkBytes, iterations, &result))
+        {
+            responseCode = OT_COAP_CODE_BAD_REQUEST;
+        }
+        else
+        {
+            snprintf(buf, sizeof(buf), "%lu,%lu,%lu", result.transfers, result.cpu_cycles, result.us);
+        }
+    }
+
+    otCoapMessageInitResponse(responseMessage, aMessage,
+                              OT_COAP_TYPE_ACKNOWLEDGMENT, responseCode);
+    if (OT_COAP_CODE_CONTENT == responseCode)
+    {
+        error = otCoapMessageSetPayloadMarker(responseMessage);
+        otEXPECT(OT_ERROR_NONE == error);
+        error = otMessageAppend(responseMessage, buf, strlen(buf));
+        otEXPECT(OT_ERROR_NONE == error);
+    }
+    error = otCoapSendResponse((otInstance*) aContext, responseMessage, aMessageInfo);
+
+    exit:
+    if (error != OT_ERROR_NONE && responseMessage != NULL)
+    {
+        otMessageFree(responseMessage);
+    }
+}
+
+
 void appCoapRadarSender(char *buf, bool require_ack)
 {
-    appCoapCheckConnection();
-    GPIO_PinOutSet(IP_LED_PORT, IP_LED_PIN);
+    appCoapRadarSendPayload((const uint8_t *) buf, strlen(buf), APP_COAP_NO_CONTENT_FORMAT, require_ack);
+}
+
+/* Builds and sends one PUT to the server's resource, see appCoapRadarSendPayload() */
+static otError appCoapRequest(const uint8_t *buf, uint16_t len, uint32_t contentFormat, otCoapType coapType,
+                              otCoapResponseHandler handler, void *context)
+{
     otError error = OT_ERROR_NONE;
     otMessage *message = NULL;
     otMessageInfo messageInfo;
     uint16_t payloadLength = 0;
 
     // Default parameters
-    otCoapType coapType = require_ack ? OT_COAP_TYPE_CONFIRMABLE: OT_COAP_TYPE_NON_CONFIRMABLE;
     otIp6Address coapDestinationIp = brAddr;
     message = otCoapNewMessage(otGetInstance(), NULL);
+    otEXPECT_ACTION(message != NULL, error = OT_ERROR_NO_BUFS);
 
     otCoapMessageInit(message, coapType, OT_COAP_CODE_PUT);
     otCoapMessageGenerateToken(message, OT_COAP_DEFAULT_TOKEN_LENGTH);
     error = otCoapMessageAppendUriPathOptions(message, resource_name);
     otEXPECT(OT_ERROR_NONE == error);
+    if (contentFormat != APP_COAP_NO_CONTENT_FORMAT)
+    {
+        error = otCoapMessageAppendUintOption(message, OT_COAP_OPTION_CONTENT_FORMAT, contentFormat);
+        otEXPECT(OT_ERROR_NONE == error);
+    }
 
-    payloadLength = strlen(buf);
+    payloadLength = len;
 
     if (payloadLength > 0)
     {
@@ -148,16 +641,15 @@ void appCoapRadarSender(char *buf, bool require_ack)
 
     memset(&messageInfo, 0, sizeof(messageInfo));
     messageInfo.mPeerAddr = coapDestinationIp;
-    messageInfo.mPeerPort = OT_DEFAULT_COAP_PORT;
+    messageInfo.mPeerPort = brPort;
     error = otCoapSendRequestWithParameters(otGetInstance(), message,
-                                            &messageInfo, NULL, NULL,
+                                            &messageInfo, handler, context,
                                             NULL);
     otEXPECT(OT_ERROR_NONE == error);
 
     exit:
     if ((error != OT_ERROR_NONE) && (message != NULL))
     {
-        appCoapFailCtr = 0;
         otMessageFree(message);
     }
 
@@ -168,23 +660,462 @@ void appCoapRadarSender(char *buf, bool require_ack)
     else GPIO_PinOutClear(ERR_LED_PORT, ERR_LED_PIN);
 
     //otCliOutputFormat("Sent message: %d\n", error);
+    return error;
+}
+
+void appCoapRadarSendPayload(const uint8_t *buf, uint16_t len, uint32_t contentFormat, bool require_ack)
+{
+    appCoapCheckConnection();
+    GPIO_PinOutSet(IP_LED_PORT, IP_LED_PIN);
+    appCoapRequest(buf, len, contentFormat,
+                   require_ack ? OT_COAP_TYPE_CONFIRMABLE : OT_COAP_TYPE_NON_CONFIRMABLE, NULL, NULL);
     GPIO_PinOutClear(IP_LED_PORT, IP_LED_PIN);
 }
 
+static uint32_t appCoapNowMs(void)
+{
+    return (uint32_t) (sl_sleeptimer_get_tick_count64() * 1000 / sl_sleeptimer_get_timer_frequency());
+}
+
+/* A report was given up on: held against the registered server only if its last
+ * attempt went there and the node stayed attached until the result. Reports
+ * lost to a detach are not the server's fault */
+static void appCoapDiscCountFailed(uint32_t failed)
+{
+    if (appCoapTxq.stats.failed != failed && appCoapDiscAttempt
+            && otThreadGetDeviceRole(otGetInstance()) == OT_DEVICE_ROLE_CHILD)
+    {
+        appCoapDiscFailed++;
+    }
+}
+
+/* Result of a queued report, the context is the attempt's sequence number */
+static void appCoapQueueResponseHandler(void *aContext, otMessage *aMessage, const otMessageInfo *aMessageInfo, otError aResult)
+{
+    (void) aMessageInfo;
+    uint16_t seq = (uint16_t) (uintptr_t) aContext;
+
+    // 5.xx: the server could not take it now, worth another attempt
+    if (aResult == OT_ERROR_NONE && aMessage != NULL && (otCoapMessageGetCode(aMessage) >> 5) != 5)
+    {
+        uint32_t acked = appCoapTxq.stats.acked;
+        appTxqAck(&appCoapTxq, seq, appCoapNowMs());
+        if (appCoapTxq.stats.acked != acked) sleepyLinkRtt(appCoapTxq.stats.rttLastMs);
+        GPIO_PinOutClear(ERR_LED_PORT, ERR_LED_PIN);
+    }
+    else
+    {
+        uint32_t failed = appCoapTxq.stats.failed;
+        appTxqFail(&appCoapTxq, seq, appCoapNowMs());
+        appCoapDiscCountFailed(failed);
+        GPIO_PinOutSet(ERR_LED_PORT, ERR_LED_PIN);
+    }
+    appCoapProcessQueue();
+}
+
+static void appCoapQueueTimerCb(sl_sleeptimer_timer_handle_t *handle, void *data)
+{
+    (void) handle;
+    (void) data;
+    // Only wakes the main loop, radarAppAlgo() services the queue
+}
+
+void appCoapQueueInit(uint32_t seed)
+{
+    appTxqInit(&appCoapTxq, seed);
+}
+
+void appCoapQueueReport(const uint8_t *buf, uint16_t len, uint32_t contentFormat, uint8_t key)
+{
+    appCoapCheckConnection();
+    appTxqPush(&appCoapTxq, buf, len, contentFormat, key, appCoapNowMs());
+    appCoapProcessQueue();
+}
+
+void appCoapProcessQueue(void)
+{
+    // Held while detached, the queue carries over the reattach
+    if (otThreadGetDeviceRole(otGetInstance()) != OT_DEVICE_ROLE_CHILD) return;
+
+    uint32_t now = appCoapNowMs();
+    uint32_t failed = appCoapTxq.stats.failed;
+    const appTxqMsg_t *msg = appTxqNext(&appCoapTxq, now); // gives up on an attempt without a result
+    appCoapDiscCountFailed(failed);
+    if (msg != NULL)
+    {
+        GPIO_PinOutSet(IP_LED_PORT, IP_LED_PIN);
+        uint16_t seq = msg->seq;
+        appCoapDiscAttempt = appCoapBinding == APP_COAP_BINDING_REGISTERED;
+        failed = appCoapTxq.stats.failed;
+        if (appCoapRequest(msg->buf, msg->len, msg->contentFormat, OT_COAP_TYPE_CONFIRMABLE,
+                           appCoapQueueResponseHandler, (void *) (uintptr_t) seq) != OT_ERROR_NONE)
+        {
+            appTxqFail(&appCoapTxq, seq, now);
+            appCoapDiscCountFailed(failed);
+        }
+        GPIO_PinOutClear(IP_LED_PORT, IP_LED_PIN);
+    }
+
+    sleepyPollExchange(appCoapTxq.inFlight, appCoapTxq.stats.srttMs);
+
+    // Wake up for the next retry, the frame timer may be slower
+    uint32_t wait = appTxqWaitMs(&appCoapTxq, appCoapNowMs());
+    sl_sleeptimer_stop_timer(&appCoapQueueTimer);
+    if (wait != UINT32_MAX)
+    {
+        sl_sleeptimer_start_timer_ms(&appCoapQueueTimer, wait, appCoapQueueTimerCb, NULL, 0, 0);
+    }
+}
+
+/* Writes the binding from the permissions GET, unless it is the one in NVM already */
+void appCoapBindingStore(void)
+{
+    appCoapBindingRecord_t *rec = &appCoapBindingRec;
+    const otExtendedPanId *extPanId = otThreadGetExtendedPanId(otGetInstance());
+    bool same = rec->format == APP_COAP_BINDING_FORMAT
+            && rec->binary == appCoapBinaryPayload && rec->batch == appCoapBatchAlive
+            && memcmp(&rec->extPanId, extPanId, sizeof(*extPanId)) == 0
+            && memcmp(&rec->brAddr, &brAddr, sizeof(brAddr)) == 0 && rec->brPort == brPort
+            && memcmp(rec->resource, resource_name, sizeof(resource_name)) == 0;
+
+    appCoapBinding = APP_COAP_BINDING_LEARNED;
+    if (same && rec->unconfirmed == 0) return;
+    if (!same)
+    {
+        rec->format = APP_COAP_BINDING_FORMAT;
+        rec->epoch++;
+        rec->binary = appCoapBinaryPayload;
+        rec->batch = appCoapBatchAlive;
+        rec->extPanId = *extPanId;
+        rec->brAddr = brAddr;
+        rec->brPort = brPort;
+        memcpy(rec->resource, resource_name, sizeof(resource_name));
+    }
+    rec->unconfirmed = 0;
+    appNvmWrite(APP_NVM_KEY_COAP_BINDING, rec, sizeof(*rec));
+}
+
+void appCoapBindingRestore(void)
+{
+    appCoapBindingRecord_t *rec = &appCoapBindingRec;
+    const otExtendedPanId *extPanId = otThreadGetExtendedPanId(otGetInstance());
+
+    if (!appNvmRead(APP_NVM_KEY_COAP_BINDING, rec, sizeof(*rec)) || rec->format != APP_COAP_BINDING_FORMAT)
+    {
+        memset(rec, 0, sizeof(*rec));
+        return;
+    }
+    // Another network, or a server that stopped answering: wait for the permissions GET as before
+    if (memcmp(&rec->extPanId, extPanId, sizeof(*extPanId)) != 0
+            || rec->unconfirmed >= APP_COAP_BINDING_MAX_UNCONFIRMED)
+    {
+        appNvmErase(APP_NVM_KEY_COAP_BINDING);
+        rec->format = 0;
+        return;
+    }
+
+    rec->unconfirmed++;
+    appNvmWrite(APP_NVM_KEY_COAP_BINDING, rec, sizeof(*rec));
+    brAddr = rec->brAddr;
+    brPort = rec->brPort;
+    memcpy(resource_name, rec->resource, sizeof(resource_name));
+    resource_name[sizeof(resource_name) - 1] = '\0';
+    appCoapBinaryPayload = rec->binary;
+    appCoapBatchAlive = rec->batch;
+    appCoapBinding = APP_COAP_BINDING_RESTORED;
+    appCoapBindingRestoredMs = appCoapNowMs();
+    appCoapConnectionEstablished = true;
+}
+
+/* Empty confirmable message: the server answers with a reset (RFC 7252, 4.3) */
+static void appCoapBindingPingHandler(void *aContext, otMessage *aMessage, const otMessageInfo *aMessageInfo, otError aResult)
+{
+    (void) aContext;
+    (void) aMessage;
+    (void) aMessageInfo;
+
+    if (appCoapBinding != APP_COAP_BINDING_PINGING) return; // the server bound us meanwhile
+    if (aResult == OT_ERROR_ABORT || aResult == OT_ERROR_NONE)
+    {
+        appCoapBinding = APP_COAP_BINDING_CONFIRMED;
+        appCoapBindingConfirmMs = appCoapNowMs() - appCoapBindingRestoredMs;
+        appCoapBindingRec.unconfirmed = 0;
+        appNvmWrite(APP_NVM_KEY_COAP_BINDING, &appCoapBindingRec, sizeof(appCoapBindingRec));
+    }
+    else
+    {
+        // Nobody there: silent until the server finds us, the record goes after a few such boots
+        appCoapBinding = APP_COAP_BINDING_STALE;
+        appCoapConnectionEstablished = false;
+    }
+}
+
+static void appCoapBindingPing(void)
+{
+    otMessage *message = otCoapNewMessage(otGetInstance(), NULL);
+    otMessageInfo messageInfo;
+
+    if (message == NULL) return;
+    otCoapMessageInit(message, OT_COAP_TYPE_CONFIRMABLE, OT_COAP_CODE_EMPTY);
+    memset(&messageInfo, 0, sizeof(messageInfo));
+    messageInfo.mPeerAddr = brAddr;
+    messageInfo.mPeerPort = brPort;
+    if (otCoapSendRequest(otGetInstance(), message, &messageInfo, appCoapBindingPingHandler, NULL) != OT_ERROR_NONE)
+    {
+        otMessageFree(message);
+        return;
+    }
+    appCoapBinding = APP_COAP_BINDING_PINGING;
+}
+
+static void appCoapDiscRegister(void);
+static void appCoapDiscResolveNext(void);
+
+void appCoapDiscoverInit(uint32_t seed)
+{
+    appDiscInit(&appCoapDisc, seed, appCoapNowMs());
+}
+
+/* Server answered the registration with our resource name, like a permissions GET */
+static void appCoapDiscRegisterHandler(void *aContext, otMessage *aMessage, const otMessageInfo *aMessageInfo, otError aResult)
+{
+    (void) aContext;
+    appCoapDiscBusy = false;
+
+    if (aResult != OT_ERROR_NONE || aMessage == NULL || (otCoapMessageGetCode(aMessage) >> 5) != 2)
+    {
+        appDiscFail(&appCoapDisc, appCoapNowMs());
+        appCoapDiscRegister(); // the next server, if any
+        return;
+    }
+
+    brAddr = aMessageInfo->mPeerAddr;
+    brPort = aMessageInfo->mPeerPort; // reports go where the registration went
+    selfAddr = aMessageInfo->mSockAddr;
+    memset(resource_name, 0, sizeof(resource_name));
+    otMessageRead(aMessage, otMessageGetOffset(aMessage), resource_name, sizeof(resource_name) - 1);
+    appCoapParseAccept(aMessage);
+    appCoapBindingStore();
+    appCoapBinding = APP_COAP_BINDING_REGISTERED;
+    appCoapDiscFailed = 0;
+    appCoapDiscAttempt = false;
+    appCoapConnectionEstablished = true;
+}
+
+/* PUT REGISTER_URI with our SRP instance name to the server picked by priority and weight */
+static void appCoapDiscRegister(void)
+{
+    const appDiscServer_t *server = appDiscSelect(&appCoapDisc, appCoapNowMs());
+    otMessage *message = NULL;
+    otMessageInfo messageInfo;
+    otError error = OT_ERROR_NONE;
+    char name[32];
+
+    otEXPECT_ACTION(server != NULL, error = OT_ERROR_NOT_FOUND);
+    message = otCoapNewMessage(otGetInstance(), NULL);
+    otEXPECT_ACTION(message != NULL, error = OT_ERROR_NO_BUFS);
+    otCoapMessageInit(message, OT_COAP_TYPE_CONFIRMABLE, OT_COAP_CODE_PUT);
+    otCoapMessageGenerateToken(message, OT_COAP_DEFAULT_TOKEN_LENGTH);
+    error = otCoapMessageAppendUriPathOptions(message, REGISTER_URI);
+    otEXPECT(OT_ERROR_NONE == error);
+    error = otCoapMessageSetPayloadMarker(message);
+    otEXPECT(OT_ERROR_NONE == error);
+    appSrpInstanceName(name, sizeof(name));
+    error = otMessageAppend(message, name, strlen(name));
+    otEXPECT(OT_ERROR_NONE == error);
+
+    memset(&messageInfo, 0, sizeof(messageInfo));
+    memcpy(messageInfo.mPeerAddr.mFields.m8, server->addr, sizeof(server->addr));
+    messageInfo.mPeerPort = server->port ? server->port : OT_DEFAULT_COAP_PORT;
+    error = otCoapSendRequest(otGetInstance(), message, &messageInfo, appCoapDiscRegisterHandler, NULL);
+    otEXPECT(OT_ERROR_NONE == error);
+    appCoapDiscBusy = true;
+    sleepyPollServer(); // poll fast for the answer
+
+    exit:
+    if (error != OT_ERROR_NONE && message != NULL)
+    {
+        otMessageFree(message);
+    }
+    // Not the server's fault: try again with the next browse
+    if (error != OT_ERROR_NONE && server != NULL) appDiscEnd(&appCoapDisc, false, appCoapNowMs());
+}
+
+/* Instances are in: keep the current server if it is still listed, else register with another */
+static void appCoapDiscComplete(bool ok)
+{
+    uint32_t now = appCoapNowMs();
+    appDiscEnd(&appCoapDisc, ok, now);
+    if (appCoapBinding == APP_COAP_BINDING_REGISTERED && appDiscCurrent(&appCoapDisc, now) != NULL) return;
+    // The server may have found us meanwhile
+    if (appCoapBinding != APP_COAP_BINDING_NONE && appCoapBinding != APP_COAP_BINDING_STALE
+            && appCoapBinding != APP_COAP_BINDING_REGISTERED) return;
+    appCoapDiscRegister();
+}
+
+static bool appCoapDiscAddInfo(const char *label, const otDnsServiceInfo *info)
+{
+    if (otIp6IsAddressUnspecified(&info->mHostAddress)) return false;
+    uint32_t ttl = info->mTtl < info->mHostAddressTtl ? info->mTtl : info->mHostAddressTtl;
+    return appDiscAdd(&appCoapDisc, label, info->mHostAddress.mFields.m8, info->mPort,
+                      info->mPriority, info->mWeight, ttl, appCoapNowMs());
+}
+
+static void appCoapDiscResolveHandler(otError aError, const otDnsServiceResponse *aResponse, void *aContext)
+{
+    const char *label = appDiscUnresolved(&appCoapDisc);
+    otDnsServiceInfo info;
+    (void) aContext;
+
+    memset(&info, 0, sizeof(info));
+    if (label == NULL) return;
+    if (aError != OT_ERROR_NONE || otDnsServiceResponseGetServiceInfo(aResponse, &info) != OT_ERROR_NONE
+            || !appCoapDiscAddInfo(label, &info))
+    {
+        appDiscDrop(&appCoapDisc, label);
+    }
+    appCoapDiscResolveNext();
+}
+
+/* Resolves the instances that came without records, one query at a time */
+static void appCoapDiscResolveNext(void)
+{
+    const char *label = appDiscUnresolved(&appCoapDisc);
+
+    appCoapDiscBusy = false;
+    if (label == NULL)
+    {
+        appCoapDiscComplete(true);
+        return;
+    }
+    if (otDnsClientResolveService(otGetInstance(), label, APP_COAP_DISC_SERVICE,
+                                  appCoapDiscResolveHandler, NULL, NULL) != OT_ERROR_NONE)
+    {
+        appDiscDrop(&appCoapDisc, label);
+        appCoapDiscResolveNext();
+        return;
+    }
+    appCoapDiscBusy = true;
+}
+
+static void appCoapDiscBrowseHandler(otError aError, const otDnsBrowseResponse *aResponse, void *aContext)
+{
+    char label[APP_DISC_LABEL_SIZE];
+    (void) aContext;
+
+    appCoapDiscBusy = false;
+    if (aError != OT_ERROR_NONE)
+    {
+        appCoapDiscComplete(false);
+        return;
+    }
+
+    appDiscBegin(&appCoapDisc);
+    for (uint16_t i = 0; otDnsBrowseResponseGetServiceInstance(aResponse, i, label, sizeof(label)) == OT_ERROR_NONE; i++)
+    {
+        // The DNS-SD server usually adds the SRV and AAAA records, saving a resolve per instance
+        otDnsServiceInfo info;
+        memset(&info, 0, sizeof(info));
+        if (otDnsBrowseResponseGetServiceInfo(aResponse, label, &info) != OT_ERROR_NONE
+                || !appCoapDiscAddInfo(label, &info))
+        {
+            appDiscAdd(&appCoapDisc, label, NULL, 0, 0, 0, 0, 0);
+        }
+    }
+    appCoapDiscResolveNext();
+}
+
+void appCoapDiscoverProcess(void)
+{
+    otInstance *instance = otGetInstance();
+    uint32_t now = appCoapNowMs();
+
+    if (appCoapDiscBusy || otThreadGetDeviceRole(instance) != OT_DEVICE_ROLE_CHILD) return;
+
+    // Reports to a discovered server keep failing: register with another one
+    if (appCoapBinding == APP_COAP_BINDING_REGISTERED && appCoapDiscFailed)
+    {
+        appCoapDiscFailed = 0;
+        appDiscFail(&appCoapDisc, now);
+        appCoapDiscRegister();
+        return;
+    }
+
+    // Only without a working server, or to refresh one found here when its TTL runs out
+    if (appCoapBinding != APP_COAP_BINDING_NONE && appCoapBinding != APP_COAP_BINDING_STALE
+            && appCoapBinding != APP_COAP_BINDING_REGISTERED) return;
+    if (!appDiscDue(&appCoapDisc, now)) return;
+
+    if (otDnsClientBrowse(instance, APP_COAP_DISC_SERVICE, appCoapDiscBrowseHandler, NULL, NULL) == OT_ERROR_NONE)
+    {
+        appCoapDiscBusy = true;
+    }
+    else
+    {
+        appDiscEnd(&appCoapDisc, false, now);
+    }
+}
+
+static void appCoapRecoverTimerCb(sl_sleeptimer_timer_handle_t *handle, void *data)
+{
+    (void) handle;
+    (void) data;
+    // Only wakes the main loop, app_process_action() steps the recovery
+}
+
+void appCoapRecoverInit(uint32_t seed)
+{
+    appRecoverInit(&appCoapRecover, seed, APP_RECOVER_FLEET_NODES);
+}
+
 void appCoapCheckConnection(void)
 {
     if(!appCoapConnectionEstablished) return;
 
-    if(otThreadGetDeviceRole(otGetInstance()) != OT_DEVICE_ROLE_CHILD || appCoapFailCtr > 10)
+    // Failed sends are retried by the report queue, only a lost parent is recovered.
+    // CoAP and its resources stay as they are, otCoapStart() and otCoapAddResource() are not repeated
+    otInstance *instance = otGetInstance();
+    uint32_t now = appCoapNowMs();
+    bool attached = otThreadGetDeviceRole(instance) == OT_DEVICE_ROLE_CHILD;
+    uint32_t rxUnicast = otLinkGetCounters(instance)->mRxUnicast;
+    bool heard = rxUnicast != appCoapRecoverRxUnicast;
+    appCoapRecoverRxUnicast = rxUnicast;
+    if (!attached) appCoapDiscAttempt = false;
+
+    // A binding restored from NVM is checked once the parent is there
+    if (attached && appCoapBinding == APP_COAP_BINDING_RESTORED) appCoapBindingPing();
+
+    switch (appRecoverUpdate(&appCoapRecover, attached, heard, now))
     {
-        otThreadBecomeDetached(otGetInstance());
+    case APP_RECOVER_DO_SEARCH:
+        otThreadBecomeChild(instance);
+        GPIO_PinOutToggle(IP_LED_PORT, IP_LED_PIN);
+        break;
+    case APP_RECOVER_DO_REATTACH:
+        otThreadSetEnabled(instance, false);
+        sleepyInit();
+        otThreadSetEnabled(instance, true);
+        GPIO_PinOutToggle(IP_LED_PORT, IP_LED_PIN);
+        break;
+    case APP_RECOVER_DO_RESET:
+        otThreadSetEnabled(instance, false);
+        otIp6SetEnabled(instance, false);
         //otInstanceErasePersistentInfo();
         sleepyInit();
         setNetworkConfiguration();
-        otIp6SetEnabled(otGetInstance(), true);
-        otThreadSetEnabled(otGetInstance(), true);
-        appCoapInit();
+        otIp6SetEnabled(instance, true);
+        otThreadSetEnabled(instance, true);
         GPIO_PinOutToggle(IP_LED_PORT, IP_LED_PIN);
-        appCoapFailCtr = 0;
+        break;
+    default:
+        break;
+    }
+
+    // Wake up for the next search or reset
+    uint32_t wait = appRecoverWaitMs(&appCoapRecover, now);
+    sl_sleeptimer_stop_timer(&appCoapRecoverTimer);
+    if (wait != UINT32_MAX)
+    {
+        sl_sleeptimer_start_timer_ms(&appCoapRecoverTimer, wait, appCoapRecoverTimerCb, NULL, 0, 0);
     }
 }
@@ -10,11 +10,52 @@
 
 extern otIp6Address selfAddr;
 extern otIp6Address brAddr;
+extern uint16_t brPort;
 extern bool appCoapConnectionEstablished;
+extern bool appCoapBinaryPayload; // reports use the binary payload (app_payload.h)
+extern bool appCoapBatchAlive;    // alive telemetry is batched (app_batch.h)
+
+#define APP_COAP_NO_CONTENT_FORMAT UINT32_MAX
+
+/* Where brAddr and resource_name came from. A binding restored from NVM is used
+ * at once and confirmed with a CoAP ping to the server once attached */
+typedef enum
+{
+    APP_COAP_BINDING_NONE = 0,
+    APP_COAP_BINDING_RESTORED,
+    APP_COAP_BINDING_PINGING,
+    APP_COAP_BINDING_CONFIRMED,
+    APP_COAP_BINDING_STALE,     // ping unanswered, waiting for the server
+    APP_COAP_BINDING_LEARNED,   // from the server's permissions GET
+    APP_COAP_BINDING_REGISTERED, // registered with a server found by DNS-SD
+} appCoapBinding_t;
+
+extern appCoapBinding_t appCoapBinding;
 
 void appCoapInit();
 void appCoapPermissionsHandler(void *aContext, otMessage *aMessage, const otMessageInfo *aMessageInfo);
+void appCoapPolicyHandler(void *aContext, otMessage *aMessage, const otMessageInfo *aMessageInfo);
+void appCoapDiagHandler(void *aContext, otMessage *aMessage, const otMessageInfo *aMessageInfo);
+void appCoapTraceHandler(void *aContext, otMessage *aMessage, const otMessageInfo *aMessageInfo);
+void appCoapLinkHandler(void *aContext, otMessage *aMessage, const otMessageInfo *aMessageInfo);
+void appCoapSpiBenchHandler(void *aContext, otMessage *aMessage, const otMessageInfo *aMessageInfo);
 void appCoapRadarSender(char *buf, bool require_ack);
+/* PUT to the server's resource, with a Content-Format option unless APP_COAP_NO_CONTENT_FORMAT */
+void appCoapRadarSendPayload(const uint8_t *buf, uint16_t len, uint32_t contentFormat, bool require_ack);
+/* Steps the staged parent recovery, see app_recover.h */
 void appCoapCheckConnection(void);
+void appCoapRecoverInit(uint32_t seed);
+/* Server binding in NVM: restored once at boot after appCoapInit(), stored on a permissions GET */
+void appCoapBindingRestore(void);
+void appCoapBindingStore(void);
+/* DNS-SD discovery of the server and self-registration, see app_disc.h; from the main loop */
+void appCoapDiscoverInit(uint32_t seed);
+void appCoapDiscoverProcess(void);
+
+/* Confirmable reports go through a delivery queue (app_txq.h) with retries and
+ * coalescing on key; appCoapProcessQueue() sends and retries from the main loop */
+void appCoapQueueInit(uint32_t seed);
+void appCoapQueueReport(const uint8_t *buf, uint16_t len, uint32_t contentFormat, uint8_t key);
+void appCoapProcessQueue(void);
 
 #endif /* APP_COAP_H_ */
@@ -0,0 +1,196 @@
+/*
+ * app_disc.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: edward62740
+ */
+
+#include <string.h>
+#include "app_disc.h"
+
+/* 32 bits from the upper halves of two steps, the low bits of the LCG are poor */
+static uint32_t appDiscRand(appDisc_t *disc)
+{
+    disc->seed = disc->seed * 1664525u + 1013904223u;
+    uint32_t hi = disc->seed & 0xFFFF0000u;
+    disc->seed = disc->seed * 1664525u + 1013904223u;
+    return hi | disc->seed >> 16;
+}
+
+void appDiscInit(appDisc_t *disc, uint32_t seed, uint32_t nowMs)
+{
+    memset(disc, 0, sizeof(*disc));
+    disc->seed = seed;
+    disc->retryMs = APP_DISC_RETRY_MS;
+    disc->nextBrowseMs = nowMs;
+}
+
+void appDiscBegin(appDisc_t *disc)
+{
+    disc->count = 0;
+    disc->stats.browses++;
+}
+
+static appDiscServer_t *appDiscFind(appDisc_t *disc, const char *label)
+{
+    for (uint8_t i = 0; i < disc->count; i++)
+    {
+        if (strncmp(disc->server[i].label, label, APP_DISC_LABEL_SIZE) == 0) return &disc->server[i];
+    }
+    return NULL;
+}
+
+bool appDiscAdd(appDisc_t *disc, const char *label, const uint8_t *addr, uint16_t port,
+                uint16_t priority, uint16_t weight, uint32_t ttlS, uint32_t nowMs)
+{
+    appDiscServer_t *s = appDiscFind(disc, label);
+    if (s == NULL)
+    {
+        if (disc->count == APP_DISC_MAX_SERVERS) return false;
+        s = &disc->server[disc->count++];
+        memset(s, 0, sizeof(*s));
+        strncpy(s->label, label, APP_DISC_LABEL_SIZE - 1);
+    }
+    if (addr == NULL) return true;
+
+    if (ttlS < APP_DISC_TTL_MIN_S) ttlS = APP_DISC_TTL_MIN_S;
+    if (ttlS > APP_DISC_TTL_MAX_S) ttlS = APP_DISC_TTL_MAX_S;
+    memcpy(s->addr, addr, sizeof(s->addr));
+    s->port = port;
+    s->priority = priority;
+    s->weight = weight;
+    s->expiresMs = nowMs + ttlS * 1000;
+    s->resolved = true;
+    return true;
+}
+
+const char *appDiscUnresolved(const appDisc_t *disc)
+{
+    for (uint8_t i = 0; i < disc->count; i++)
+    {
+        if (!disc->server[i].resolved) return disc->server[i].label;
+    }
+    return NULL;
+}
+
+void appDiscDrop(appDisc_t *disc, const char *label)
+{
+    appDiscServer_t *s = appDiscFind(disc, label);
+    if (s == NULL) return;
+    *s = disc->server[--disc->count];
+}
+
+static bool appDiscUsable(const appDiscServer_t *s, uint32_t nowMs)
+{
+    return s->resolved && !s->failed && (int32_t) (s->expiresMs - nowMs) > 0;
+}
+
+/* Nothing usable: browse again later, each time after twice as long */
+static void appDiscBackoff(appDisc_t *disc, uint32_t nowMs)
+{
+    disc->nextBrowseMs = nowMs + disc->retryMs + appDiscRand(disc) % (disc->retryMs / 2 + 1);
+    disc->retryMs = disc->retryMs * 2 < APP_DISC_RETRY_MAX_MS ? disc->retryMs * 2 : APP_DISC_RETRY_MAX_MS;
+}
+
+void appDiscEnd(appDisc_t *disc, bool ok, uint32_t nowMs)
+{
+    bool any = false;
+    uint32_t first = 0;
+
+    for (uint8_t i = 0; ok && i < disc->count; i++)
+    {
+        const appDiscServer_t *s = &disc->server[i];
+        if (!appDiscUsable(s, nowMs)) continue;
+        if (!any || (int32_t) (s->expiresMs - first) < 0) first = s->expiresMs;
+        any = true;
+    }
+    if (!any)
+    {
+        disc->stats.retries++;
+        appDiscBackoff(disc, nowMs);
+        return;
+    }
+    disc->retryMs = APP_DISC_RETRY_MS;
+    disc->nextBrowseMs = first;
+}
+
+bool appDiscDue(const appDisc_t *disc, uint32_t nowMs)
+{
+    return (int32_t) (nowMs - disc->nextBrowseMs) >= 0;
+}
+
+const appDiscServer_t *appDiscCurrent(const appDisc_t *disc, uint32_t nowMs)
+{
+    if (disc->current[0] == '\0') return NULL;
+    const appDiscServer_t *s = appDiscFind((appDisc_t *) disc, disc->current);
+    return s != NULL && appDiscUsable(s, nowMs) ? s : NULL;
+}
+
+const appDiscServer_t *appDiscSelect(appDisc_t *disc, uint32_t nowMs)
+{
+    uint16_t priority = UINT16_MAX;
+    uint32_t total = 0, usable = 0, zero = 0;
+    appDiscServer_t *pick = NULL;
+
+    for (uint8_t i = 0; i < disc->count; i++)
+    {
+        const appDiscServer_t *s = &disc->server[i];
+        if (appDiscUsable(s, nowMs) && s->priority < priority) priority = s->priority;
+    }
+    for (uint8_t i = 0; i < disc->count; i++)
+    {
+        const appDiscServer_t *s = &disc->server[i];
+        if (!appDiscUsable(s, nowMs) || s->priority != priority) continue;
+        total += s->weight;
+        usable++;
+        if (s->weight == 0) zero++;
+    }
+    if (usable == 0)
+    {
+        disc->current[0] = '\0';
+        return NULL;
+    }
+
+    /* Weighted among the lowest priority, uniform if all weights are 0. As in
+     * RFC 2782 the weight 0 servers still get a small chance: one draw out of
+     * total + 1, shared between them */
+    bool zeroDraw = false;
+    uint32_t r;
+    if (total == 0) r = appDiscRand(disc) % usable;
+    else
+    {
+        r = appDiscRand(disc) % (total + (zero ? 1 : 0));
+        if (r == total)
+        {
+            zeroDraw = true;
+            r = appDiscRand(disc) % zero;
+        }
+    }
+    for (uint8_t i = 0; i < disc->count && pick == NULL; i++)
+    {
+        appDiscServer_t *s = &disc->server[i];
+        if (!appDiscUsable(s, nowMs) || s->priority != priority) continue;
+        uint32_t share = total == 0 ? 1 : zeroDraw ? s->weight == 0 : s->weight;
+        if (r < share) pick = s;
+        else r -= share;
+    }
+
+    strncpy(disc->current, pick->label, APP_DISC_LABEL_SIZE);
+    disc->stats.selections++;
+    return pick;
+}
+
+void appDiscFail(appDisc_t *disc, uint32_t nowMs)
+{
+    appDiscServer_t *s = disc->current[0] ? appDiscFind(disc, disc->current) : NULL;
+    disc->current[0] = '\0';
+    if (s == NULL) return;
+    s->failed = true;
+    disc->stats.failovers++;
+
+    for (uint8_t i = 0; i < disc->count; i++)
+    {
+        if (appDiscUsable(&disc->server[i], nowMs)) return;
+    }
+    appDiscBackoff(disc, nowMs);
+}
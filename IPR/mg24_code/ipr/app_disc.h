@@ -0,0 +1,97 @@
+/*
+ * app_disc.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: edward62740
+ */
+
+#ifndef APP_DISC_H_
+#define APP_DISC_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* CoAP servers found by DNS-SD browsing. Hardware free, shared with the host;
+ * app_coap.c runs the browse and resolve queries and registers with the server
+ * picked here.
+ *
+ * Every browse replaces the list. Instances that came without their SRV and
+ * AAAA records are kept unresolved until app_coap.c resolves them. A server is
+ * picked as in RFC 2782: the lowest priority first, and among those at random in
+ * proportion to the weight, so that a fleet spreads over equal servers. Weight 0
+ * servers are picked once in total weight + 1 if others have a weight. A server
+ * that failed is skipped until the next browse. The list is browsed again when
+ * the first TTL runs out, and after a browse without a usable server with a
+ * jittered backoff from APP_DISC_RETRY_MS to APP_DISC_RETRY_MAX_MS. */
+
+#define APP_DISC_MAX_SERVERS   4
+#define APP_DISC_LABEL_SIZE    64     // OT_DNS_MAX_LABEL_SIZE
+#define APP_DISC_TTL_MIN_S     60     // floor for the refresh, short TTLs would keep the radio busy
+#define APP_DISC_TTL_MAX_S     86400
+#define APP_DISC_RETRY_MS      30000
+#define APP_DISC_RETRY_MAX_MS  600000
+
+typedef struct
+{
+    char label[APP_DISC_LABEL_SIZE];
+    bool resolved;
+    bool failed;
+    uint8_t addr[16];
+    uint16_t port;
+    uint16_t priority;
+    uint16_t weight;
+    uint32_t expiresMs;
+} appDiscServer_t;
+
+typedef struct
+{
+    uint32_t browses;
+    uint32_t selections;
+    uint32_t failovers;
+    uint32_t retries;         // browses rescheduled with the backoff
+} appDiscStats_t;
+
+typedef struct
+{
+    appDiscServer_t server[APP_DISC_MAX_SERVERS];
+    uint8_t count;
+    char current[APP_DISC_LABEL_SIZE]; // the server registered with, "" if none
+    uint32_t nextBrowseMs;
+    uint32_t retryMs;
+    uint32_t seed;
+    appDiscStats_t stats;
+} appDisc_t;
+
+/* Browses at once */
+void appDiscInit(appDisc_t *disc, uint32_t seed, uint32_t nowMs);
+
+/* A browse answered, the instances follow with appDiscAdd() */
+void appDiscBegin(appDisc_t *disc);
+
+/* Adds or updates an instance; addr NULL if its records have yet to be resolved.
+ * false if the list is full */
+bool appDiscAdd(appDisc_t *disc, const char *label, const uint8_t *addr, uint16_t port,
+                uint16_t priority, uint16_t weight, uint32_t ttlS, uint32_t nowMs);
+
+/* Next instance to resolve, NULL if none */
+const char *appDiscUnresolved(const appDisc_t *disc);
+
+/* The instance could not be resolved */
+void appDiscDrop(appDisc_t *disc, const char *label);
+
+/* All instances are in: schedules the next browse, a failed browse passes ok false */
+void appDiscEnd(appDisc_t *disc, bool ok, uint32_t nowMs);
+
+/* True once the next browse is due */
+bool appDiscDue(const appDisc_t *disc, uint32_t nowMs);
+
+/* The current server if it is still listed and usable, NULL otherwise */
+const appDiscServer_t *appDiscCurrent(const appDisc_t *disc, uint32_t nowMs);
+
+/* Picks a server by priority and weight and makes it current, NULL if none is usable */
+const appDiscServer_t *appDiscSelect(appDisc_t *disc, uint32_t nowMs);
+
+/* The current server failed, the next appDiscSelect() skips it */
+void appDiscFail(appDisc_t *disc, uint32_t nowMs);
+
+#endif /* APP_DISC_H_ */
@@ -0,0 +1,229 @@
+/*
+ * app_i2c.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: edward62740
+ */
+
+#include <string.h>
+#include "em_core.h"
+#include "em_i2c.h"
+#include "sl_i2cspm.h"
+#include "sl_i2cspm_opt_config.h"
+#include "sl_power_manager.h"
+#include "sl_sleeptimer.h"
+#include "app_i2c.h"
+
+#define APP_I2C_BUS SL_I2CSPM_OPT_PERIPHERAL
+
+/* Flags the emlib master state machine advances on */
+#define APP_I2C_IEN (I2C_IEN_ACK | I2C_IEN_NACK | I2C_IEN_RXDATAV | I2C_IEN_MSTOP | I2C_IEN_ARBLOST | I2C_IEN_BUSERR)
+
+typedef struct
+{
+    uint8_t addr;
+    uint8_t wr[APP_I2C_MAX_WRITE];
+    uint8_t wrLen;
+    uint8_t *rd;
+    uint8_t rdLen;
+    appI2cCallback_t cb;
+    void *ctx;
+} appI2cXfer_t;
+
+static appI2cXfer_t appI2cQueue[APP_I2C_QUEUE_LEN];
+static uint8_t appI2cHead;
+static uint8_t appI2cCount;
+static bool appI2cBusy; // EM1 requirement held
+
+static I2C_TransferSeq_TypeDef appI2cSeq;
+static uint32_t appI2cStartTick;
+static sl_sleeptimer_timer_handle_t appI2cTimeoutTimer;
+
+static appI2cStats_t appI2cStats;
+static uint32_t appI2cBusTicks;
+static uint32_t appI2cAwakeCycles;
+
+static void appI2cTimeoutCb(sl_sleeptimer_timer_handle_t *handle, void *data);
+
+/* Interrupts masked. Pops the head transaction and runs its callback */
+static void appI2cComplete(I2C_TransferReturn_TypeDef status)
+{
+    appI2cXfer_t done = appI2cQueue[appI2cHead];
+
+    appI2cBusTicks += sl_sleeptimer_get_tick_count() - appI2cStartTick;
+    appI2cStats.transfers++;
+    if (status != i2cTransferDone) appI2cStats.failed++;
+
+    appI2cHead = (appI2cHead + 1) % APP_I2C_QUEUE_LEN;
+    appI2cCount--;
+
+    if (done.cb) done.cb(status, done.ctx);
+}
+
+/* Interrupts masked. Starts the head transaction, or releases EM1 when the queue drained */
+static void appI2cRun(void)
+{
+    while (appI2cCount > 0)
+    {
+        appI2cXfer_t *x = &appI2cQueue[appI2cHead];
+
+        appI2cSeq.addr = x->addr << 1;
+        if (x->rdLen == 0)
+        {
+            appI2cSeq.flags = I2C_FLAG_WRITE;
+            appI2cSeq.buf[0].data = x->wr;
+            appI2cSeq.buf[0].len = x->wrLen;
+        }
+        else if (x->wrLen == 0)
+        {
+            appI2cSeq.flags = I2C_FLAG_READ;
+            appI2cSeq.buf[0].data = x->rd;
+            appI2cSeq.buf[0].len = x->rdLen;
+        }
+        else
+        {
+            appI2cSeq.flags = I2C_FLAG_WRITE_READ;
+            appI2cSeq.buf[0].data = x->wr;
+            appI2cSeq.buf[0].len = x->wrLen;
+            appI2cSeq.buf[1].data = x->rd;
+            appI2cSeq.buf[1].len = x->rdLen;
+        }
+
+        appI2cStartTick = sl_sleeptimer_get_tick_count();
+        I2C_TransferReturn_TypeDef status = I2C_TransferInit(APP_I2C_BUS, &appI2cSeq);
+        if (status == i2cTransferInProgress)
+        {
+            I2C_IntClear(APP_I2C_BUS, APP_I2C_IEN);
+            I2C_IntEnable(APP_I2C_BUS, APP_I2C_IEN);
+            sl_sleeptimer_start_timer_ms(&appI2cTimeoutTimer, APP_I2C_TIMEOUT_MS, appI2cTimeoutCb, NULL, 0, 0);
+            return;
+        }
+        appI2cComplete(status);
+    }
+
+    if (appI2cBusy)
+    {
+        appI2cBusy = false;
+        sl_power_manager_remove_em_requirement(SL_POWER_MANAGER_EM1);
+    }
+}
+
+static void appI2cTimeoutCb(sl_sleeptimer_timer_handle_t *handle, void *data)
+{
+    (void) handle;
+    (void) data;
+
+    CORE_DECLARE_IRQ_STATE;
+    CORE_ENTER_ATOMIC();
+    if (appI2cCount > 0)
+    {
+        I2C_IntDisable(APP_I2C_BUS, APP_I2C_IEN);
+        APP_I2C_BUS->CMD = I2C_CMD_ABORT;
+        appI2cComplete(i2cTransferBusErr);
+        appI2cRun();
+    }
+    CORE_EXIT_ATOMIC();
+}
+
+void I2C0_IRQHandler(void)
+{
+    const uint32_t cycles_begin = DWT->CYCCNT;
+
+    CORE_DECLARE_IRQ_STATE;
+    CORE_ENTER_ATOMIC();
+    I2C_TransferReturn_TypeDef status = I2C_Transfer(APP_I2C_BUS);
+    if (status != i2cTransferInProgress && appI2cCount > 0)
+    {
+        I2C_IntDisable(APP_I2C_BUS, APP_I2C_IEN);
+        sl_sleeptimer_stop_timer(&appI2cTimeoutTimer);
+        appI2cComplete(status);
+        appI2cRun();
+    }
+    appI2cAwakeCycles += DWT->CYCCNT - cycles_begin;
+    CORE_EXIT_ATOMIC();
+}
+
+void appI2cInit(void)
+{
+    // Cycle counter for the awake time
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    I2C_IntDisable(APP_I2C_BUS, _I2C_IEN_MASK);
+    NVIC_ClearPendingIRQ(I2C0_IRQn);
+    NVIC_EnableIRQ(I2C0_IRQn);
+}
+
+bool appI2cSubmit(uint8_t addr, const uint8_t *wr, uint8_t wrLen, uint8_t *rd, uint8_t rdLen,
+                  appI2cCallback_t cb, void *ctx)
+{
+    if (wrLen > APP_I2C_MAX_WRITE || (wrLen == 0 && rdLen == 0) || (rdLen > 0 && rd == NULL)) return false;
+
+    const uint32_t cycles_begin = DWT->CYCCNT;
+    bool queued = false;
+
+    CORE_DECLARE_IRQ_STATE;
+    CORE_ENTER_ATOMIC();
+    if (appI2cCount < APP_I2C_QUEUE_LEN)
+    {
+        appI2cXfer_t *x = &appI2cQueue[(appI2cHead + appI2cCount) % APP_I2C_QUEUE_LEN];
+        x->addr = addr;
+        memcpy(x->wr, wr, wrLen);
+        x->wrLen = wrLen;
+        x->rd = rd;
+        x->rdLen = rdLen;
+        x->cb = cb;
+        x->ctx = ctx;
+        appI2cCount++;
+        if (appI2cCount > appI2cStats.queuePeak) appI2cStats.queuePeak = appI2cCount;
+        queued = true;
+
+        if (!appI2cBusy)
+        {
+            appI2cBusy = true;
+            sl_power_manager_add_em_requirement(SL_POWER_MANAGER_EM1);
+            appI2cRun();
+        }
+    }
+    else
+    {
+        appI2cStats.dropped++;
+    }
+    // Inside the critical section, I2C0_IRQHandler() adds to it as well
+    appI2cAwakeCycles += DWT->CYCCNT - cycles_begin;
+    CORE_EXIT_ATOMIC();
+    return queued;
+}
+
+static void appI2cSyncDone(I2C_TransferReturn_TypeDef status, void *ctx)
+{
+    *(volatile I2C_TransferReturn_TypeDef *) ctx = status;
+}
+
+I2C_TransferReturn_TypeDef appI2cTransferSync(uint8_t addr, const uint8_t *wr, uint8_t wrLen,
+                                              uint8_t *rd, uint8_t rdLen)
+{
+    volatile I2C_TransferReturn_TypeDef status = i2cTransferInProgress;
+
+    if (!appI2cSubmit(addr, wr, wrLen, rd, rdLen, appI2cSyncDone, (void *) &status)) return i2cTransferUsageFault;
+    while (status == i2cTransferInProgress)
+    {
+        sl_power_manager_sleep();
+    }
+    return status;
+}
+
+bool appI2cIdle(void)
+{
+    return appI2cCount == 0;
+}
+
+void appI2cGetStats(appI2cStats_t *stats)
+{
+    CORE_DECLARE_IRQ_STATE;
+    CORE_ENTER_ATOMIC();
+    *stats = appI2cStats;
+    stats->busUs = (uint32_t) (((uint64_t) appI2cBusTicks * 1000000) / sl_sleeptimer_get_timer_frequency());
+    stats->awakeUs = (uint32_t) (((uint64_t) appI2cAwakeCycles * 1000000) / SystemCoreClockGet());
+    CORE_EXIT_ATOMIC();
+}
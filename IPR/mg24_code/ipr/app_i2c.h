@@ -0,0 +1,60 @@
+/*
+ * app_i2c.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: edward62740
+ */
+
+#ifndef APP_I2C_H_
+#define APP_I2C_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "em_i2c.h"
+
+/* Interrupt-driven I2C transaction queue for the on-board sensor bus
+ * (SL_I2CSPM_OPT_PERIPHERAL, I2C0).
+ *
+ * Transactions are copied into a fixed ring and run one after the other by the
+ * emlib I2C_Transfer() state machine from I2C0_IRQHandler(), so the core only
+ * wakes for bus events. An EM1 requirement is held while the queue is not empty,
+ * which lets the main loop keep calling sl_power_manager_sleep() during transfers.
+ * Each transaction is bounded by a one-shot sleeptimer timeout.
+ *
+ * Completion callbacks run in interrupt context with interrupts masked: keep
+ * them short (copy, set a flag). They may submit further transactions. */
+
+#ifndef APP_I2C_QUEUE_LEN
+#define APP_I2C_QUEUE_LEN  8
+#endif
+#define APP_I2C_MAX_WRITE  4   // register address + up to 3 data bytes, copied on submit
+#define APP_I2C_TIMEOUT_MS 20  // per transaction, the bus is aborted after this
+
+typedef void (*appI2cCallback_t)(I2C_TransferReturn_TypeDef status, void *ctx);
+
+typedef struct
+{
+    uint32_t transfers; // completed transactions, including failed ones
+    uint32_t failed;    // NACK, bus error, arbitration lost or timeout
+    uint32_t dropped;   // submits rejected because the queue was full
+    uint32_t busUs;     // start to completion, summed over transactions
+    uint32_t awakeUs;   // CPU time spent starting transactions and in the IRQ handler
+    uint8_t queuePeak;  // high-water mark of queued transactions
+} appI2cStats_t;
+
+void appI2cInit(void);
+
+/* Queues a write (rdLen 0), read (wrLen 0) or write-then-read transaction to the
+ * 7-bit address addr. wr is copied, rd must stay valid until cb runs. cb may be NULL.
+ * Returns false if the queue is full or the lengths are invalid. */
+bool appI2cSubmit(uint8_t addr, const uint8_t *wr, uint8_t wrLen, uint8_t *rd, uint8_t rdLen,
+                  appI2cCallback_t cb, void *ctx);
+
+/* Submits and sleeps until the transaction completes. Main loop only. */
+I2C_TransferReturn_TypeDef appI2cTransferSync(uint8_t addr, const uint8_t *wr, uint8_t wrLen,
+                                              uint8_t *rd, uint8_t rdLen);
+
+bool appI2cIdle(void);
+void appI2cGetStats(appI2cStats_t *stats);
+
+#endif /* APP_I2C_H_ */
@@ -0,0 +1,129 @@
+/*
+ * app_link.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: edward62740
+ */
+
+#include <string.h>
+#include "app_link.h"
+
+void appLinkInit(appLink_t *link, uint32_t nowMs, uint32_t polls)
+{
+    memset(link, 0, sizeof(*link));
+    link->requested = APP_LINK_DEFAULT_MODE;
+    link->cslPeriodMs = APP_LINK_CSL_PERIOD_MS;
+    link->lastMs = link->sinceMs = nowMs;
+    link->lastPolls = polls;
+}
+
+bool appLinkRequest(appLink_t *link, appLinkMode_t mode, uint32_t cslPeriodMs, uint8_t cslChannel)
+{
+    if (mode == APP_LINK_CSL && (cslPeriodMs < APP_LINK_CSL_PERIOD_MIN_MS || cslPeriodMs > APP_LINK_CSL_PERIOD_MAX_MS))
+    {
+        return false;
+    }
+    if (mode == APP_LINK_CSL)
+    {
+        // A new period or channel is applied from scratch
+        if (cslPeriodMs != link->cslPeriodMs || cslChannel != link->cslChannel) link->csl = APP_LINK_CSL_OFF;
+        link->cslPeriodMs = cslPeriodMs;
+        link->cslChannel = cslChannel;
+    }
+    link->requested = mode;
+    return true;
+}
+
+appLinkMode_t appLinkActive(const appLink_t *link)
+{
+    return link->csl == APP_LINK_CSL_ACTIVE ? APP_LINK_CSL : APP_LINK_POLL;
+}
+
+static void appLinkAccount(appLink_t *link, uint32_t nowMs, uint32_t polls)
+{
+    appLinkModeStats_t *s = &link->mode[appLinkActive(link)];
+    uint32_t ms = nowMs - link->lastMs;
+
+    s->polls += polls - link->lastPolls;
+    link->carryMs += ms;
+    s->timeS += link->carryMs / 1000;
+    link->carryMs %= 1000;
+    if (appLinkActive(link) == APP_LINK_CSL)
+    {
+        link->sampleCarryMs += ms;
+        s->samples += link->sampleCarryMs / link->cslPeriodMs;
+        link->sampleCarryMs %= link->cslPeriodMs;
+    }
+    link->lastMs = nowMs;
+    link->lastPolls = polls;
+}
+
+static void appLinkEnter(appLink_t *link, appLinkCslState_t state, uint32_t nowMs)
+{
+    link->csl = state;
+    link->sinceMs = nowMs;
+}
+
+appLinkAction_t appLinkUpdate(appLink_t *link, uint32_t nowMs, bool attached, bool cslEnabled, uint32_t polls)
+{
+    appLinkAccount(link, nowMs, polls);
+
+    if (link->requested == APP_LINK_POLL)
+    {
+        if (link->csl == APP_LINK_CSL_OFF) return APP_LINK_NONE;
+        appLinkEnter(link, APP_LINK_CSL_OFF, nowMs);
+        return APP_LINK_APPLY_POLL;
+    }
+
+    switch (link->csl)
+    {
+    case APP_LINK_CSL_OFF:
+        if (!attached) return APP_LINK_NONE;
+        appLinkEnter(link, APP_LINK_CSL_PENDING, nowMs);
+        return APP_LINK_APPLY_CSL;
+
+    case APP_LINK_CSL_PENDING:
+        if (cslEnabled)
+        {
+            appLinkEnter(link, APP_LINK_CSL_ACTIVE, nowMs);
+            link->enables++;
+        }
+        else if (!attached)
+        {
+            appLinkEnter(link, APP_LINK_CSL_OFF, nowMs);
+        }
+        else if (nowMs - link->sinceMs >= APP_LINK_CSL_CONFIRM_MS)
+        {
+            appLinkEnter(link, APP_LINK_CSL_UNSUPPORTED, nowMs);
+            link->fallbacks++;
+            return APP_LINK_APPLY_POLL;
+        }
+        return APP_LINK_NONE;
+
+    case APP_LINK_CSL_ACTIVE:
+        if (cslEnabled) return APP_LINK_NONE;
+        // Detached or a parent without CSL: poll until it is sorted out
+        appLinkEnter(link, attached ? APP_LINK_CSL_UNSUPPORTED : APP_LINK_CSL_OFF, nowMs);
+        if (attached) link->fallbacks++;
+        return APP_LINK_APPLY_POLL;
+
+    case APP_LINK_CSL_UNSUPPORTED:
+    default:
+        if (!attached) appLinkEnter(link, APP_LINK_CSL_OFF, nowMs);
+        return APP_LINK_NONE;
+    }
+}
+
+void appLinkRtt(appLink_t *link, uint32_t rttMs)
+{
+    appLinkModeStats_t *s = &link->mode[appLinkActive(link)];
+    s->rttCount++;
+    s->rttSumMs += rttMs;
+    if (rttMs > s->rttMaxMs) s->rttMaxMs = rttMs;
+}
+
+float appLinkCurrentUa(const appLinkModeStats_t *stats)
+{
+    if (stats->timeS == 0) return 0.0f;
+    return (stats->polls * APP_LINK_POLL_CHARGE_UC + stats->samples * APP_LINK_SAMPLE_CHARGE_UC) / stats->timeS;
+}
@@ -0,0 +1,111 @@
+/*
+ * app_link.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: edward62740
+ */
+
+#ifndef APP_LINK_H_
+#define APP_LINK_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Downlink mode of the sleepy end device. Hardware free, shared with the host
+ * (../host/poll_sim.c); app_main.c applies the decisions to OpenThread.
+ *
+ * APP_LINK_POLL: the child polls its parent, see app_poll.h.
+ * APP_LINK_CSL: coordinated sampled listening (Thread 1.2). The child opens a
+ * short receive window every cslPeriodMs and the parent sends to it in that
+ * window, so the downlink latency is at most one period without a poll each
+ * time. The parent has to support it: a CSL request that OpenThread has not
+ * enabled within APP_LINK_CSL_CONFIRM_MS of attaching falls back to polling
+ * until the next attach, which may be to another parent.
+ *
+ * Per mode the time, data polls, CSL sample windows and exchange RTTs are
+ * counted, so the two can be compared on the same node. The charge constants
+ * are the model shared with poll_sim. */
+
+#define APP_LINK_CSL_PERIOD_MS      500
+#define APP_LINK_CSL_PERIOD_MIN_MS  50
+#define APP_LINK_CSL_PERIOD_MAX_MS  10000  // 16 bit count of 10 symbols (160 us)
+#define APP_LINK_CSL_TIMEOUT_S      100    // OPENTHREAD_CONFIG_CSL_TIMEOUT
+#define APP_LINK_CSL_KEEPALIVE_MS   30000  // poll period while CSL carries the downlink
+#define APP_LINK_CSL_CONFIRM_MS     15000
+#define APP_LINK_TEN_SYMBOLS_US     160
+
+#define APP_LINK_POLL_CHARGE_UC     20.0f  // data request at +10 dBm, MAC ack and receive window
+#define APP_LINK_SAMPLE_CHARGE_UC   8.0f   // CSL receive window incl. radio ramp-up
+#define APP_LINK_FRAME_CHARGE_UC    6.0f   // receiving a frame
+
+#ifndef APP_LINK_DEFAULT_MODE
+#define APP_LINK_DEFAULT_MODE       APP_LINK_POLL
+#endif
+
+typedef enum
+{
+    APP_LINK_POLL = 0,
+    APP_LINK_CSL,
+} appLinkMode_t;
+
+typedef enum
+{
+    APP_LINK_CSL_OFF = 0,
+    APP_LINK_CSL_PENDING,     // requested from OpenThread, waiting for the parent
+    APP_LINK_CSL_ACTIVE,
+    APP_LINK_CSL_UNSUPPORTED, // parent without CSL, polling until the next attach
+} appLinkCslState_t;
+
+typedef enum
+{
+    APP_LINK_NONE = 0,
+    APP_LINK_APPLY_CSL,       // set the CSL channel, timeout and period
+    APP_LINK_APPLY_POLL,      // clear the CSL period, back to the poll period
+} appLinkAction_t;
+
+typedef struct
+{
+    uint32_t timeS;
+    uint32_t polls;
+    uint32_t samples;         // CSL receive windows, from the period
+    uint32_t rttCount;
+    uint32_t rttSumMs;
+    uint32_t rttMaxMs;
+} appLinkModeStats_t;
+
+typedef struct
+{
+    appLinkMode_t requested;
+    uint32_t cslPeriodMs;
+    uint8_t cslChannel;       // 0: the operating channel
+    appLinkCslState_t csl;
+    uint32_t sinceMs;         // entry into the current CSL state
+    uint32_t lastMs;          // last accounting
+    uint32_t lastPolls;
+    uint32_t carryMs;         // time not yet counted into timeS
+    uint32_t sampleCarryMs;   // and into samples
+    uint32_t enables;
+    uint32_t fallbacks;
+    appLinkModeStats_t mode[2];
+} appLink_t;
+
+void appLinkInit(appLink_t *link, uint32_t nowMs, uint32_t polls);
+
+/* Selects the mode; false if the period is out of range */
+bool appLinkRequest(appLink_t *link, appLinkMode_t mode, uint32_t cslPeriodMs, uint8_t cslChannel);
+
+/* Steps the CSL state with what OpenThread reports and accounts the time since
+ * the last call to the mode in effect. polls is the data poll counter
+ * (otMacCounters::mTxDataPoll) */
+appLinkAction_t appLinkUpdate(appLink_t *link, uint32_t nowMs, bool attached, bool cslEnabled, uint32_t polls);
+
+/* Mode carrying the downlink now */
+appLinkMode_t appLinkActive(const appLink_t *link);
+
+/* RTT of one confirmable exchange, counted to the active mode */
+void appLinkRtt(appLink_t *link, uint32_t rttMs);
+
+/* Average radio current of polls and CSL windows in a mode, frames excluded */
+float appLinkCurrentUa(const appLinkModeStats_t *stats);
+
+#endif /* APP_LINK_H_ */
@@ -13,6 +13,7 @@
 #include <openthread/diag.h>
 #include <openthread/tasklet.h>
 #include <openthread/thread.h>
+#include <openthread/link.h>
 #include <openthread/srp_client.h>
 #include <openthread/srp_client_buffers.h>
 
@@ -26,9 +27,13 @@
 #include "stdio.h"
 #include "string.h"
 #include "app_main.h"
+#include "sl_sleeptimer.h"
 
 static otInstance* sInstance = NULL;
-#define SLEEPY_POLL_PERIOD_MS 5000
+
+/* Adaptive poll period (app_poll.h) and downlink mode (app_link.h), kept across sleepyInit() on reattach */
+appPoll_t sleepyPoll;
+appLink_t sleepyLink;
 
 static bool srpDone = false;
 
@@ -104,7 +109,7 @@ void sleepyInit(void)
     otError error;
 
     otLinkModeConfig config;
-    error = otLinkSetPollPeriod(otGetInstance(), SLEEPY_POLL_PERIOD_MS);
+    error = otLinkSetPollPeriod(otGetInstance(), sleepyPoll.periodMs);
 
     config.mRxOnWhenIdle = false;
     config.mDeviceType   = 0;
@@ -118,6 +123,81 @@ void sleepyInit(void)
 
 }
 
+static uint32_t sleepyNowMs(void)
+{
+    return (uint32_t) (sl_sleeptimer_get_tick_count64() * 1000 / sl_sleeptimer_get_timer_frequency());
+}
+
+void sleepyPollProcess(void)
+{
+    // While CSL carries the downlink the poll period only keeps the parent link alive
+    if (appPollUpdate(&sleepyPoll, sleepyNowMs()) && otGetInstance() != NULL
+            && appLinkActive(&sleepyLink) == APP_LINK_POLL)
+    {
+        otLinkSetPollPeriod(otGetInstance(), sleepyPoll.periodMs);
+    }
+}
+
+void sleepyLinkProcess(void)
+{
+    otInstance *instance = otGetInstance();
+    if (instance == NULL) return;
+
+    bool attached = otThreadGetDeviceRole(instance) == OT_DEVICE_ROLE_CHILD;
+    switch (appLinkUpdate(&sleepyLink, sleepyNowMs(), attached, otLinkIsCslEnabled(instance),
+                          otLinkGetCounters(instance)->mTxDataPoll))
+    {
+    case APP_LINK_APPLY_CSL:
+        otLinkCslSetChannel(instance, sleepyLink.cslChannel);
+        otLinkCslSetTimeout(instance, APP_LINK_CSL_TIMEOUT_S);
+        otLinkCslSetPeriod(instance, (uint16_t) (sleepyLink.cslPeriodMs * 1000 / APP_LINK_TEN_SYMBOLS_US));
+        otLinkSetPollPeriod(instance, APP_LINK_CSL_KEEPALIVE_MS);
+        break;
+    case APP_LINK_APPLY_POLL:
+        otLinkCslSetPeriod(instance, 0);
+        otLinkSetPollPeriod(instance, sleepyPoll.periodMs);
+        break;
+    default:
+        break;
+    }
+}
+
+bool sleepySetLinkMode(appLinkMode_t mode, uint32_t cslPeriodMs, uint8_t cslChannel)
+{
+    if (!appLinkRequest(&sleepyLink, mode, cslPeriodMs, cslChannel)) return false;
+    sleepyLinkProcess();
+    return true;
+}
+
+void sleepySetPollScale(uint8_t scale)
+{
+    appPollSetScale(&sleepyPoll, scale);
+    sleepyPollProcess();
+}
+
+void sleepyLinkRtt(uint32_t rttMs)
+{
+    appLinkRtt(&sleepyLink, rttMs);
+}
+
+void sleepyPollExchange(bool outstanding, uint32_t rttMs)
+{
+    if (rttMs) appPollSetRtt(&sleepyPoll, rttMs);
+    appPollExchange(&sleepyPoll, outstanding, sleepyNowMs());
+    sleepyPollProcess();
+}
+
+void sleepyPollServer(void)
+{
+    appPollServer(&sleepyPoll, sleepyNowMs());
+    sleepyPollProcess();
+}
+
+void appSrpInstanceName(char *buf, size_t size)
+{
+    snprintf(buf, size, "ipv6bc%d", (uint8_t)(SYSTEM_GetUnique() & 0xFF));
+}
+
 void appSrpInit(void)
 {
     if(srpDone) return;
@@ -143,7 +223,7 @@ void appSrpInit(void)
 
     entry->mService.mPort = 33434;
     char INST_NAME[32];
-    snprintf(INST_NAME, 32, "ipv6bc%d", (uint8_t)(SYSTEM_GetUnique() & 0xFF));
+    appSrpInstanceName(INST_NAME, sizeof(INST_NAME));
     char *SERV_NAME = "_ot._udp";
     string = otSrpClientBuffersGetServiceEntryInstanceNameString(entry, &size);
     memcpy(string, INST_NAME, size);
@@ -166,11 +246,17 @@ void appSrpInit(void)
 
 void app_init(void)
 {
+    appPollInit(&sleepyPoll, sleepyNowMs());
+    appLinkInit(&sleepyLink, sleepyNowMs(), otLinkGetCounters(sInstance)->mTxDataPoll);
     sleepyInit();
     setNetworkConfiguration();
     assert(otIp6SetEnabled(sInstance, true) == OT_ERROR_NONE);
     assert(otThreadSetEnabled(sInstance, true) == OT_ERROR_NONE);
+    appCoapQueueInit((uint32_t) SYSTEM_GetUnique()); // once, the queue outlives reattaches
+    appCoapRecoverInit((uint32_t) (SYSTEM_GetUnique() >> 32));
     appCoapInit();
+    appCoapBindingRestore(); // reports can go out as soon as the node is attached
+    appCoapDiscoverInit((uint32_t) SYSTEM_GetUnique() ^ 0x5bd1e995u);
     appSrpInit();
 }
 
@@ -181,6 +267,10 @@ void app_process_action(void)
 {
     otTaskletsProcess(sInstance);
     otSysProcessDrivers(sInstance);
+    sleepyPollProcess();
+    sleepyLinkProcess();
+    appCoapCheckConnection();
+    appCoapDiscoverProcess();
 }
 
 bool efr32AllowSleepCallback(void)
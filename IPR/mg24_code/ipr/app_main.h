@@ -20,6 +20,8 @@
 #include "em_gpio.h"
 #include "openthread-system.h"
 #include "em_gpio.h"
+#include "app_poll.h"
+#include "app_link.h"
 
 #define A111_MOSI_PORT   gpioPortB
 #define A111_MOSI_PIN    2
@@ -58,5 +60,19 @@ void app_process_action(void);
 otInstance *otGetInstance(void);
 void setNetworkConfiguration(void);
 void sleepyInit(void);
+void sleepySetPollScale(uint8_t scale);
+/* Poll period events, see app_poll.h. rttMs 0 keeps the current estimate */
+void sleepyPollExchange(bool outstanding, uint32_t rttMs);
+void sleepyPollServer(void);
+void sleepyPollProcess(void);
+extern appPoll_t sleepyPoll;
+/* Downlink mode, see app_link.h. false if the CSL period is out of range */
+bool sleepySetLinkMode(appLinkMode_t mode, uint32_t cslPeriodMs, uint8_t cslChannel);
+void sleepyLinkProcess(void);
+void sleepyLinkRtt(uint32_t rttMs);
+extern appLink_t sleepyLink;
 void appSrpInit(void);
+/* SRP service instance name of this node, also sent when registering with a discovered server */
+void appSrpInstanceName(char *buf, size_t size);
+
 #endif
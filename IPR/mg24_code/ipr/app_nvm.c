@@ -0,0 +1,34 @@
+/*
+ * app_nvm.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: edward62740
+ */
+
+#include "nvm3.h"
+#include "nvm3_default.h"
+#include "app_nvm.h"
+
+/* Objects are only accepted if their stored size matches, so a layout change
+ * simply invalidates the old record. */
+bool appNvmRead(uint32_t key, void *buf, size_t len)
+{
+    uint32_t type;
+    size_t size;
+
+    if (nvm3_getObjectInfo(nvm3_defaultHandle, key, &type, &size) != ECODE_NVM3_OK) return false;
+    if (type != NVM3_OBJECTTYPE_DATA || size != len) return false;
+    return nvm3_readData(nvm3_defaultHandle, key, buf, len) == ECODE_NVM3_OK;
+}
+
+bool appNvmWrite(uint32_t key, const void *buf, size_t len)
+{
+    Ecode_t err = nvm3_writeData(nvm3_defaultHandle, key, buf, len);
+    if (nvm3_repackNeeded(nvm3_defaultHandle)) nvm3_repack(nvm3_defaultHandle);
+    return err == ECODE_NVM3_OK;
+}
+
+void appNvmErase(uint32_t key)
+{
+    nvm3_deleteObject(nvm3_defaultHandle, key);
+}
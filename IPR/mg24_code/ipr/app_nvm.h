@@ -0,0 +1,30 @@
+/*
+ * app_nvm.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: edward62740
+ */
+
+#ifndef APP_NVM_H_
+#define APP_NVM_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Application NVM3 objects, in the user key domain (OpenThread settings use 0x20000+) */
+#define APP_NVM_KEY_RADAR_CALIB  0x0100
+#define APP_NVM_KEY_COAP_BINDING 0x0101
+#define APP_NVM_KEY_BATT_USED    0x0102
+#define APP_NVM_KEY_TRACE        0x1000 // to 0x1000 + APP_NVM_TRACE_BLOCKS - 1
+
+/* Full trace blocks (trace_rec.h), about a day of frames. Together with the
+ * other objects they need the larger NVM3 instance and cache in
+ * config/nvm3_default_config.h */
+#define APP_NVM_TRACE_BLOCKS     1024
+
+bool appNvmRead(uint32_t key, void *buf, size_t len);
+bool appNvmWrite(uint32_t key, const void *buf, size_t len);
+void appNvmErase(uint32_t key);
+
+#endif /* APP_NVM_H_ */
@@ -0,0 +1,103 @@
+/*
+ * app_payload.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: edward62740
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+#include "app_payload.h"
+
+static uint8_t *appPayloadPut(uint8_t *p, uint64_t v, size_t n)
+{
+    for (size_t i = 0; i < n; i++) *p++ = (uint8_t) (v >> (8 * i));
+    return p;
+}
+
+static uint64_t appPayloadGet(const uint8_t **p, size_t n)
+{
+    uint64_t v = 0;
+    for (size_t i = 0; i < n; i++) v |= (uint64_t) (*p)[i] << (8 * i);
+    *p += n;
+    return v;
+}
+
+static uint16_t appPayloadSat16(uint32_t v)
+{
+    return v > UINT16_MAX ? UINT16_MAX : (uint16_t) v;
+}
+
+size_t appPayloadEncode(const appPayload_t *p, uint8_t *buf, size_t len)
+{
+    size_t size = p->kind == APP_PAYLOAD_ALIVE ? APP_PAYLOAD_ALIVE_SIZE : APP_PAYLOAD_STATE_SIZE;
+    if (len < size) return 0;
+
+    uint8_t *w = buf;
+    w = appPayloadPut(w, APP_PAYLOAD_VERSION, 1);
+    w = appPayloadPut(w, (uint8_t) p->kind, 1);
+    w = appPayloadPut(w, p->deviceType, 1);
+    w = appPayloadPut(w, p->eui64, 8);
+    w = appPayloadPut(w, appPayloadSat16(p->score), 2);
+    w = appPayloadPut(w, appPayloadSat16(p->distance), 2);
+    w = appPayloadPut(w, p->lux, 4);
+    w = appPayloadPut(w, appPayloadSat16(p->vddMv), 2);
+    w = appPayloadPut(w, appPayloadSat16(p->eolDays), 2);
+    w = appPayloadPut(w, (uint8_t) p->rssi, 1);
+    w = appPayloadPut(w, p->txCtr, 4);
+    if (p->kind == APP_PAYLOAD_ALIVE)
+    {
+        w = appPayloadPut(w, appPayloadSat16(p->arenaPeak), 2);
+        w = appPayloadPut(w, appPayloadSat16(p->arenaFailed), 2);
+        w = appPayloadPut(w, p->arenaFragPct, 1);
+        w = appPayloadPut(w, p->soc, 1);
+        w = appPayloadPut(w, p->battLevel, 1);
+    }
+    return (size_t) (w - buf);
+}
+
+bool appPayloadDecode(const uint8_t *buf, size_t len, appPayload_t *p)
+{
+    const uint8_t *r = buf;
+    if (len < APP_PAYLOAD_STATE_SIZE || buf[0] != APP_PAYLOAD_VERSION) return false;
+
+    memset(p, 0, sizeof(*p));
+    r++;
+    p->kind = (appPayloadKind_t) appPayloadGet(&r, 1);
+    if (p->kind > APP_PAYLOAD_ACTIVE) return false;
+    if (p->kind == APP_PAYLOAD_ALIVE && len < APP_PAYLOAD_ALIVE_SIZE) return false;
+    p->deviceType = (uint8_t) appPayloadGet(&r, 1);
+    p->eui64 = appPayloadGet(&r, 8);
+    p->score = (uint32_t) appPayloadGet(&r, 2);
+    p->distance = (uint32_t) appPayloadGet(&r, 2);
+    p->lux = (uint32_t) appPayloadGet(&r, 4);
+    p->vddMv = (uint32_t) appPayloadGet(&r, 2);
+    p->eolDays = (uint32_t) appPayloadGet(&r, 2);
+    p->rssi = (int8_t) appPayloadGet(&r, 1);
+    p->txCtr = (uint32_t) appPayloadGet(&r, 4);
+    if (p->kind == APP_PAYLOAD_ALIVE)
+    {
+        p->arenaPeak = (uint32_t) appPayloadGet(&r, 2);
+        p->arenaFailed = (uint32_t) appPayloadGet(&r, 2);
+        p->arenaFragPct = (uint8_t) appPayloadGet(&r, 1);
+        p->soc = (uint8_t) appPayloadGet(&r, 1);
+        p->battLevel = (uint8_t) appPayloadGet(&r, 1);
+    }
+    return true;
+}
+
+int appPayloadFormatCsv(const appPayload_t *p, char *buf, size_t len)
+{
+    uint32_t euiH = (uint32_t) (p->eui64 >> 32), euiL = (uint32_t) p->eui64;
+    int state = p->kind == APP_PAYLOAD_ALIVE ? -1 : p->kind == APP_PAYLOAD_ACTIVE;
+
+    if (p->kind != APP_PAYLOAD_ALIVE)
+    {
+        return snprintf(buf, len, "%d,%" PRIx32 "%" PRIx32 ",%d,%" PRIu32 ",%" PRIu32 ",%" PRIu32 ",%" PRIu32 ",%d,%" PRIu32,
+                        p->deviceType, euiH, euiL, state, p->score, p->distance, p->lux, p->eolDays, p->rssi, p->txCtr);
+    }
+    return snprintf(buf, len, "%d,%" PRIx32 "%" PRIx32 ",%d,%" PRIu32 ",%" PRIu32 ",%" PRIu32 ",%" PRIu32 ",%d,%" PRIu32 ",%" PRIu32 ",%" PRIu32 ",%u,%u,%u",
+                    p->deviceType, euiH, euiL, state, p->score, p->distance, p->lux, p->eolDays, p->rssi, p->txCtr,
+                    p->arenaPeak, p->arenaFailed, p->arenaFragPct, p->soc, p->battLevel);
+}
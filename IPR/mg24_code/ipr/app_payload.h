@@ -0,0 +1,91 @@
+/*
+ * app_payload.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: edward62740
+ */
+
+#ifndef APP_PAYLOAD_H_
+#define APP_PAYLOAD_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* State and alive report payloads. Hardware free, shared with the host decoder
+ * (../host/payload_decode.c).
+ *
+ * Two encodings of the same fields:
+ * - text: the original comma separated string, see appPayloadFormatCsv()
+ * - binary: fixed layout below, sent with Content-Format APP_PAYLOAD_CONTENT_FORMAT
+ * The server picks one with an Accept option on its permissions request, see
+ * appCoapPermissionsHandler(). Without one the node keeps sending text.
+ *
+ * Binary layout, version 1 (little endian):
+ *     u8  version    APP_PAYLOAD_VERSION
+ *     u8  kind       appPayloadKind_t
+ *     u8  deviceType
+ *     u64 eui64
+ *     u16 score      presence score * 1000, saturating
+ *     u16 distance   presence distance [mm], saturating
+ *     u32 lux        opt3001_lux()
+ *     u16 vddMv      supply voltage
+ *     u16 eolDays    predicted battery life left, saturating
+ *     i8  rssi       last RSSI from the parent
+ *     u32 txCtr      total CoAP transmissions
+ * followed for APP_PAYLOAD_ALIVE only by
+ *     u16 arenaPeak  RSS arena high-water mark [bytes], saturating
+ *     u16 arenaFailed
+ *     u8  arenaFragPct
+ *     u8  soc        battery state of charge [%]
+ *     u8  battLevel  low-battery throttle level
+ *
+ * Fields are only ever appended. A decoder accepts a longer payload of the same
+ * version and ignores the tail; any other change bumps the version. At 28 and 35
+ * bytes both kinds fit one 127 byte 802.15.4 frame together with the MAC, mesh,
+ * UDP and CoAP headers. The text payloads (60-90 bytes) do not. */
+
+#define APP_PAYLOAD_VERSION          1
+#define APP_PAYLOAD_CONTENT_FORMAT   65000 // experimental use range (RFC 7252, 12.3)
+#define APP_PAYLOAD_STATE_SIZE       28
+#define APP_PAYLOAD_ALIVE_SIZE       35
+#define APP_PAYLOAD_MAX_SIZE         APP_PAYLOAD_ALIVE_SIZE
+
+typedef enum
+{
+    APP_PAYLOAD_ALIVE = 0,    // text state field -1, "don't care"
+    APP_PAYLOAD_INACTIVE,
+    APP_PAYLOAD_ACTIVE,
+} appPayloadKind_t;
+
+typedef struct
+{
+    appPayloadKind_t kind;
+    uint8_t deviceType;
+    uint64_t eui64;
+    uint32_t score;       // presence score * 1000
+    uint32_t distance;    // presence distance [mm]
+    uint32_t lux;
+    uint32_t vddMv;
+    uint32_t eolDays;
+    int8_t rssi;
+    uint32_t txCtr;
+
+    /* APP_PAYLOAD_ALIVE only */
+    uint32_t arenaPeak;
+    uint32_t arenaFailed;
+    uint8_t arenaFragPct;
+    uint8_t soc;
+    uint8_t battLevel;
+} appPayload_t;
+
+/* Binary encoding into buf, returns the length or 0 if len is too small */
+size_t appPayloadEncode(const appPayload_t *p, uint8_t *buf, size_t len);
+
+/* Decodes a binary payload, false on an unknown version or a short payload */
+bool appPayloadDecode(const uint8_t *buf, size_t len, appPayload_t *p);
+
+/* Text encoding, snprintf semantics. vddMv is not part of the text payload */
+int appPayloadFormatCsv(const appPayload_t *p, char *buf, size_t len);
+
+#endif /* APP_PAYLOAD_H_ */
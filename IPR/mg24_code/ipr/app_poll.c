@@ -0,0 +1,93 @@
+/*
+ * app_poll.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: edward62740
+ */
+
+#include <string.h>
+#include "app_poll.h"
+
+void appPollInit(appPoll_t *poll, uint32_t nowMs)
+{
+    memset(poll, 0, sizeof(*poll));
+    poll->scale = 1;
+    poll->periodMs = APP_POLL_IDLE_MIN_MS;
+    poll->stepMs = nowMs + APP_POLL_IDLE_MIN_MS * APP_POLL_BACKOFF_POLLS;
+}
+
+void appPollSetScale(appPoll_t *poll, uint8_t scale)
+{
+    poll->scale = scale ? scale : 1;
+}
+
+void appPollSetRtt(appPoll_t *poll, uint32_t rttMs)
+{
+    poll->rttMs = rttMs;
+}
+
+void appPollExchange(appPoll_t *poll, bool outstanding, uint32_t nowMs)
+{
+    if (outstanding && !poll->outstanding)
+    {
+        poll->exchangeUntilMs = nowMs + APP_POLL_EXCHANGE_MS;
+        poll->stats.exchanges++;
+    }
+    poll->outstanding = outstanding;
+}
+
+void appPollServer(appPoll_t *poll, uint32_t nowMs)
+{
+    poll->lingerUntilMs = nowMs + APP_POLL_LINGER_MS;
+    poll->stats.serverRequests++;
+}
+
+static uint32_t appPollFastMs(const appPoll_t *poll)
+{
+    if (poll->rttMs == 0) return APP_POLL_FAST_MS;
+    uint32_t ms = poll->rttMs / 2;
+    if (ms < APP_POLL_FAST_MIN_MS) return APP_POLL_FAST_MIN_MS;
+    if (ms > APP_POLL_FAST_MAX_MS) return APP_POLL_FAST_MAX_MS;
+    return ms;
+}
+
+bool appPollUpdate(appPoll_t *poll, uint32_t nowMs)
+{
+    uint32_t idleMax = APP_POLL_IDLE_MAX_MS * poll->scale;
+    bool fast = (poll->outstanding && (int32_t) (poll->exchangeUntilMs - nowMs) > 0)
+            || (int32_t) (poll->lingerUntilMs - nowMs) > 0;
+    uint32_t period = poll->periodMs;
+
+    if (fast)
+    {
+        if (!poll->fast)
+        {
+            poll->fastSinceMs = nowMs;
+            poll->stats.fastEnters++;
+        }
+        period = appPollFastMs(poll);
+    }
+    else if (poll->fast)
+    {
+        // Traffic just ended, more may follow: restart the backoff
+        poll->stats.fastMs += nowMs - poll->fastSinceMs;
+        period = APP_POLL_IDLE_MIN_MS;
+        poll->stepMs = nowMs + period * APP_POLL_BACKOFF_POLLS;
+    }
+    else
+    {
+        while ((int32_t) (nowMs - poll->stepMs) >= 0 && period < idleMax)
+        {
+            period = period * 2 < idleMax ? period * 2 : idleMax;
+            poll->stepMs += period * APP_POLL_BACKOFF_POLLS;
+            poll->stats.backoffs++;
+        }
+        if (period > idleMax) period = idleMax; // throttle level went down
+    }
+    poll->fast = fast;
+
+    if (period == poll->periodMs) return false;
+    poll->periodMs = period;
+    poll->stats.changes++;
+    return true;
+}
@@ -0,0 +1,81 @@
+/*
+ * app_poll.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: edward62740
+ */
+
+#ifndef APP_POLL_H_
+#define APP_POLL_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Data poll period of the sleepy end device. Hardware free, shared with the host
+ * (../host/poll_sim.c); app_main.c applies the period with otLinkSetPollPeriod().
+ *
+ * A parent holds downlink frames until the child polls, so the poll period is
+ * the downlink latency. Instead of the former fixed 5 s period:
+ * - fast, from the RTT estimate, while a confirmable exchange of ours waits for
+ *   its response (at most APP_POLL_EXCHANGE_MS per exchange, OpenThread's own
+ *   retransmissions cover the rest), and for APP_POLL_LINGER_MS after each
+ *   request from the server, which tends to come in transactions (permissions
+ *   then policy, Block2 trace reads, diag polling);
+ * - otherwise backing off from APP_POLL_IDLE_MIN_MS, doubling every
+ *   APP_POLL_BACKOFF_POLLS polls up to APP_POLL_IDLE_MAX_MS times the battery
+ *   throttle scale.
+ * Every poll wakes the main loop, so appPollUpdate() runs at least once per period. */
+
+#define APP_POLL_FAST_MS       250   // waiting for a response, before there is an RTT estimate
+#define APP_POLL_FAST_MIN_MS   100
+#define APP_POLL_FAST_MAX_MS   1000
+#define APP_POLL_EXCHANGE_MS   3000  // CoAP ACK_TIMEOUT * ACK_RANDOM_FACTOR
+#define APP_POLL_LINGER_MS     3000
+#define APP_POLL_IDLE_MIN_MS   1000
+#ifndef APP_POLL_IDLE_MAX_MS
+#define APP_POLL_IDLE_MAX_MS   5000  // the former fixed period, 10000 halves the polls at up to 10 s request latency
+#endif
+#define APP_POLL_BACKOFF_POLLS 2
+
+typedef struct
+{
+    uint32_t changes;        // poll period updates
+    uint32_t fastEnters;
+    uint32_t backoffs;       // idle period doublings
+    uint32_t exchanges;      // confirmable exchanges seen
+    uint32_t serverRequests;
+    uint32_t fastMs;         // time spent polling fast, up to the last exit
+} appPollStats_t;
+
+typedef struct
+{
+    uint32_t periodMs;       // current, as last applied
+    uint8_t scale;           // battery throttle, see appBattScale()
+    uint32_t rttMs;          // smoothed exchange RTT, 0 if unknown
+    bool outstanding;
+    bool fast;
+    uint32_t exchangeUntilMs;
+    uint32_t lingerUntilMs;
+    uint32_t stepMs;         // next idle backoff step
+    uint32_t fastSinceMs;
+    appPollStats_t stats;
+} appPoll_t;
+
+/* Starts in the idle backoff, the server's first requests follow a join */
+void appPollInit(appPoll_t *poll, uint32_t nowMs);
+
+void appPollSetScale(appPoll_t *poll, uint8_t scale);
+
+/* Smoothed RTT of our confirmable exchanges, sets the fast period to half of it */
+void appPollSetRtt(appPoll_t *poll, uint32_t rttMs);
+
+/* A confirmable exchange of ours is (still) waiting for its response */
+void appPollExchange(appPoll_t *poll, bool outstanding, uint32_t nowMs);
+
+/* A request from the server arrived */
+void appPollServer(appPoll_t *poll, uint32_t nowMs);
+
+/* Re-evaluates the period, true if periodMs changed */
+bool appPollUpdate(appPoll_t *poll, uint32_t nowMs);
+
+#endif /* APP_POLL_H_ */
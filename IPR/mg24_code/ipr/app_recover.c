@@ -0,0 +1,120 @@
+/*
+ * app_recover.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: edward62740
+ */
+
+#include <string.h>
+#include "app_recover.h"
+
+void appRecoverInit(appRecover_t *rec, uint32_t seed, uint32_t fleetNodes)
+{
+    memset(rec, 0, sizeof(*rec));
+    rec->seed = seed;
+    rec->spreadMs = fleetNodes * APP_RECOVER_RESET_SLOT_MS;
+}
+
+static uint32_t appRecoverRand(appRecover_t *rec)
+{
+    rec->seed = rec->seed * 1664525u + 1013904223u;
+    return rec->seed >> 8;
+}
+
+/* ms stretched by 0-50%, so that nodes that lost the parent together part ways */
+static uint32_t appRecoverJitter(appRecover_t *rec, uint32_t ms)
+{
+    return ms + appRecoverRand(rec) % (ms / 2 + 1);
+}
+
+/* A reset somewhere in the fleet's window, searches go on until then */
+static void appRecoverScheduleReset(appRecover_t *rec, uint32_t nowMs)
+{
+    rec->resetPending = true;
+    rec->resetDueMs = nowMs + appRecoverRand(rec) % (rec->spreadMs + 1);
+}
+
+static void appRecoverRecord(appRecover_t *rec, uint32_t nowMs)
+{
+    appRecoverStats_t *s = &rec->stats[rec->stage];
+    rec->lastMs = nowMs - rec->lostMs;
+    s->recovered++;
+    s->sumMs += rec->lastMs;
+    if (rec->lastMs > s->maxMs) s->maxMs = rec->lastMs;
+}
+
+appRecoverAction_t appRecoverUpdate(appRecover_t *rec, bool attached, bool heard, uint32_t nowMs)
+{
+    if (attached)
+    {
+        if (rec->stage != APP_RECOVER_IDLE) appRecoverRecord(rec, nowMs);
+        rec->stage = APP_RECOVER_IDLE;
+        rec->resetPending = false;
+        return APP_RECOVER_NONE;
+    }
+
+    if (rec->stage == APP_RECOVER_IDLE)
+    {
+        rec->stage = APP_RECOVER_WAIT;
+        rec->lostMs = rec->lastResetMs = nowMs;
+        rec->searchMs = nowMs + APP_RECOVER_GRACE_MS;
+        rec->heard = false;
+        rec->fails = 0;
+        rec->resetMs = APP_RECOVER_RESET_MIN_MS;
+        return APP_RECOVER_NONE;
+    }
+    rec->heard |= heard;
+
+    if (rec->resetPending && (int32_t) (nowMs - rec->resetDueMs) >= 0)
+    {
+        rec->resetPending = false;
+        rec->stage = APP_RECOVER_RESET;
+        rec->lastResetMs = nowMs;
+        rec->fails = 0;
+        rec->heard = false;
+        rec->searchMs = nowMs + appRecoverJitter(rec, APP_RECOVER_SEARCH_MS);
+        rec->resets++;
+        return APP_RECOVER_DO_RESET;
+    }
+    if ((int32_t) (nowMs - rec->searchMs) < 0) return APP_RECOVER_NONE;
+
+    // The last search got answers and still no attach: the stack, not the parents
+    if (rec->stage >= APP_RECOVER_SEARCH && rec->heard && rec->fails < UINT8_MAX) rec->fails++;
+    rec->heard = false;
+    rec->searchMs = nowMs + appRecoverJitter(rec, APP_RECOVER_SEARCH_MS);
+
+    if (rec->stage == APP_RECOVER_SEARCH && rec->fails >= APP_RECOVER_FAILS)
+    {
+        rec->stage = APP_RECOVER_REATTACH;
+        rec->fails = 0;
+        rec->reattaches++;
+        return APP_RECOVER_DO_REATTACH;
+    }
+    if (!rec->resetPending)
+    {
+        uint32_t sinceReset = nowMs - rec->lastResetMs;
+        bool stuck = rec->stage >= APP_RECOVER_REATTACH && rec->fails >= APP_RECOVER_FAILS
+                && (rec->stage != APP_RECOVER_RESET || sinceReset >= rec->resetMs);
+        if (stuck || sinceReset >= APP_RECOVER_DEAF_MS)
+        {
+            if (rec->stage == APP_RECOVER_RESET)
+            {
+                rec->resetMs = rec->resetMs * 2 < APP_RECOVER_RESET_MAX_MS ? rec->resetMs * 2 : APP_RECOVER_RESET_MAX_MS;
+            }
+            appRecoverScheduleReset(rec, nowMs);
+        }
+    }
+
+    if (rec->stage == APP_RECOVER_WAIT) rec->stage = APP_RECOVER_SEARCH;
+    rec->searches++;
+    return APP_RECOVER_DO_SEARCH;
+}
+
+uint32_t appRecoverWaitMs(const appRecover_t *rec, uint32_t nowMs)
+{
+    if (rec->stage == APP_RECOVER_IDLE) return UINT32_MAX;
+    uint32_t next = rec->searchMs;
+    if (rec->resetPending && (int32_t) (rec->resetDueMs - next) < 0) next = rec->resetDueMs;
+    int32_t left = (int32_t) (next - nowMs);
+    return left > 0 ? (uint32_t) left : 0;
+}
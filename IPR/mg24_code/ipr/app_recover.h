@@ -0,0 +1,106 @@
+/*
+ * app_recover.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: edward62740
+ */
+
+#ifndef APP_RECOVER_H_
+#define APP_RECOVER_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Staged recovery of a lost parent. Hardware free, shared with the host
+ * (../host/recover_sim.c); app_coap.c carries out the actions.
+ *
+ * A lost parent is searched for, and only a stack that hears its neighbours
+ * but still does not attach is restarted:
+ * - APP_RECOVER_WAIT: OpenThread reattaches on its own after a lost parent or a
+ *   partition change, nothing is done for APP_RECOVER_GRACE_MS;
+ * - APP_RECOVER_SEARCH: a parent search (MLE Parent Request) every
+ *   APP_RECOVER_SEARCH_MS, which the old parent answers with a child update if
+ *   it is still there. OpenThread's own attach backoff grows to minutes while
+ *   the parents are down, the searches find them soon after they are back;
+ * - APP_RECOVER_REATTACH: MLE restarted from the stored dataset, after
+ *   APP_RECOVER_FAILS searches that heard frames for us and still did not attach;
+ * - APP_RECOVER_RESET: the whole stack restarted after as many such searches
+ *   more. The first reset is spread at random over APP_RECOVER_RESET_SLOT_MS per
+ *   node of the fleet, further ones wait at least twice as long as the last.
+ * A search that hears nothing means the parents are down: the node keeps
+ * searching, which is what it would do after a reset as well. Only after
+ * APP_RECOVER_DEAF_MS without hearing anything is a reset scheduled, in case
+ * the radio itself is stuck, spread the same way. So a border router restart
+ * costs searches and no reset, however long it takes.
+ * CoAP, its resources, the report queue and the server address are kept
+ * through all of them. The search period is stretched by a random 0-50% per
+ * node. The time from the loss to the next attach is counted to the stage that
+ * was reached. */
+
+#define APP_RECOVER_GRACE_MS      10000
+#define APP_RECOVER_SEARCH_MS     15000
+#define APP_RECOVER_FAILS         3       // heard but unattached searches per escalation
+#define APP_RECOVER_RESET_SLOT_MS 500     // first reset spread per fleet node
+#define APP_RECOVER_RESET_MIN_MS  300000  // between resets, doubling
+#define APP_RECOVER_RESET_MAX_MS  3600000
+#define APP_RECOVER_DEAF_MS       3600000
+#ifndef APP_RECOVER_FLEET_NODES
+#define APP_RECOVER_FLEET_NODES   64      // nodes that may lose their parents together
+#endif
+
+typedef enum
+{
+    APP_RECOVER_IDLE = 0,
+    APP_RECOVER_WAIT,
+    APP_RECOVER_SEARCH,
+    APP_RECOVER_REATTACH,
+    APP_RECOVER_RESET,
+    APP_RECOVER_STAGES,
+} appRecoverStage_t;
+
+typedef enum
+{
+    APP_RECOVER_NONE = 0,
+    APP_RECOVER_DO_SEARCH,    // otThreadBecomeChild()
+    APP_RECOVER_DO_REATTACH,  // Thread disabled and enabled again
+    APP_RECOVER_DO_RESET,     // IPv6 and Thread restarted with the dataset reapplied
+} appRecoverAction_t;
+
+typedef struct
+{
+    uint32_t recovered;       // episodes that ended in this stage
+    uint32_t sumMs;           // their time to recover
+    uint32_t maxMs;
+} appRecoverStats_t;
+
+typedef struct
+{
+    appRecoverStage_t stage;
+    uint32_t lostMs;
+    uint32_t searchMs;        // next parent search, the end of the grace period in WAIT
+    bool heard;               // frames for us since the last search
+    uint8_t fails;            // heard but unattached searches in this stage
+    bool resetPending;
+    uint32_t resetDueMs;
+    uint32_t lastResetMs;     // or the loss, for the deaf radio fallback
+    uint32_t resetMs;         // current minimum between resets
+    uint32_t spreadMs;        // first reset window, from the fleet size
+    uint32_t lastMs;          // time to recover of the last episode
+    uint32_t searches;        // actions taken, since boot
+    uint32_t reattaches;
+    uint32_t resets;
+    uint32_t seed;
+    appRecoverStats_t stats[APP_RECOVER_STAGES]; // WAIT onwards
+} appRecover_t;
+
+/* fleetNodes sets the window the first reset is spread over */
+void appRecoverInit(appRecover_t *rec, uint32_t seed, uint32_t fleetNodes);
+
+/* Steps with the current attach state, returns what to do now. heard: frames
+ * addressed to us were received since the last call (MLE responses) */
+appRecoverAction_t appRecoverUpdate(appRecover_t *rec, bool attached, bool heard, uint32_t nowMs);
+
+/* Time until the next search or reset, UINT32_MAX if attached */
+uint32_t appRecoverWaitMs(const appRecover_t *rec, uint32_t nowMs);
+
+#endif /* APP_RECOVER_H_ */
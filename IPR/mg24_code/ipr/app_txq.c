@@ -0,0 +1,184 @@
+/*
+ * app_txq.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: edward62740
+ */
+
+#include <string.h>
+#include "app_txq.h"
+
+void appTxqInit(appTxq_t *q, uint32_t seed)
+{
+    memset(q, 0, sizeof(*q));
+    q->seed = seed;
+}
+
+static void appTxqRemove(appTxq_t *q, uint8_t i)
+{
+    if (i == 0) q->inFlight = false;
+    memmove(&q->msg[i], &q->msg[i + 1], (size_t) (q->count - i - 1) * sizeof(q->msg[0]));
+    q->count--;
+}
+
+/* First message with this key from msg[first] on, or -1 */
+static int appTxqFind(const appTxq_t *q, uint8_t key, uint8_t first)
+{
+    if (key == APP_TXQ_KEY_NONE) return -1;
+    for (uint8_t i = first; i < q->count; i++)
+    {
+        if (q->msg[i].key == key) return i;
+    }
+    return -1;
+}
+
+bool appTxqPush(appTxq_t *q, const uint8_t *buf, uint16_t len, uint32_t contentFormat, uint8_t key, uint32_t nowMs)
+{
+    if (len > APP_TXQ_MAX_LEN)
+    {
+        q->stats.dropped++;
+        return false;
+    }
+    q->stats.pushed++;
+
+    // A coalesced message keeps its place and due time, the new content starts
+    // over with its attempts
+    appTxqMsg_t *m;
+    int i = appTxqFind(q, key, q->inFlight ? 1 : 0);
+    if (i >= 0)
+    {
+        m = &q->msg[i];
+        m->tries = 0;
+        q->stats.coalesced++;
+    }
+    else
+    {
+        if (q->count == APP_TXQ_SLOTS)
+        {
+            appTxqRemove(q, q->inFlight ? 1 : 0);
+            q->stats.dropped++;
+        }
+        m = &q->msg[q->count++];
+        m->tries = 0;
+        m->seq = 0;
+        m->dueMs = nowMs;
+    }
+    memcpy(m->buf, buf, len);
+    m->len = len;
+    m->contentFormat = contentFormat;
+    m->key = key;
+    m->queuedMs = nowMs;
+    return true;
+}
+
+const appTxqMsg_t *appTxqNext(appTxq_t *q, uint32_t nowMs)
+{
+    if (q->inFlight)
+    {
+        if (nowMs - q->msg[0].sentMs < APP_TXQ_LOST_MS) return NULL;
+        appTxqFail(q, q->msg[0].seq, nowMs);
+    }
+    if (q->count == 0 || (int32_t) (q->msg[0].dueMs - nowMs) > 0) return NULL;
+
+    appTxqMsg_t *m = &q->msg[0];
+    if (m->tries) q->stats.retries++;
+    m->seq = ++q->seq;
+    m->sentMs = nowMs;
+    q->inFlight = true;
+    return m;
+}
+
+void appTxqAck(appTxq_t *q, uint16_t seq, uint32_t nowMs)
+{
+    if (!q->inFlight || q->msg[0].seq != seq) return;
+
+    appTxqStats_t *s = &q->stats;
+    const appTxqMsg_t *m = &q->msg[0];
+    uint32_t rtt = nowMs - m->sentMs;
+    s->rttLastMs = rtt;
+    if (rtt > s->rttMaxMs) s->rttMaxMs = rtt;
+
+    // Karn: a retried message cannot tell which attempt was answered
+    if (m->tries == 0)
+    {
+        if (s->rttSamples++ == 0)
+        {
+            s->srttMs = rtt;
+            s->rttvarMs = rtt / 2;
+        }
+        else
+        {
+            uint32_t err = rtt > s->srttMs ? rtt - s->srttMs : s->srttMs - rtt;
+            s->rttvarMs = (3 * s->rttvarMs + err) / 4;
+            s->srttMs = (7 * s->srttMs + rtt) / 8;
+        }
+    }
+    uint32_t latency = nowMs - m->queuedMs;
+    if (latency > s->latencyMaxMs) s->latencyMaxMs = latency;
+    s->acked++;
+    appTxqRemove(q, 0);
+}
+
+void appTxqFail(appTxq_t *q, uint16_t seq, uint32_t nowMs)
+{
+    if (!q->inFlight || q->msg[0].seq != seq) return;
+    q->inFlight = false;
+
+    // The limit is for the failed message itself, not for one that replaces it
+    appTxqMsg_t *m = &q->msg[0];
+    bool last = ++m->tries >= APP_TXQ_MAX_TRIES;
+    if (last) q->stats.failed++;
+
+    // A newer report with the same key goes out in place of the failed one,
+    // with attempts of its own
+    int i = appTxqFind(q, m->key, 1);
+    if (i > 0)
+    {
+        memcpy(m->buf, q->msg[i].buf, q->msg[i].len);
+        m->len = q->msg[i].len;
+        m->contentFormat = q->msg[i].contentFormat;
+        m->queuedMs = q->msg[i].queuedMs;
+        m->tries = 0;
+        appTxqRemove(q, (uint8_t) i);
+        if (!last) q->stats.coalesced++;
+    }
+    else if (last)
+    {
+        appTxqRemove(q, 0);
+        return;
+    }
+
+    uint32_t backoff = APP_TXQ_BACKOFF_MS;
+    if (q->stats.rttSamples && q->stats.srttMs + 4 * q->stats.rttvarMs > backoff)
+    {
+        backoff = q->stats.srttMs + 4 * q->stats.rttvarMs;
+    }
+    for (uint8_t n = 1; n < m->tries && backoff < APP_TXQ_BACKOFF_MAX_MS; n++) backoff *= 2;
+    if (backoff > APP_TXQ_BACKOFF_MAX_MS) backoff = APP_TXQ_BACKOFF_MAX_MS;
+
+    // Up to 25 % jitter so that nodes behind the same border router spread out
+    q->seed = q->seed * 1664525u + 1013904223u;
+    backoff += (q->seed >> 16) % (backoff / 4 + 1);
+    m->dueMs = nowMs + backoff;
+}
+
+uint32_t appTxqWaitMs(const appTxq_t *q, uint32_t nowMs)
+{
+    if (q->count == 0) return UINT32_MAX;
+    if (q->inFlight)
+    {
+        uint32_t age = nowMs - q->msg[0].sentMs;
+        return age < APP_TXQ_LOST_MS ? APP_TXQ_LOST_MS - age : 0;
+    }
+    int32_t wait = (int32_t) (q->msg[0].dueMs - nowMs);
+    return wait > 0 ? (uint32_t) wait : 0;
+}
+
+bool appTxqPending(const appTxq_t *q, uint8_t key)
+{
+    for (uint8_t i = 0; i < q->count; i++)
+    {
+        if (q->msg[i].key == key) return true;
+    }
+    return false;
+}
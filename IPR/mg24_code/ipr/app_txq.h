@@ -0,0 +1,103 @@
+/*
+ * app_txq.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: edward62740
+ */
+
+#ifndef APP_TXQ_H_
+#define APP_TXQ_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Bounded delivery queue for confirmable reports. Hardware free, the CoAP side
+ * lives in app_coap.c (appCoapQueueReport()), the host shim drives the same
+ * queue with a lossy link model (../host/shim/shim_app.c).
+ *
+ * Stop-and-wait: only the head is ever in flight (CoAP NSTART = 1). A failed
+ * exchange - no response within OpenThread's own retransmissions, or the send
+ * call itself failing - is retried with exponential backoff from the RTT
+ * estimate, up to APP_TXQ_MAX_TRIES attempts.
+ *
+ * Messages with the same non-zero key coalesce, the latest wins: a state report
+ * overwrites a queued one that has not been sent yet, and a failed one is not
+ * retried when a newer report is already waiting behind it. New content always
+ * starts over with its own APP_TXQ_MAX_TRIES attempts. A full queue drops its
+ * oldest message that is not in flight.
+ *
+ * The queue is plain RAM owned by the caller and knows nothing about the link,
+ * so it outlives a reattach; the caller only holds it while detached. */
+
+#define APP_TXQ_SLOTS          4
+#define APP_TXQ_MAX_LEN        96     // a text state report is at most 80 bytes
+#define APP_TXQ_BACKOFF_MS     2000   // first retry, or the RTO if that is longer
+#define APP_TXQ_BACKOFF_MAX_MS 64000
+#define APP_TXQ_MAX_TRIES      8      // attempts before a message is dropped
+#define APP_TXQ_LOST_MS        120000 // no result for an attempt: counted as failed (MAX_TRANSMIT_WAIT is 93 s)
+
+#define APP_TXQ_KEY_NONE       0      // never coalesced
+#define APP_TXQ_KEY_STATE      1      // presence state reports
+
+typedef struct
+{
+    uint8_t buf[APP_TXQ_MAX_LEN];
+    uint16_t len;
+    uint32_t contentFormat;
+    uint8_t key;
+    uint8_t tries;     // failed attempts of the current content
+    uint16_t seq;      // of the current attempt, matches results to it
+    uint32_t queuedMs;
+    uint32_t dueMs;    // not sent before
+    uint32_t sentMs;
+} appTxqMsg_t;
+
+typedef struct
+{
+    uint32_t pushed;
+    uint32_t coalesced;    // overwritten or superseded before delivery
+    uint32_t dropped;      // queue full or too long
+    uint32_t failed;       // gave up after APP_TXQ_MAX_TRIES
+    uint32_t acked;
+    uint32_t retries;
+    uint32_t rttLastMs;
+    uint32_t rttMaxMs;
+    uint32_t srttMs;       // smoothed RTT and variation (RFC 6298), first attempts only
+    uint32_t rttvarMs;
+    uint32_t rttSamples;
+    uint32_t latencyMaxMs; // push to ack, including backoff
+} appTxqStats_t;
+
+typedef struct
+{
+    appTxqMsg_t msg[APP_TXQ_SLOTS]; // oldest first, msg[0] is the one in flight
+    uint8_t count;
+    bool inFlight;
+    uint16_t seq;
+    uint32_t seed;                  // backoff jitter
+    appTxqStats_t stats;
+} appTxq_t;
+
+/* seed spreads the retries of different nodes, e.g. from the EUI-64 */
+void appTxqInit(appTxq_t *q, uint32_t seed);
+
+/* Queues a message. Returns false if it was dropped for being too long; a full
+ * queue makes room by dropping the oldest message instead */
+bool appTxqPush(appTxq_t *q, const uint8_t *buf, uint16_t len, uint32_t contentFormat, uint8_t key, uint32_t nowMs);
+
+/* The head if it is due and nothing is in flight, marked as sent at nowMs.
+ * NULL otherwise. An attempt without a result for APP_TXQ_LOST_MS fails here */
+const appTxqMsg_t *appTxqNext(appTxq_t *q, uint32_t nowMs);
+
+/* Result of the attempt seq; results of older attempts are ignored */
+void appTxqAck(appTxq_t *q, uint16_t seq, uint32_t nowMs);
+void appTxqFail(appTxq_t *q, uint16_t seq, uint32_t nowMs);
+
+/* Time until appTxqNext() has something to do, UINT32_MAX if the queue is empty */
+uint32_t appTxqWaitMs(const appTxq_t *q, uint32_t nowMs);
+
+/* True if a message with this key is queued or in flight */
+bool appTxqPending(const appTxq_t *q, uint8_t key);
+
+#endif /* APP_TXQ_H_ */
@@ -4,62 +4,98 @@
  *  Created on: Dec 12, 2022
  *      Author: edward62740
  */
-#include "sl_i2cspm.h"
+#include <string.h>
 #include "sl_sleeptimer.h"
+#include "em_gpio.h"
+#include "gpiointerrupt.h"
+#include "app_main.h"
+#include "app_i2c.h"
 #include "opt3001.h"
 #include "math.h"
 
 #define REG_RESULT                      0x00
 #define REG_CONFIGURATION               0x01
 #define REG_LOWLIMIT                    0x02
+#define REG_HIGHLIMIT                   0x03
+
+// Low limit exponent 11xx puts INT in end-of-conversion mode
+#define LOWLIMIT_EOC                    0xC000
 
 
 static const uint8_t address = 0x44;
 
+/* Cached conversion, refreshed from opt3001_process() */
+typedef enum
+{
+    OPT3001_IDLE,
+    OPT3001_CONVERTING, // single shot running, waiting for INT
+    OPT3001_READING,    // configuration and result reads queued on app_i2c
+    OPT3001_WATCHING,   // continuous conversion, INT fires on the high limit only
+} opt3001_state_t;
+
+static opt3001_state_t state;
+static volatile bool conv_ready;
+static volatile bool read_done;
+static volatile I2C_TransferReturn_TypeDef read_status;
+static uint8_t cfg_buf[2];
+static uint8_t result_buf[2];
+static bool cache_valid;
+static float cache_lux;
+static uint32_t cache_tick;
+static uint32_t trigger_tick;
+static bool wake_enabled;
+static uint16_t wake_limit;
+static bool watch_read;          // the queued read was started from OPT3001_WATCHING
+static bool wake_hint;
+
 uint16_t opt3001_read_reg(uint8_t reg)
 {
     uint8_t data[2];
     memset(data, 0, sizeof(data));
-    I2C_TransferSeq_TypeDef i2cTransfer;
-    I2C_TransferReturn_TypeDef result;
-
-    // Initialize I2C transfer
-    i2cTransfer.addr          = address << 1;
-    i2cTransfer.flags         = I2C_FLAG_WRITE_READ; // must write target address before reading
-    i2cTransfer.buf[0].data   = &reg;
-    i2cTransfer.buf[0].len    = 1;
-    i2cTransfer.buf[1].data   = data;
-    i2cTransfer.buf[1].len    = 2;
 
-    result = I2CSPM_Transfer(I2C0, &i2cTransfer);
+    appI2cTransferSync(address, &reg, 1, data, 2);
 
    return ((uint16_t) data[0] << 8) | data[1];
 }
 
 void opt3001_write_reg(uint8_t reg, uint8_t dataL, uint8_t dataH)
 {
-
     uint8_t txBuffer[3];
-    I2C_TransferSeq_TypeDef i2cTransfer;
-    I2C_TransferReturn_TypeDef result;
 
     txBuffer[0] = reg;
     txBuffer[1] = dataL;
     txBuffer[2] = dataH;
-    // Initialize I2C transfer
-    i2cTransfer.addr = address << 1;
-    i2cTransfer.flags = I2C_FLAG_WRITE;
-    i2cTransfer.buf[0].data = txBuffer;
-    i2cTransfer.buf[0].len = 3;
-    i2cTransfer.buf[1].data = NULL;
-    i2cTransfer.buf[1].len = 0;
 
-    result = I2CSPM_Transfer(I2C0, &i2cTransfer);
+    appI2cTransferSync(address, txBuffer, 3, NULL, 0);
 }
+
+/* INT is open drain, active low. Asserted at the end of every conversion, or on
+ * the high limit while watching */
+static void opt3001_int_callback(uint8_t int_no)
+{
+    (void) int_no;
+    conv_ready = true;
+}
+
+/* app_i2c completion of the result read, interrupt context */
+static void opt3001_read_callback(I2C_TransferReturn_TypeDef status, void *ctx)
+{
+    (void) ctx;
+    read_status = status;
+    read_done = true;
+}
+
 void opt3001_init()
 {
-    opt3001_write_reg(REG_CONFIGURATION, 0b11000110, 0b00000000); //0b1100001000010000
-    opt3001_write_reg(REG_LOWLIMIT, 0b11000000, 0b00000000);
+    // Shut down between single-shot conversions
+    opt3001_write_reg(REG_CONFIGURATION, DEFAULT_CONFIG_SHDWN >> 8, DEFAULT_CONFIG_SHDWN & 0xFF);
+    opt3001_write_reg(REG_LOWLIMIT, LOWLIMIT_EOC >> 8, LOWLIMIT_EOC & 0xFF);
+
+    GPIO_PinModeSet(OPT_INT_PORT, OPT_INT_PIN, gpioModeInputPull, 1);
+    GPIOINT_CallbackRegister(OPT_INT_PIN, opt3001_int_callback);
+    GPIO_ExtIntConfig(OPT_INT_PORT, OPT_INT_PIN, OPT_INT_PIN, false, true, true);
+
+    opt3001_trigger();
 }
 
 void opt3001_deinit(void)
@@ -69,6 +105,157 @@ void opt3001_deinit(void)
 
 }
 
+void opt3001_trigger(void)
+{
+    const uint8_t cfg[3] = { REG_CONFIGURATION, DEFAULT_CONFIG_100_OS >> 8, DEFAULT_CONFIG_100_OS & 0xFF };
+
+    if (state != OPT3001_IDLE) return;
+    conv_ready = false;
+    if (appI2cSubmit(address, cfg, sizeof(cfg), NULL, 0, NULL, NULL))
+    {
+        state = OPT3001_CONVERTING;
+        trigger_tick = sl_sleeptimer_get_tick_count();
+    }
+}
+
+/* Queue the configuration read (releases INT) and the result read behind it */
+static void opt3001_queue_read(void)
+{
+    static const uint8_t reg_cfg = REG_CONFIGURATION;
+    static const uint8_t reg_result = REG_RESULT;
+
+    conv_ready = false;
+    read_done = false;
+    watch_read = state == OPT3001_WATCHING;
+    memset(cfg_buf, 0, sizeof(cfg_buf));
+    if (appI2cSubmit(address, &reg_cfg, 1, cfg_buf, sizeof(cfg_buf), NULL, NULL)
+            && appI2cSubmit(address, &reg_result, 1, result_buf, sizeof(result_buf), opt3001_read_callback, NULL))
+    {
+        state = OPT3001_READING;
+    }
+    else
+    {
+        state = watch_read ? OPT3001_WATCHING : OPT3001_IDLE;
+    }
+}
+
+/* Continuous conversion, latched window comparator on the high limit */
+static void opt3001_watch(void)
+{
+    const uint8_t high[3] = { REG_HIGHLIMIT, wake_limit >> 8, wake_limit & 0xFF };
+    const uint8_t low[3] = { REG_LOWLIMIT, 0, 0 };
+    const uint8_t cfg[3] = { REG_CONFIGURATION, DEFAULT_CONFIG_800 >> 8, DEFAULT_CONFIG_800 & 0xFF };
+
+    conv_ready = false;
+    if (appI2cSubmit(address, high, sizeof(high), NULL, 0, NULL, NULL)
+            && appI2cSubmit(address, low, sizeof(low), NULL, 0, NULL, NULL)
+            && appI2cSubmit(address, cfg, sizeof(cfg), NULL, 0, NULL, NULL))
+    {
+        state = OPT3001_WATCHING;
+    }
+}
+
+/* Back to shutdown and end-of-conversion INT for single shots */
+static void opt3001_unwatch(void)
+{
+    static const uint8_t reg_cfg = REG_CONFIGURATION;
+    const uint8_t cfg[3] = { REG_CONFIGURATION, DEFAULT_CONFIG_SHDWN >> 8, DEFAULT_CONFIG_SHDWN & 0xFF };
+    const uint8_t low[3] = { REG_LOWLIMIT, LOWLIMIT_EOC >> 8, LOWLIMIT_EOC & 0xFF };
+
+    if (appI2cSubmit(address, cfg, sizeof(cfg), NULL, 0, NULL, NULL)
+            && appI2cSubmit(address, low, sizeof(low), NULL, 0, NULL, NULL))
+    {
+        // Release a latched INT so the next end-of-conversion edge is seen
+        appI2cSubmit(address, &reg_cfg, 1, cfg_buf, sizeof(cfg_buf), NULL, NULL);
+        conv_ready = false;
+        state = OPT3001_IDLE;
+    }
+}
+
+void opt3001_process(void)
+{
+    bool cache_old = !cache_valid
+            || sl_sleeptimer_tick_to_ms(sl_sleeptimer_get_tick_count() - cache_tick) >= OPT3001_CACHE_MAX_AGE_MS;
+
+    // Poll once if the end-of-conversion edge never arrived
+    if (state == OPT3001_CONVERTING && !conv_ready
+            && sl_sleeptimer_tick_to_ms(sl_sleeptimer_get_tick_count() - trigger_tick) >= OPT3001_CONV_TIMEOUT_MS)
+    {
+        conv_ready = true;
+    }
+
+    // While watching INT means the high limit was crossed, the cache still ages out as usual
+    if ((state == OPT3001_CONVERTING && conv_ready) || (state == OPT3001_WATCHING && (conv_ready || cache_old)))
+    {
+        opt3001_queue_read();
+    }
+
+    if (state == OPT3001_READING && read_done)
+    {
+        uint16_t cfg = ((uint16_t) cfg_buf[0] << 8) | cfg_buf[1];
+        bool ok = read_status == i2cTransferDone && (watch_read || (cfg & OPT3001_CFG_CRF));
+        state = watch_read ? OPT3001_WATCHING : OPT3001_IDLE;
+        if (ok)
+        {
+            cache_lux = opt3001_conv(((uint16_t) result_buf[0] << 8) | result_buf[1]);
+            cache_tick = sl_sleeptimer_get_tick_count();
+            cache_valid = true;
+            cache_old = false;
+            if (watch_read && (cfg & OPT3001_CFG_FH))
+            {
+                wake_hint = true;
+                wake_enabled = false;
+            }
+        }
+    }
+
+    if (state == OPT3001_IDLE && wake_enabled && cache_valid) opt3001_watch();
+    else if (state == OPT3001_WATCHING && !wake_enabled) opt3001_unwatch();
+
+    if (state == OPT3001_IDLE && cache_old)
+    {
+        opt3001_trigger();
+    }
+}
+
+void opt3001_set_wake(bool enable, float mlux)
+{
+    // Limit register: 12-bit mantissa in 10 mlux steps, shifted by the exponent
+    uint32_t m = (uint32_t) (mlux / 10.0f);
+    uint16_t e = 0;
+    while (m > 0x0FFF && e < 11)
+    {
+        m >>= 1;
+        e++;
+    }
+    if (m > 0x0FFF) m = 0x0FFF;
+    uint16_t limit = (uint16_t) ((e << 12) | m);
+
+    if (state == OPT3001_WATCHING && enable && limit != wake_limit)
+    {
+        const uint8_t high[3] = { REG_HIGHLIMIT, limit >> 8, limit & 0xFF };
+        appI2cSubmit(address, high, sizeof(high), NULL, 0, NULL, NULL);
+    }
+    wake_limit = limit;
+    wake_enabled = enable;
+}
+
+bool opt3001_wake_hint(void)
+{
+    if (!wake_hint) return false;
+    wake_hint = false;
+    return true;
+}
+
+float opt3001_lux(void)
+{
+#if OPT3001_BLOCKING_READ
+    return opt3001_conv(opt3001_read());
+#else
+    return cache_lux;
+#endif
+}
+
 uint16_t opt3001_read(void)
 {
     uint8_t count = 0;
@@ -114,5 +301,3 @@ float opt3001_conv(uint16_t raw)
 
     return m * (10 * exp2(e));
 }
-
-
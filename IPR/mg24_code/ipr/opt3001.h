@@ -8,6 +8,7 @@
 #ifndef OPT3001_H_
 #define OPT3001_H_
 
+#include <stdbool.h>
 #include <stdint.h>
 
 
@@ -45,6 +46,15 @@
     FC1 to FC0  -   Fault count bits. Read/write bits. Default 00 - the first fault will trigger the alert pin.
 */
 
+/* Build switches */
+#ifndef OPT3001_BLOCKING_READ
+#define OPT3001_BLOCKING_READ      0     // opt3001_lux() polls a conversion over I2C instead of returning the cache
+#endif
+#ifndef OPT3001_CACHE_MAX_AGE_MS
+#define OPT3001_CACHE_MAX_AGE_MS   30000 // start a new single-shot conversion once the cached reading is this old
+#endif
+#define OPT3001_CONV_TIMEOUT_MS    250   // 100 ms conversion; read the result anyway if INT has not fired by then
+
 uint16_t opt3001_read_reg(uint8_t reg);
 void opt3001_write_reg(uint8_t reg, uint8_t dataL, uint8_t dataH);
 void opt3001_init();
@@ -53,6 +63,24 @@ float opt3001_conv(uint16_t raw);
 void opt3001_deinit(void);
 int opt3001_is_measuring(void);
 
+/* Interrupt-driven single shot: opt3001_init() starts the first conversion,
+ * opt3001_process() runs from the main loop to collect finished conversions
+ * (OPT_INT, end-of-conversion mode) and start new ones when the cache ages.
+ * These go through the app_i2c queue, appI2cInit() must run first.
+ * opt3001_lux() returns the cached reading without touching the bus. */
+void opt3001_trigger(void);
+void opt3001_process(void);
+float opt3001_lux(void);
+
+/* Light-change wake. While enabled the converter runs continuously (800 ms) in
+ * latched window mode with the high limit at `mlux`, and INT only fires when the
+ * light rises above it. opt3001_process() then refreshes the cache and raises a
+ * hint for opt3001_wake_hint(). A hint disables the wake again; the caller
+ * re-enables it while the cached reading is dark. Costs the continuous
+ * conversion current (~1.8 uA against ~0.3 uA in shutdown) while enabled. */
+void opt3001_set_wake(bool enable, float mlux);
+bool opt3001_wake_hint(void); // true once per light-change event
+
 
 
 #define OPT3001_CFG_FL          (1 << 5)
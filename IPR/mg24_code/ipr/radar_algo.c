@@ -0,0 +1,98 @@
+/*
+ * radar_algo.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: edward62740
+ */
+
+#include <stddef.h>
+#include "radar_algo.h"
+
+void radarAlgoDefaultParams(radarAlgoParams_t *params)
+{
+    params->maxTh = RADAR_APP_DEFAULT_MAX_TH;
+    params->minTh = RADAR_APP_DEFAULT_MIN_TH;
+    params->posTh = RADAR_APP_DEFAULT_POS_TH;
+    params->negTh = RADAR_APP_DEFAULT_NEG_TH;
+    params->thPosRate = RADAR_APP_DEFAULT_TH_POS_RATE;
+    params->thNegRate = RADAR_APP_DEFAULT_TH_NEG_RATE;
+    params->frameSpacingMs = RADAR_APP_DEFAULT_FRAME_SPACING_MS;
+    params->minFrameSpacingMs = RADAR_APP_DEFAULT_MIN_FRAME_SPACING_MS;
+    params->policy = RADAR_APP_DEFAULT_POLICY;
+}
+
+static void radarAlgoReset(radarAlgoState_t *state)
+{
+    state->detectConf = 1;
+    state->hystTrigFlag = state->requireInactivation; // policies start "occupied" if reported active
+    state->dx = 1;
+    state->delayMs = state->params.frameSpacingMs / state->detectConf;
+    state->boostFrames = 0;
+    radarPolicyGet(state->params.policy)->init(state);
+}
+
+void radarAlgoInit(radarAlgoState_t *state, const radarAlgoParams_t *params)
+{
+    if (params != NULL) state->params = *params;
+    else radarAlgoDefaultParams(&state->params);
+    if (state->params.policy >= RADAR_POLICY_COUNT) state->params.policy = RADAR_APP_DEFAULT_POLICY;
+
+    state->sendActive = false;
+    state->sendInactive = false;
+    state->requireInactivation = false;
+    radarAlgoReset(state);
+}
+
+bool radarAlgoStep(radarAlgoState_t *state, bool presenceDetected, float presenceScore)
+{
+    bool changed = radarPolicyGet(state->params.policy)->step(state, presenceDetected, presenceScore);
+    if (state->boostFrames)
+    {
+        state->boostFrames--;
+        if (state->delayMs > state->params.minFrameSpacingMs)
+        {
+            state->delayMs = state->params.minFrameSpacingMs;
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+bool radarAlgoBoost(radarAlgoState_t *state, uint8_t frames)
+{
+    state->boostFrames = frames;
+    if (state->delayMs == state->params.minFrameSpacingMs) return false;
+    state->delayMs = state->params.minFrameSpacingMs;
+    return true;
+}
+
+bool radarAlgoSetPolicy(radarAlgoState_t *state, radarPolicyId_t policy)
+{
+    if (policy >= RADAR_POLICY_COUNT) return false;
+    state->params.policy = policy;
+    radarAlgoReset(state);
+    return true;
+}
+
+bool radarAlgoReportPending(const radarAlgoState_t *state)
+{
+    return state->sendInactive || (state->sendActive && !state->requireInactivation);
+}
+
+radarAlgoReport_t radarAlgoTakeReport(radarAlgoState_t *state)
+{
+    if (state->sendInactive)
+    {
+        state->requireInactivation = false;
+        state->sendActive = false;
+        state->sendInactive = false;
+        return RADAR_ALGO_REPORT_INACTIVE;
+    }
+    if (state->sendActive && !state->requireInactivation)
+    {
+        state->requireInactivation = true;
+        state->sendActive = false;
+        return RADAR_ALGO_REPORT_ACTIVE;
+    }
+    return RADAR_ALGO_REPORT_NONE;
+}
@@ -0,0 +1,134 @@
+/*
+ * radar_algo.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: edward62740
+ */
+
+#ifndef RADAR_ALGO_H_
+#define RADAR_ALGO_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Hardware-free radar application algorithm (hysteresis + adaptive frame spacing).
+ * Shared between the firmware (main.c) and the host replay tools (../host). */
+
+// thresholds are defined as (x units) * 10
+#define RADAR_APP_DEFAULT_MAX_TH               100
+#define RADAR_APP_DEFAULT_MIN_TH               10
+#define RADAR_APP_DEFAULT_POS_TH               80
+#define RADAR_APP_DEFAULT_NEG_TH               20
+#define RADAR_APP_DEFAULT_TH_POS_RATE          20
+#define RADAR_APP_DEFAULT_TH_NEG_RATE          5
+
+#define RADAR_APP_DEFAULT_FRAME_SPACING_MS     3000
+#define RADAR_APP_DEFAULT_MIN_FRAME_SPACING_MS 750
+#define RADAR_APP_DEFAULT_BOOST_FRAMES         6   // frames at the minimum spacing after radarAlgoBoost()
+
+#ifndef RADAR_APP_DEFAULT_POLICY
+#define RADAR_APP_DEFAULT_POLICY               RADAR_POLICY_HYSTERESIS
+#endif
+
+/* Frame-rate policies, see radar_policy.c */
+typedef enum
+{
+    RADAR_POLICY_HYSTERESIS = 0, // confidence hysteresis, spacing = IFD / (detectConf / 10)
+    RADAR_POLICY_BACKOFF,        // same hysteresis, spacing from an exponential backoff table
+    RADAR_POLICY_BAYES,          // log-odds occupancy estimate, spacing from its certainty
+    RADAR_POLICY_COUNT
+} radarPolicyId_t;
+
+typedef struct
+{
+    uint8_t maxTh;
+    uint8_t minTh;
+    uint8_t posTh;
+    uint8_t negTh;
+    uint8_t thPosRate;
+    uint8_t thNegRate;
+    uint32_t frameSpacingMs;
+    uint32_t minFrameSpacingMs;
+    radarPolicyId_t policy;
+} radarAlgoParams_t;
+
+typedef struct
+{
+    radarAlgoParams_t params;
+    uint8_t detectConf;
+    bool hystTrigFlag;
+    float dx;
+    uint32_t delayMs; // current inter-frame delay (BURTC compare value)
+    uint8_t boostFrames; // remaining frames held at the minimum spacing, see radarAlgoBoost()
+
+    /* Policy specific state */
+    union
+    {
+        struct
+        {
+            uint8_t misses; // frames since the last detection
+        } backoff;
+        struct
+        {
+            int16_t logOdds; // occupancy log-odds, RADAR_POLICY_BAYES_LOG_SCALE units
+            bool occupied;
+        } bayes;
+    } ctx;
+
+    /* Pending reports, raised by radarAlgoStep() and consumed by radarAlgoTakeReport() */
+    bool sendActive;
+    bool sendInactive;
+    bool requireInactivation;
+} radarAlgoState_t;
+
+typedef struct
+{
+    const char *name;
+    void (*init)(radarAlgoState_t *state);
+    /* Returns true if state->delayMs was changed */
+    bool (*step)(radarAlgoState_t *state, bool presenceDetected, float presenceScore);
+} radarPolicy_t;
+
+const radarPolicy_t *radarPolicyGet(radarPolicyId_t id);
+bool radarPolicyFind(const char *name, radarPolicyId_t *id);
+
+typedef enum
+{
+    RADAR_ALGO_REPORT_NONE = 0,
+    RADAR_ALGO_REPORT_ACTIVE,
+    RADAR_ALGO_REPORT_INACTIVE,
+} radarAlgoReport_t;
+
+void radarAlgoDefaultParams(radarAlgoParams_t *params);
+void radarAlgoInit(radarAlgoState_t *state, const radarAlgoParams_t *params);
+
+/**
+ * Advance the state machine by one frame with the result of the last measurement.
+ * Returns true if the inter-frame delay (state->delayMs) was changed.
+ */
+bool radarAlgoStep(radarAlgoState_t *state, bool presenceDetected, float presenceScore);
+
+/**
+ * Hold the frame spacing at the minimum for the next `frames` steps, whatever the
+ * policy computes. The confidence is left alone, so a boost only makes a real
+ * detection confirm sooner, it never raises a report by itself.
+ * Returns true if state->delayMs was changed.
+ */
+bool radarAlgoBoost(radarAlgoState_t *state, uint8_t frames);
+
+/**
+ * Switch to another frame-rate policy. The pending/required reports are kept so
+ * that a node currently reported as active can still be reported inactive.
+ */
+bool radarAlgoSetPolicy(radarAlgoState_t *state, radarPolicyId_t policy);
+
+/* True if radarAlgoTakeReport() would return a report */
+bool radarAlgoReportPending(const radarAlgoState_t *state);
+
+/**
+ * Consume a pending state report. Only call when the report can actually be sent,
+ * otherwise leave it pending (same semantics as the radarCoapSend* flags).
+ */
+radarAlgoReport_t radarAlgoTakeReport(radarAlgoState_t *state);
+
+#endif /* RADAR_ALGO_H_ */
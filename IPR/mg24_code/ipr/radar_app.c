@@ -0,0 +1,506 @@
+/*
+ * radar_app.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: edward62740
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <app_main.h>
+#include "em_burtc.h"
+#include "em_gpio.h"
+#include "sl_sleeptimer.h"
+#include "acc_hal_definitions.h"
+#include "acc_hal_integration.h"
+#include "acc_rss.h"
+#include "acc_detector_presence.h"
+#include "app_coap.h"
+#include "opt3001.h"
+#include "app_i2c.h"
+#include "radar_app.h"
+#include "radar_algo.h"
+#include "trace_rec.h"
+#include "radar_evq.h"
+#include "radar_calib.h"
+#include "app_arena.h"
+#include "app_batt.h"
+#include "app_nvm.h"
+#include "radar_night.h"
+#include "app_payload.h"
+#include "app_batch.h"
+#include "app_txq.h"
+
+/* Radar application loop: detector setup, frame scheduling and CoAP reports.
+ * Hardware initialisation and interrupt handlers stay in main.c; this file only
+ * uses the RSS, BURTC/GPIO/sleeptimer and CoAP sender entry points, so it also
+ * builds natively against the host shim (../host/shim). */
+
+/* Radar configuration params */
+#define DEFAULT_START_M             0.2f
+#define DEFAULT_LENGTH_M            1.55f
+#define DEFAULT_UPDATE_RATE         1
+#define DEFAULT_POWER_SAVE_MODE     ACC_POWER_SAVE_MODE_OFF
+#define DEFAULT_DETECTION_THRESHOLD 2.000f
+#define DEFAULT_NBR_REMOVED_PC      1
+#define DEFAULT_SERVICE_PROFILE     4
+#define DEFAULT_SENSOR_ID           1
+
+/* Start the next sweep when get_next returns so it overlaps result processing and
+ * CoAP TX. The result of a frame then comes from the sweep started one frame earlier. */
+#ifndef RADAR_APP_ASYNC_MEASUREMENT
+#define RADAR_APP_ASYNC_MEASUREMENT 0
+#endif
+
+/* Arm the OPT3001 limit interrupt while dark; the light coming on takes a frame
+ * at once and boosts the frame rate, see radarNightLightHint() */
+#ifndef RADAR_APP_LIGHT_HINT
+#define RADAR_APP_LIGHT_HINT 1
+#endif
+
+char tx_buffer[255];
+union {
+    uint64_t _64b;
+    struct {
+        uint32_t l;
+        uint32_t h;
+    } _32b;
+} eui;
+const uint8_t device_type = 0;
+
+static void update_configuration(acc_detector_presence_configuration_t presence_configuration);
+static float radarAppLux(void);
+static void radarAppPayload(appPayload_t *payload, appPayloadKind_t kind);
+static void radarAppSend(const appPayload_t *payload, bool requireAck);
+static void radarAppBatchSample(void);
+static void radarAppBatchSend(void);
+acc_detector_presence_handle_t handle = NULL;
+acc_detector_presence_result_t result;
+
+#define ALIVE_SLEEPTIMER_INTERVAL_MS 60000
+/* Charge used without pack sense is kept in NVM this often, a reset loses at most this much */
+#define RADAR_BATT_SAVE_UAH 2000 // about 13 h at APP_BATT_NOMINAL_UA
+sl_sleeptimer_timer_handle_t alive_timer;
+
+struct
+{
+    uint32_t prev; //unused
+    bool clearToMeasure;
+    uint32_t frameTick; // sleeptimer tick of the last BURTC frame event
+} radarAppVars;
+
+/* Awake window of the last measured frame, see radarAppGetTiming() */
+static radarAppTiming_t radarAppTiming;
+
+radarAlgoState_t radarAlgo;
+radarEvq_t radarEvq;
+
+volatile bool appCoapSendAlive = false;
+volatile uint32_t appCoapSendTxCtr = 0;
+
+appBatt_t radarBatt;
+static appBatch_t radarBatch;
+static uint8_t radarAliveScale = 1;
+static volatile bool radarBattDue = false;
+static uint32_t radarBattSavedUah;
+radarNight_t radarNight;
+
+/* Full trace blocks go to NVM3, the RAM ring only holds the newest ones */
+static bool radarTraceWrite(size_t slot, const uint8_t *blk)
+{
+    return appNvmWrite(APP_NVM_KEY_TRACE + (uint32_t) slot, blk, TRACE_REC_BLOCK_SIZE);
+}
+
+static bool radarTraceRead(size_t slot, uint8_t *blk)
+{
+    return appNvmRead(APP_NVM_KEY_TRACE + (uint32_t) slot, blk, TRACE_REC_BLOCK_SIZE);
+}
+
+static const traceRecStore_t radarTraceStore = {
+    .blocks = APP_NVM_TRACE_BLOCKS,
+    .write = radarTraceWrite,
+    .read = radarTraceRead,
+};
+
+static void alive_cb(sl_sleeptimer_timer_handle_t *handle, void *data)
+{
+    (void) handle;
+    (void) data;
+    appCoapSendAlive = true;
+    radarBattDue = true;
+}
+
+static uint32_t radarAppNowS(void)
+{
+    return (uint32_t) (sl_sleeptimer_get_tick_count64() / sl_sleeptimer_get_timer_frequency());
+}
+
+/* Frame spacing from night mode and the battery level, the BURTC follows if the delay was cut */
+static void radarAppFrameSpacing(void)
+{
+    if (radarNightApply(&radarNight, &radarAlgo, appBattScale(&radarBatt)))
+    {
+        BURTC_CounterReset();
+        BURTC_CompareSet(0, radarAlgo.delayMs);
+    }
+}
+
+/* Stretch frame spacing, alive interval and poll period with the battery level */
+static void radarAppThrottle(uint8_t scale)
+{
+    radarAppFrameSpacing();
+    sl_sleeptimer_stop_timer(&alive_timer);
+    sl_sleeptimer_start_periodic_timer_ms(&alive_timer, ALIVE_SLEEPTIMER_INTERVAL_MS * scale, alive_cb, NULL, 0, 0);
+    radarAliveScale = scale;
+    sleepySetPollScale(scale);
+}
+
+/* Light-change hint from the OPT3001, and (re)arm it while the cached reading is dark */
+static void radarAppLightHint(void)
+{
+#if RADAR_APP_LIGHT_HINT
+    float lux = opt3001_lux() / 1000.0f; // mlux, see opt3001_conv()
+    if (opt3001_wake_hint())
+    {
+        if (radarNightLightHint(&radarNight, &radarAlgo, radarAppNowS(), lux, appBattScale(&radarBatt)))
+        {
+            BURTC_CounterReset();
+            BURTC_CompareSet(0, radarAlgo.delayMs);
+        }
+        // Measure now, the state machine steps on this result at the next compare
+        radarAppVars.frameTick = sl_sleeptimer_get_tick_count();
+        radarAppVars.clearToMeasure = true;
+    }
+    opt3001_set_wake(lux < RADAR_NIGHT_DARK_LUX, RADAR_NIGHT_WAKE_LUX * 1000.0f);
+#endif
+}
+
+/* Once per alive interval: update the estimate from the samples so far, request an idle sample for the next */
+static void radarAppBattUpdate(void)
+{
+    if (!radarBattDue) return;
+    radarBattDue = false;
+
+    if (appBattUpdate(&radarBatt, radarAppNowS())) radarAppThrottle(appBattScale(&radarBatt));
+    vddMonitorRequestIdle();
+
+    uint32_t used = appBattUsedUah(&radarBatt);
+    if (!radarBatt.packSense && used - radarBattSavedUah >= RADAR_BATT_SAVE_UAH)
+    {
+        radarBattSavedUah = used;
+        appNvmWrite(APP_NVM_KEY_BATT_USED, &used, sizeof(used));
+    }
+}
+
+void radarAppBattRestore(bool freshCells)
+{
+    uint32_t used = 0;
+    if (radarBatt.packSense) return;
+    if (freshCells) appNvmWrite(APP_NVM_KEY_BATT_USED, &used, sizeof(used));
+    else if (!appNvmRead(APP_NVM_KEY_BATT_USED, &used, sizeof(used))) used = 0;
+    appBattSetUsed(&radarBatt, used);
+    radarBattSavedUah = used;
+}
+
+void radarAppInit(uint64_t eui64)
+{
+    radarAlgoInit(&radarAlgo, NULL);
+    radarEvqInit(&radarEvq);
+    traceRecInit(&radarTraceStore);
+    appArenaRssInit();
+    appBattInit(&radarBatt, APP_BATT_PACK_SENSE);
+    radarNightInit(&radarNight);
+    appBatchInit(&radarBatch);
+    radarBattDue = true; // first idle sample on the first pass
+    radarAppVars.prev = sl_sleeptimer_get_tick_count();
+    radarAppVars.clearToMeasure = false;
+    eui._64b = eui64;
+    sl_sleeptimer_start_periodic_timer_ms(&alive_timer, ALIVE_SLEEPTIMER_INTERVAL_MS, alive_cb, NULL, 0, 0);
+}
+
+/* Drain BURTC events and step the state machine once per event, as the ISR used to.
+ * While connected, stop at the first pending report so that it is sent before the
+ * next step can raise (and coalesce) the opposite one. */
+static void radarAppStep(void)
+{
+    radarEvt_t evt;
+    while (!(appCoapConnectionEstablished && radarAlgoReportPending(&radarAlgo))
+            && radarEvqPop(&radarEvq, &evt))
+    {
+        if (evt.type != RADAR_EVT_FRAME_DUE) continue;
+        if (radarAlgoStep(&radarAlgo, result.presence_detected, result.presence_score))
+        {
+            BURTC_CounterReset();
+            BURTC_CompareSet(0, radarAlgo.delayMs);
+        }
+        radarAppVars.frameTick = evt.tick;
+        radarAppVars.clearToMeasure = true;
+    }
+}
+
+
+bool radarAppSetPolicy(const char *name)
+{
+    radarPolicyId_t policy;
+    if (!radarPolicyFind(name, &policy)) return false;
+
+    radarAlgoSetPolicy(&radarAlgo, policy);
+    return true;
+}
+
+const char *radarAppGetPolicy(void)
+{
+    return radarPolicyGet(radarAlgo.params.policy)->name;
+}
+
+void initRadar(void)
+{
+
+    const acc_hal_t *hal = acc_hal_integration_get_implementation();
+
+    if (!acc_rss_activate(hal))
+    {
+    }
+
+    /* Reuse the stored calibration if still valid, avoids recalibrating after every reset */
+    radarCalibApply(DEFAULT_SENSOR_ID, vdd_meas);
+
+    acc_detector_presence_configuration_t presence_configuration =
+            acc_detector_presence_configuration_create();
+    if (presence_configuration == NULL)
+    {
+        acc_rss_deactivate();
+    }
+
+    update_configuration(presence_configuration);
+
+    handle = acc_detector_presence_create(presence_configuration);
+    if (handle == NULL)
+    {
+        acc_detector_presence_configuration_destroy(&presence_configuration);
+        acc_rss_deactivate();
+    }
+
+    acc_detector_presence_configuration_destroy(&presence_configuration);
+
+    if (!acc_detector_presence_activate(handle))
+    {
+        acc_detector_presence_destroy(&handle);
+        acc_rss_deactivate();
+    }
+}
+
+/* Application logic to take measurements and send coap packets */
+void radarAppAlgo(void)
+{
+    uint32_t getNextBegin = 0, getNextEnd = 0;
+    bool measured = false;
+
+    radarAppStep();
+    radarAppLightHint();
+    radarAppBattUpdate();
+    if (appCoapConnectionEstablished) appCoapProcessQueue(); // retries of earlier reports
+
+    if (radarAppVars.clearToMeasure)
+    {
+
+        GPIO_PinOutSet(ACT_LED_PORT, ACT_LED_PIN);
+        getNextBegin = sl_sleeptimer_get_tick_count();
+        acc_detector_presence_get_next(handle, &result);
+        getNextEnd = sl_sleeptimer_get_tick_count();
+        GPIO_PinOutClear(ACT_LED_PORT, ACT_LED_PIN);
+        acc_hal_integration_frame_end();
+        measured = true;
+
+        traceRecFrame_t frame = {
+            .detected = result.presence_detected,
+            .score = result.presence_score,
+            .distance = result.presence_distance,
+            .delayMs = radarAlgo.delayMs,
+            .detectConf = radarAlgo.detectConf,
+        };
+        traceRecAppend(sl_sleeptimer_tick_to_ms(radarAppVars.frameTick), &frame);
+
+        // opt3001_lux() is in mlux (opt3001_conv())
+        if (radarNightStep(&radarNight, radarAppNowS(), result.presence_detected, radarAlgo.hystTrigFlag,
+                           opt3001_lux() / 1000.0f))
+        {
+            radarAppFrameSpacing();
+        }
+
+        //print_result(result, radar_trig.ctr);
+        radarAppVars.clearToMeasure = false;
+        if(!appCoapConnectionEstablished) GPIO_PinOutToggle(IP_LED_PORT, IP_LED_PIN);
+    }
+
+    /* Trigger condition logic in radarAppStep() */
+    radarAlgoReport_t report = RADAR_ALGO_REPORT_NONE;
+    if (appCoapConnectionEstablished) report = radarAlgoTakeReport(&radarAlgo);
+
+    if (report != RADAR_ALGO_REPORT_NONE)
+    {
+        appPayload_t payload;
+        radarAppPayload(&payload, report == RADAR_ALGO_REPORT_ACTIVE ? APP_PAYLOAD_ACTIVE : APP_PAYLOAD_INACTIVE);
+        radarAppSend(&payload, true); // send with ack request
+        if (appCoapBatchAlive && radarBatch.count) radarAppBatchSend(); // the radio is awake anyway
+    }
+    else if(appCoapConnectionEstablished && appCoapSendAlive && appCoapBatchAlive)
+    {
+        appCoapSendAlive = false;
+        radarAppBatchSample();
+    }
+    else if(appCoapConnectionEstablished && appCoapSendAlive) // Specifically ELSE to give alive packet lower priority and to prevent successive tx
+    {
+        appCoapSendAlive = false;
+        appPayload_t payload;
+        radarAppPayload(&payload, APP_PAYLOAD_ALIVE);
+        radarAppSend(&payload, false); // send without ack request
+    }
+
+    if (measured)
+    {
+        // In asynchronous mode the next sweep runs during the post-processing window
+        uint32_t end = sl_sleeptimer_get_tick_count();
+        radarAppTiming.getNextUs = (uint32_t) (((uint64_t) (getNextEnd - getNextBegin) * 1000000) / sl_sleeptimer_get_timer_frequency());
+        radarAppTiming.postUs = (uint32_t) (((uint64_t) (end - getNextEnd) * 1000000) / sl_sleeptimer_get_timer_frequency());
+        radarAppTiming.async = RADAR_APP_ASYNC_MEASUREMENT;
+    }
+}
+
+/** CoAP Payload, see app_payload.h for both encodings **
+ * device_type (uint8_t): internal use number for indicating sensor type
+ * eui64 (uint64_t): unique id
+ * kind: radar algo state, or "don't care" (-1 in text) for alive packets
+ * result.presence_score (uint32_t): radar presence score * 1000
+ * result.presence_distance (uint32_t): radar presence distance in mm
+ * opt_buf (uint32_t): light levels
+ * vdd_meas (uint32_t): supply voltage in mV, binary only
+ * radarBatt.eolDays (uint32_t): predicted battery life left in days
+ * rssi (int8_t): last rssi from parent
+ * appCoapSendTxCtr (uint32_t): total CoAP transmissions
+ * Alive packets only:
+ * arena.peak (uint32_t): RSS arena high-water mark in bytes
+ * arena.failed (uint32_t): failed RSS allocations
+ * arena.fragPct (uint8_t): RSS arena free space fragmentation in %
+ * radarBatt.soc (uint8_t): battery state of charge in %
+ * radarBatt.level (uint8_t): low-battery throttle, 0 normal, 1 low (x2), 2 critical (x4)
+ */
+static void radarAppPayload(appPayload_t *payload, appPayloadKind_t kind)
+{
+    int8_t rssi;
+    otThreadGetParentLastRssi(otGetInstance(), &rssi);
+
+    memset(payload, 0, sizeof(*payload));
+    payload->kind = kind;
+    payload->deviceType = device_type;
+    payload->eui64 = eui._64b;
+    payload->score = (uint32_t) (result.presence_score * 1000.0f);
+    payload->distance = (uint32_t) (result.presence_distance * 1000.0f);
+    payload->lux = (uint32_t) radarAppLux();
+    payload->vddMv = vdd_meas;
+    payload->eolDays = radarBatt.eolDays;
+    payload->rssi = rssi;
+    payload->txCtr = ++appCoapSendTxCtr;
+    if (kind == APP_PAYLOAD_ALIVE)
+    {
+        appArenaStats_t arena;
+        appArenaGetStats(&appArenaRss, &arena);
+        payload->arenaPeak = arena.peak;
+        payload->arenaFailed = arena.failed;
+        payload->arenaFragPct = arena.fragPct;
+        payload->soc = radarBatt.soc;
+        payload->battLevel = (uint8_t) radarBatt.level;
+    }
+}
+
+/* Encode in the format the server asked for, see appCoapPermissionsHandler().
+ * Confirmable reports are state changes: queued, retried and coalesced so that
+ * the server always ends up with the latest one, see app_txq.h */
+static void radarAppSend(const appPayload_t *payload, bool requireAck)
+{
+    const uint8_t *buf = (const uint8_t *) tx_buffer;
+    uint16_t len;
+    uint32_t contentFormat = APP_COAP_NO_CONTENT_FORMAT;
+
+    if (appCoapBinaryPayload)
+    {
+        len = (uint16_t) appPayloadEncode(payload, (uint8_t *) tx_buffer, APP_PAYLOAD_MAX_SIZE);
+        contentFormat = APP_PAYLOAD_CONTENT_FORMAT;
+    }
+    else
+    {
+        memset(tx_buffer, 0, 254);
+        appPayloadFormatCsv(payload, tx_buffer, 254);
+        len = (uint16_t) strlen(tx_buffer);
+    }
+
+    if (requireAck) appCoapQueueReport(buf, len, contentFormat, APP_TXQ_KEY_STATE);
+    else appCoapRadarSendPayload(buf, len, contentFormat, false);
+}
+
+/* One alive interval in the batch, sent once full */
+static void radarAppBatchSample(void)
+{
+    appBatchSample_t sample;
+    int8_t rssi;
+    otThreadGetParentLastRssi(otGetInstance(), &rssi);
+
+    sample.score = (uint32_t) (result.presence_score * 1000.0f);
+    sample.lux = (uint32_t) radarAppLux();
+    sample.vddMv = vdd_meas;
+    sample.rssi = rssi;
+    if (appBatchAdd(&radarBatch, &sample, radarAppNowS())) radarAppBatchSend();
+}
+
+/** CoAP Payload, batched alive telemetry, see app_batch.h **/
+static void radarAppBatchSend(void)
+{
+    uint8_t buf[APP_BATCH_HEADER_SIZE + APP_BATCH_MAX_BYTES];
+    appArenaStats_t arena;
+    appArenaGetStats(&appArenaRss, &arena);
+
+    appBatchHeader_t hdr = {
+        .deviceType = device_type,
+        .eui64 = eui._64b,
+        .txCtr = ++appCoapSendTxCtr,
+        .intervalS = (uint16_t) (ALIVE_SLEEPTIMER_INTERVAL_MS / 1000 * radarAliveScale),
+        .eolDays = radarBatt.eolDays > UINT16_MAX ? UINT16_MAX : (uint16_t) radarBatt.eolDays,
+        .soc = radarBatt.soc,
+        .battLevel = (uint8_t) radarBatt.level,
+        .arenaPeak = arena.peak > UINT16_MAX ? UINT16_MAX : (uint16_t) arena.peak,
+        .arenaFailed = arena.failed > UINT16_MAX ? UINT16_MAX : (uint16_t) arena.failed,
+        .arenaFragPct = arena.fragPct,
+    };
+    size_t len = appBatchEncode(&radarBatch, &hdr, radarAppNowS(), buf, sizeof(buf));
+    appCoapRadarSendPayload(buf, (uint16_t) len, APP_BATCH_CONTENT_FORMAT, false); // send without ack request
+    appBatchInit(&radarBatch);
+}
+
+/* Cached OPT3001 reading for a CoAP message, see opt3001_process() */
+static float radarAppLux(void)
+{
+    appI2cStats_t before, after;
+    appI2cGetStats(&before);
+    float lux = opt3001_lux();
+    appI2cGetStats(&after);
+    radarAppTiming.msgI2cUs = after.busUs - before.busUs;
+    return lux;
+}
+
+void radarAppGetTiming(radarAppTiming_t *timing)
+{
+    *timing = radarAppTiming;
+}
+
+void update_configuration(acc_detector_presence_configuration_t presence_configuration)
+{
+    acc_detector_presence_configuration_update_rate_set(presence_configuration, DEFAULT_UPDATE_RATE);
+    acc_detector_presence_configuration_detection_threshold_set(presence_configuration, DEFAULT_DETECTION_THRESHOLD);
+    acc_detector_presence_configuration_start_set(presence_configuration, DEFAULT_START_M);
+    acc_detector_presence_configuration_length_set(presence_configuration, DEFAULT_LENGTH_M);
+    acc_detector_presence_configuration_power_save_mode_set(presence_configuration, DEFAULT_POWER_SAVE_MODE);
+    acc_detector_presence_configuration_asynchronous_measurement_set(presence_configuration, RADAR_APP_ASYNC_MEASUREMENT);
+    acc_detector_presence_configuration_nbr_removed_pc_set(presence_configuration, DEFAULT_NBR_REMOVED_PC);
+    acc_detector_presence_configuration_service_profile_set(presence_configuration, DEFAULT_SERVICE_PROFILE);
+    acc_detector_presence_configuration_hw_accelerated_average_samples_set(presence_configuration, 63);
+}
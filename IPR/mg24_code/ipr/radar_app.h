@@ -0,0 +1,58 @@
+/*
+ * radar_app.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: edward62740
+ */
+
+#ifndef RADAR_APP_H_
+#define RADAR_APP_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "radar_algo.h"
+#include "radar_evq.h"
+#include "app_batt.h"
+#include "radar_night.h"
+
+typedef struct
+{
+    uint32_t getNextUs; // blocking time of acc_detector_presence_get_next()
+    uint32_t postUs;    // result processing and CoAP TX after get_next
+    bool async;         // RADAR_APP_ASYNC_MEASUREMENT, the sensor sweeps during postUs
+    uint32_t msgI2cUs;  // OPT3001 bus time spent building the last CoAP message
+} radarAppTiming_t;
+
+extern radarAlgoState_t radarAlgo;
+extern radarEvq_t radarEvq; // fed by BURTC_IRQHandler()
+
+/* Supply voltage in mV, from the IADC (main.c) */
+extern volatile uint32_t vdd_meas;
+
+/* Battery model, fed by IADC_IRQHandler() (main.c) */
+extern appBatt_t radarBatt;
+
+/* Night-mode scheduler, stepped once per frame */
+extern radarNight_t radarNight;
+
+/* Starts a software-triggered (idle) AVDD conversion, main.c */
+void vddMonitorRequestIdle(void);
+
+/* Algorithm, trace, arena and alive timer setup, before initBURTC() */
+void radarAppInit(uint64_t eui64);
+
+/* Charge used by the pack from NVM, after radarAppInit(). Without pack sense
+ * there is no telling new cells from old ones: freshCells starts over at 0 */
+void radarAppBattRestore(bool freshCells);
+
+/* Activate RSS and create the presence detector */
+void initRadar(void);
+
+/* One main loop pass: step the state machine, measure if due, send reports */
+void radarAppAlgo(void);
+
+bool radarAppSetPolicy(const char *name);
+const char *radarAppGetPolicy(void);
+void radarAppGetTiming(radarAppTiming_t *timing);
+
+#endif /* RADAR_APP_H_ */
@@ -0,0 +1,95 @@
+/*
+ * radar_calib.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: edward62740
+ */
+
+#include <math.h>
+#include <string.h>
+#include "em_emu.h"
+#include "acc_rss.h"
+#include "acc_version.h"
+#include "app_nvm.h"
+#include "radar_calib.h"
+
+#define RADAR_CALIB_FORMAT 1
+
+typedef struct
+{
+    uint16_t format;
+    uint16_t vddMv;
+    float temperature;
+    uint32_t rssVersionHash;
+    acc_calibration_context_t context;
+} radarCalibRecord_t;
+
+static radarCalibStatus_t radarCalibStatus = RADAR_CALIB_NONE;
+
+/* FNV-1a of the RSS version string, a library update invalidates the stored context */
+static uint32_t radarCalibVersionHash(void)
+{
+    uint32_t h = 2166136261u;
+    for (const char *p = acc_version_get(); *p; p++)
+    {
+        h ^= (uint8_t) *p;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static bool radarCalibUsable(const radarCalibRecord_t *rec, float temperature, uint32_t vddMv)
+{
+    if (rec->format != RADAR_CALIB_FORMAT) return false;
+    if (rec->rssVersionHash != radarCalibVersionHash()) return false;
+    if (fabsf(rec->temperature - temperature) > RADAR_CALIB_MAX_TEMP_DRIFT_C) return false;
+    if (rec->vddMv == 0) return false;
+    if (vddMv)
+    {
+        uint32_t drift = vddMv > rec->vddMv ? vddMv - rec->vddMv : rec->vddMv - vddMv;
+        if (drift > RADAR_CALIB_MAX_VDD_DRIFT_MV) return false;
+    }
+    return true;
+}
+
+static radarCalibStatus_t radarCalibRun(acc_sensor_id_t sensor_id, uint32_t vddMv)
+{
+    radarCalibRecord_t rec;
+    float temperature = EMU_TemperatureGet();
+
+    if (appNvmRead(APP_NVM_KEY_RADAR_CALIB, &rec, sizeof(rec))
+            && radarCalibUsable(&rec, temperature, vddMv)
+            && acc_rss_calibration_context_set(sensor_id, &rec.context))
+    {
+        return RADAR_CALIB_RESTORED;
+    }
+
+    /* Stale or rejected: start over with a fresh calibration */
+    acc_rss_calibration_reset(sensor_id);
+    memset(&rec, 0, sizeof(rec));
+    if (!acc_rss_calibration_context_get(sensor_id, &rec.context))
+    {
+        return RADAR_CALIB_NONE;
+    }
+    acc_rss_calibration_context_forced_set(sensor_id, &rec.context);
+
+    /* Without the supply voltage the record could never be checked against it */
+    if (vddMv == 0) return RADAR_CALIB_FRESH;
+    rec.format = RADAR_CALIB_FORMAT;
+    rec.vddMv = (uint16_t) vddMv;
+    rec.temperature = temperature;
+    rec.rssVersionHash = radarCalibVersionHash();
+    appNvmWrite(APP_NVM_KEY_RADAR_CALIB, &rec, sizeof(rec));
+    return RADAR_CALIB_FRESH;
+}
+
+radarCalibStatus_t radarCalibApply(acc_sensor_id_t sensor_id, uint32_t vddMv)
+{
+    radarCalibStatus = radarCalibRun(sensor_id, vddMv);
+    return radarCalibStatus;
+}
+
+radarCalibStatus_t radarCalibLastStatus(void)
+{
+    return radarCalibStatus;
+}
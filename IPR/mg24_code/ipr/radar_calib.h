@@ -0,0 +1,38 @@
+/*
+ * radar_calib.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: edward62740
+ */
+
+#ifndef RADAR_CALIB_H_
+#define RADAR_CALIB_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "acc_definitions_common.h"
+
+/* A stored calibration is only reused within these limits of the conditions it was taken at */
+#define RADAR_CALIB_MAX_TEMP_DRIFT_C  15.0f
+#define RADAR_CALIB_MAX_VDD_DRIFT_MV  150
+
+typedef enum
+{
+    RADAR_CALIB_NONE = 0,   // calibration context could not be obtained, RSS calibrates on create
+    RADAR_CALIB_FRESH,      // new calibration, stored to NVM
+    RADAR_CALIB_RESTORED,   // context restored from NVM and validated by RSS
+} radarCalibStatus_t;
+
+/**
+ * Restore the calibration context for sensor_id from NVM if it is still valid for the
+ * current temperature/supply and accepted by RSS, else calibrate and store a new one.
+ * Must be called after acc_rss_activate() and before the detector is created.
+ * vddMv may be 0 if the supply voltage is not known yet, the new calibration is then
+ * used but not stored.
+ */
+radarCalibStatus_t radarCalibApply(acc_sensor_id_t sensor_id, uint32_t vddMv);
+
+/* Result of the last radarCalibApply() */
+radarCalibStatus_t radarCalibLastStatus(void);
+
+#endif /* RADAR_CALIB_H_ */
@@ -0,0 +1,43 @@
+/*
+ * radar_evq.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: edward62740
+ */
+
+#include "radar_evq.h"
+
+void radarEvqInit(radarEvq_t *q)
+{
+    atomic_store_explicit(&q->head, 0, memory_order_relaxed);
+    atomic_store_explicit(&q->tail, 0, memory_order_relaxed);
+    atomic_store_explicit(&q->dropped, 0, memory_order_relaxed);
+}
+
+bool radarEvqPush(radarEvq_t *q, const radarEvt_t *evt)
+{
+    unsigned head = atomic_load_explicit(&q->head, memory_order_relaxed);
+    unsigned tail = atomic_load_explicit(&q->tail, memory_order_acquire);
+
+    if (head - tail >= RADAR_EVQ_SIZE)
+    {
+        atomic_fetch_add_explicit(&q->dropped, 1, memory_order_relaxed);
+        return false;
+    }
+    q->buf[head & (RADAR_EVQ_SIZE - 1)] = *evt;
+    /* Publish the slot before the new head becomes visible to the consumer */
+    atomic_store_explicit(&q->head, head + 1, memory_order_release);
+    return true;
+}
+
+bool radarEvqPop(radarEvq_t *q, radarEvt_t *evt)
+{
+    unsigned tail = atomic_load_explicit(&q->tail, memory_order_relaxed);
+    unsigned head = atomic_load_explicit(&q->head, memory_order_acquire);
+
+    if (head == tail) return false;
+    *evt = q->buf[tail & (RADAR_EVQ_SIZE - 1)];
+    /* Release the slot only after it has been copied out */
+    atomic_store_explicit(&q->tail, tail + 1, memory_order_release);
+    return true;
+}
@@ -0,0 +1,48 @@
+/*
+ * radar_evq.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: edward62740
+ */
+
+#ifndef RADAR_EVQ_H_
+#define RADAR_EVQ_H_
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Single-producer/single-consumer lock-free event ring.
+ * The producer is an ISR (BURTC), the consumer is the main loop; neither side
+ * ever blocks or masks interrupts. A full ring drops the new event and counts it. */
+
+#define RADAR_EVQ_SIZE 8 // must be a power of two
+
+typedef enum
+{
+    RADAR_EVT_FRAME_DUE = 0, // BURTC compare match, the next frame should be taken
+} radarEvtType_t;
+
+typedef struct
+{
+    uint32_t tick; // sleeptimer tick at which the event was posted
+    uint8_t type;
+} radarEvt_t;
+
+typedef struct
+{
+    radarEvt_t buf[RADAR_EVQ_SIZE];
+    atomic_uint head; // written by the producer only
+    atomic_uint tail; // written by the consumer only
+    atomic_uint dropped;
+} radarEvq_t;
+
+void radarEvqInit(radarEvq_t *q);
+
+/* Producer side, returns false if the ring is full */
+bool radarEvqPush(radarEvq_t *q, const radarEvt_t *evt);
+
+/* Consumer side, returns false if the ring is empty */
+bool radarEvqPop(radarEvq_t *q, radarEvt_t *evt);
+
+#endif /* RADAR_EVQ_H_ */
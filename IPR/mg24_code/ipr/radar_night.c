@@ -0,0 +1,97 @@
+/*
+ * radar_night.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: edward62740
+ */
+
+#include <string.h>
+#include "radar_night.h"
+
+void radarNightInit(radarNight_t *night)
+{
+    memset(night, 0, sizeof(*night));
+}
+
+static uint8_t radarNightEma(uint8_t avg, bool hit, bool first)
+{
+    int32_t x = hit ? 100 : 0;
+    if (first) return (uint8_t) x;
+    return (uint8_t) (avg + ((x - avg) >> RADAR_NIGHT_EMA_SHIFT));
+}
+
+/* Fold the finished slot into its day-of-slot statistics */
+static void radarNightCloseSlot(radarNight_t *night)
+{
+    radarNightSlot_t *slot = &night->slots[night->slotIdx % RADAR_NIGHT_SLOTS];
+    bool first = slot->days == 0;
+    slot->occPct = radarNightEma(slot->occPct, night->slotOccupied, first);
+    slot->darkPct = radarNightEma(slot->darkPct, !night->slotLit, first);
+    if (slot->days < UINT8_MAX) slot->days++;
+}
+
+bool radarNightSlotGated(const radarNight_t *night, uint32_t nowS)
+{
+    const radarNightSlot_t *slot = &night->slots[(nowS / RADAR_NIGHT_SLOT_S) % RADAR_NIGHT_SLOTS];
+    return slot->days >= RADAR_NIGHT_LEARN_DAYS
+            && slot->occPct <= RADAR_NIGHT_OCC_MAX_PCT
+            && slot->darkPct >= RADAR_NIGHT_DARK_MIN_PCT;
+}
+
+bool radarNightStep(radarNight_t *night, uint32_t nowS, bool presenceDetected, bool occupied, float lux)
+{
+    uint32_t idx = nowS / RADAR_NIGHT_SLOT_S;
+    bool dark = lux < RADAR_NIGHT_DARK_LUX;
+
+    if (night->active) night->activeS += nowS - night->lastS;
+    night->lastS = nowS;
+
+    if (!night->slotStarted || idx != night->slotIdx)
+    {
+        // A slot only counts if it was seen from its start
+        if (night->slotStarted && idx == night->slotIdx + 1) radarNightCloseSlot(night);
+        night->slotIdx = idx;
+        night->slotStarted = true;
+        night->slotOccupied = false;
+        night->slotLit = false;
+    }
+    night->slotOccupied |= occupied;
+    night->slotLit |= !dark;
+
+    bool active = dark && !presenceDetected && radarNightSlotGated(night, nowS);
+    if (active == night->active) return false;
+
+    night->active = active;
+    if (active) night->enters++;
+    return true;
+}
+
+bool radarNightApply(const radarNight_t *night, radarAlgoState_t *state, uint8_t scale)
+{
+    if (night->active)
+    {
+        // The policies only recompute the delay when the confidence moves, so set it here
+        state->params.frameSpacingMs = RADAR_NIGHT_FRAME_SPACING_MS * scale;
+        state->params.minFrameSpacingMs = RADAR_NIGHT_FRAME_SPACING_MS * scale;
+        if (state->delayMs == state->params.frameSpacingMs) return false;
+        state->delayMs = state->params.frameSpacingMs;
+        return true;
+    }
+
+    state->params.frameSpacingMs = RADAR_APP_DEFAULT_FRAME_SPACING_MS * scale;
+    state->params.minFrameSpacingMs = RADAR_APP_DEFAULT_MIN_FRAME_SPACING_MS * scale;
+    if (state->delayMs > state->params.frameSpacingMs)
+    {
+        state->delayMs = state->params.frameSpacingMs;
+        return true;
+    }
+    return false;
+}
+
+bool radarNightLightHint(radarNight_t *night, radarAlgoState_t *state, uint32_t nowS, float lux, uint8_t scale)
+{
+    night->hints++;
+    radarNightStep(night, nowS, false, state->hystTrigFlag, lux);
+    bool changed = radarNightApply(night, state, scale);
+    return radarAlgoBoost(state, RADAR_APP_DEFAULT_BOOST_FRAMES) || changed;
+}
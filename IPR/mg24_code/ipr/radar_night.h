@@ -0,0 +1,91 @@
+/*
+ * radar_night.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: edward62740
+ */
+
+#ifndef RADAR_NIGHT_H_
+#define RADAR_NIGHT_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "radar_algo.h"
+
+/* Ambient-light-gated night mode. Hardware free, shared with ../host (night_sim).
+ *
+ * The day is split into RADAR_NIGHT_SLOTS slots, counted from boot because there
+ * is no wall clock; only the 24 h period matters. Each slot learns two rates:
+ * how often it contained any presence, and how often it stayed dark throughout.
+ * Both are EMAs over the days seen. Once a slot has been seen for
+ * RADAR_NIGHT_LEARN_DAYS and is usually dark and vacant, the radar drops to
+ * RADAR_NIGHT_FRAME_SPACING_MS while it is dark and nothing is detected. A
+ * detection, the light coming on, or leaving the slot ends night mode at once. */
+
+#define RADAR_NIGHT_SLOTS             48    // half hours
+#define RADAR_NIGHT_SLOT_S            (24 * 3600 / RADAR_NIGHT_SLOTS)
+#define RADAR_NIGHT_DARK_LUX          5.0f  // below this the room counts as dark
+#define RADAR_NIGHT_WAKE_LUX          20.0f // light-change hint limit, armed while dark
+#define RADAR_NIGHT_LEARN_DAYS        3     // days a slot must be seen before it can gate
+#define RADAR_NIGHT_OCC_MAX_PCT       10    // slot had presence on at most this share of days
+#define RADAR_NIGHT_DARK_MIN_PCT      80    // slot was dark on at least this share of days
+#define RADAR_NIGHT_EMA_SHIFT         2     // weight 1/4 for the newest day
+#ifndef RADAR_NIGHT_FRAME_SPACING_MS
+#define RADAR_NIGHT_FRAME_SPACING_MS  30000
+#endif
+
+typedef struct
+{
+    uint8_t occPct;  // EMA, % of days with presence in the slot
+    uint8_t darkPct; // EMA, % of days the slot stayed dark
+    uint8_t days;    // days observed, saturating
+} radarNightSlot_t;
+
+typedef struct
+{
+    radarNightSlot_t slots[RADAR_NIGHT_SLOTS];
+    uint32_t slotIdx;   // absolute slot number (nowS / RADAR_NIGHT_SLOT_S) being accumulated
+    bool slotStarted;
+    bool slotOccupied;  // confirmed occupancy seen in the slot
+    bool slotLit;
+    bool active;
+
+    /* Counters */
+    uint32_t enters;
+    uint32_t activeS;
+    uint32_t hints;     // light-change hints, see radarNightLightHint()
+    uint32_t lastS;
+} radarNight_t;
+
+void radarNightInit(radarNight_t *night);
+
+/**
+ * Feed one frame: time since boot, raw detector result, the state machine's
+ * confirmed occupancy (radarAlgoState_t.hystTrigFlag) and ambient light in lux.
+ * Slots learn from the confirmed occupancy, so single false detections do not
+ * keep a slot from gating; any raw detection still ends night mode.
+ * Returns true if night mode was entered or left.
+ */
+bool radarNightStep(radarNight_t *night, uint32_t nowS, bool presenceDetected, bool occupied, float lux);
+
+/* True if the slot containing nowS is learnt as dark and vacant */
+bool radarNightSlotGated(const radarNight_t *night, uint32_t nowS);
+
+/**
+ * Set the frame spacing for night mode and the battery throttle scale. Entering
+ * night mode sets the night delay, leaving it cuts the delay back to the day
+ * spacing at once.
+ * Returns true if state->delayMs was changed.
+ */
+bool radarNightApply(const radarNight_t *night, radarAlgoState_t *state, uint8_t scale);
+
+/**
+ * Light-change hint: the light went on (OPT3001 limit interrupt) before the radar
+ * saw anyone. Steps the scheduler with the new reading, which ends night mode,
+ * sets the spacing for `scale` and boosts the frame rate for
+ * RADAR_APP_DEFAULT_BOOST_FRAMES. The caller takes a frame right away.
+ * Returns true if state->delayMs was changed.
+ */
+bool radarNightLightHint(radarNight_t *night, radarAlgoState_t *state, uint32_t nowS, float lux, uint8_t scale);
+
+#endif /* RADAR_NIGHT_H_ */
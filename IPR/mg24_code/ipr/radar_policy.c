@@ -0,0 +1,212 @@
+/*
+ * radar_policy.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: edward62740
+ */
+
+#include <stddef.h>
+#include <string.h>
+#include "radar_algo.h"
+
+/*
+ * Hysteresis (default): the original BURTC handler algorithm.
+ * detectConf ramps up by TH_POS_RATE per detection and down by TH_NEG_RATE per miss,
+ * the frame spacing is IFD / (detectConf / 10) clipped to the minimum spacing and dx
+ * tracks the trend of the spacing so that reports are only raised while ramping.
+ */
+
+/* Frame spacing for the current confidence, clipped to the minimum spacing.
+ * A zero divisor (detectConf < 10 after a decrement) yields 0 like the Cortex-M
+ * udiv instruction does with DIV_0_TRP clear, so the delay is clipped to the minimum. */
+static uint32_t radarPolicySpacing(const radarAlgoState_t *state, uint32_t *raw)
+{
+    uint8_t div = state->detectConf / 10;
+    uint32_t delay = div ? state->params.frameSpacingMs / div : 0;
+    *raw = delay;
+    return delay > state->params.minFrameSpacingMs ? delay : state->params.minFrameSpacingMs;
+}
+
+static void radarPolicyHysteresisInit(radarAlgoState_t *state)
+{
+    /* Decay from the top so that TH- is crossed and the inactive report raised */
+    if (state->hystTrigFlag) state->detectConf = state->params.maxTh;
+}
+
+static bool radarPolicyHysteresisStep(radarAlgoState_t *state, bool presenceDetected, float presenceScore)
+{
+    const radarAlgoParams_t *p = &state->params;
+    uint32_t delay;
+    bool changed = false;
+    (void) presenceScore;
+
+    if (presenceDetected && state->detectConf >= p->maxTh) {
+        state->dx = state->dx / 2.0f;
+        state->detectConf = p->maxTh;
+    }
+    else if (presenceDetected && state->detectConf < p->maxTh)
+    {
+        if (state->detectConf >= p->posTh && state->dx > 0)
+        {
+            state->sendActive = true;
+            state->hystTrigFlag = true;
+        }
+        state->detectConf += p->thPosRate;
+        state->delayMs = radarPolicySpacing(state, &delay);
+        state->dx = (state->dx + delay) / 2.0f;
+        changed = true;
+    }
+    else
+    {
+        if (state->detectConf > p->minTh)
+        {
+            if (state->detectConf == p->negTh && state->dx < 0) {
+                if (state->requireInactivation) state->sendInactive = true;
+            }
+            state->detectConf -= p->thNegRate;
+            state->delayMs = radarPolicySpacing(state, &delay);
+            state->dx = (state->dx - delay) / 2.0f;
+            changed = true;
+        }
+
+        if (state->detectConf <= p->minTh)
+        {
+            state->dx = state->dx / 2.0f;
+            state->hystTrigFlag = false;
+            state->detectConf = p->minTh;
+        }
+    }
+    return changed;
+}
+
+/*
+ * Backoff: edge-triggered confidence hysteresis (TH+/TH- crossings) with the frame
+ * spacing taken from a table indexed by the number of frames since the last detection.
+ * Reacts at the minimum spacing as soon as anything is seen, and only slowly walks back
+ * to IFD, which suits corridors with short passages.
+ */
+
+static const uint8_t radarPolicyBackoffShift[] = { 0, 0, 1, 1, 2, 2, 3 };
+
+static void radarPolicyBackoffInit(radarAlgoState_t *state)
+{
+    state->ctx.backoff.misses = sizeof(radarPolicyBackoffShift) - 1;
+    state->detectConf = state->hystTrigFlag ? state->params.maxTh : state->params.minTh;
+}
+
+static bool radarPolicyBackoffStep(radarAlgoState_t *state, bool presenceDetected, float presenceScore)
+{
+    const radarAlgoParams_t *p = &state->params;
+    (void) presenceScore;
+
+    if (presenceDetected)
+    {
+        state->ctx.backoff.misses = 0;
+        state->detectConf = state->detectConf + p->thPosRate < p->maxTh ? state->detectConf + p->thPosRate : p->maxTh;
+        if (state->detectConf >= p->posTh && !state->hystTrigFlag)
+        {
+            state->hystTrigFlag = true;
+            state->sendActive = true;
+        }
+    }
+    else
+    {
+        if (state->ctx.backoff.misses < sizeof(radarPolicyBackoffShift) - 1) state->ctx.backoff.misses++;
+        state->detectConf = state->detectConf > p->minTh + p->thNegRate ? state->detectConf - p->thNegRate : p->minTh;
+        if (state->detectConf <= p->negTh && state->hystTrigFlag)
+        {
+            state->hystTrigFlag = false;
+            if (state->requireInactivation) state->sendInactive = true;
+        }
+    }
+
+    uint32_t delay = p->minFrameSpacingMs << radarPolicyBackoffShift[state->ctx.backoff.misses];
+    if (delay > p->frameSpacingMs) delay = p->frameSpacingMs;
+    if (delay == state->delayMs) return false;
+    state->delayMs = delay;
+    return true;
+}
+
+/*
+ * Bayes: recursive occupancy estimate in integer log-odds. Each detection adds the
+ * log-likelihood ratio of a hit, each miss that of a miss (halved if the score was
+ * close to the detection threshold). Reports are raised when P(occupied) crosses
+ * 0.9/0.1 and the spacing grows with the certainty of the estimate, staying shortest
+ * while the estimate is undecided.
+ */
+
+#define RADAR_POLICY_BAYES_LOG_SCALE  10    // log-odds units per nat
+#define RADAR_POLICY_BAYES_HIT        28    // ln(P(det|occ) / P(det|empty)) = ln(0.8 / 0.05)
+#define RADAR_POLICY_BAYES_MISS       (-16) // ln(P(miss|occ) / P(miss|empty)) = ln(0.2 / 0.95)
+#define RADAR_POLICY_BAYES_WEAK_SCORE 1.0f  // misses above this score are weak evidence
+#define RADAR_POLICY_BAYES_LIMIT      60
+#define RADAR_POLICY_BAYES_DECIDE     22    // ln(0.9 / 0.1)
+
+static void radarPolicyBayesInit(radarAlgoState_t *state)
+{
+    state->ctx.bayes.occupied = state->hystTrigFlag;
+    state->ctx.bayes.logOdds = state->hystTrigFlag ? RADAR_POLICY_BAYES_DECIDE : -RADAR_POLICY_BAYES_LIMIT;
+    state->detectConf = 0;
+}
+
+static bool radarPolicyBayesStep(radarAlgoState_t *state, bool presenceDetected, float presenceScore)
+{
+    const radarAlgoParams_t *p = &state->params;
+    int16_t l = state->ctx.bayes.logOdds;
+
+    if (presenceDetected) l += RADAR_POLICY_BAYES_HIT;
+    else if (presenceScore > RADAR_POLICY_BAYES_WEAK_SCORE) l += RADAR_POLICY_BAYES_MISS / 2;
+    else l += RADAR_POLICY_BAYES_MISS;
+
+    if (l > RADAR_POLICY_BAYES_LIMIT) l = RADAR_POLICY_BAYES_LIMIT;
+    if (l < -RADAR_POLICY_BAYES_LIMIT) l = -RADAR_POLICY_BAYES_LIMIT;
+    state->ctx.bayes.logOdds = l;
+
+    if (!state->ctx.bayes.occupied && l >= RADAR_POLICY_BAYES_DECIDE)
+    {
+        state->ctx.bayes.occupied = true;
+        state->hystTrigFlag = true;
+        state->sendActive = true;
+    }
+    else if (state->ctx.bayes.occupied && l <= -RADAR_POLICY_BAYES_DECIDE)
+    {
+        state->ctx.bayes.occupied = false;
+        state->hystTrigFlag = false;
+        if (state->requireInactivation) state->sendInactive = true;
+    }
+
+    /* Confidence in percent, only used for tracing */
+    state->detectConf = (uint8_t) ((l + RADAR_POLICY_BAYES_LIMIT) * 100 / (2 * RADAR_POLICY_BAYES_LIMIT));
+
+    uint32_t range = p->frameSpacingMs > p->minFrameSpacingMs ? p->frameSpacingMs - p->minFrameSpacingMs : 0;
+    uint32_t certainty = (uint32_t) (l < 0 ? -l : l);
+    uint32_t delay = p->minFrameSpacingMs
+            + range * certainty / (l < 0 ? RADAR_POLICY_BAYES_LIMIT : 2 * RADAR_POLICY_BAYES_LIMIT);
+    if (delay == state->delayMs) return false;
+    state->delayMs = delay;
+    return true;
+}
+
+static const radarPolicy_t radarPolicies[RADAR_POLICY_COUNT] = {
+    [RADAR_POLICY_HYSTERESIS] = { "hysteresis", radarPolicyHysteresisInit, radarPolicyHysteresisStep },
+    [RADAR_POLICY_BACKOFF]    = { "backoff", radarPolicyBackoffInit, radarPolicyBackoffStep },
+    [RADAR_POLICY_BAYES]      = { "bayes", radarPolicyBayesInit, radarPolicyBayesStep },
+};
+
+const radarPolicy_t *radarPolicyGet(radarPolicyId_t id)
+{
+    return &radarPolicies[id < RADAR_POLICY_COUNT ? id : RADAR_APP_DEFAULT_POLICY];
+}
+
+bool radarPolicyFind(const char *name, radarPolicyId_t *id)
+{
+    for (int i = 0; i < RADAR_POLICY_COUNT; i++)
+    {
+        if (strcmp(name, radarPolicies[i].name) == 0)
+        {
+            *id = (radarPolicyId_t) i;
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,232 @@
+/*
+ * trace_rec.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: edward62740
+ */
+
+#include <string.h>
+#include "trace_rec.h"
+
+static uint8_t traceRecBlocks[TRACE_REC_NUM_BLOCKS][TRACE_REC_BLOCK_SIZE];
+static size_t traceRecOldest;
+static size_t traceRecCount;
+static uint16_t traceRecSeq;
+
+static const traceRecStore_t *traceRecStore;
+static size_t traceRecStoreNext; // slot written next
+static size_t traceRecStored;    // slots holding blocks of this run
+
+/* Delta base of the block being written */
+static struct
+{
+    int32_t score;      // of the last detected frame
+    int32_t idleScore;  // of the last undetected frame
+    int32_t distance;
+    uint32_t delayMs;
+    uint8_t detectConf;
+    bool detected;
+    uint8_t last;       // payload offset of the last record
+    uint8_t countAt;    // and of its repeat count, 0 if it has none
+} traceRecPrev;
+
+size_t traceRecPutVarint(uint8_t *buf, uint32_t value)
+{
+    size_t n = 0;
+    while (value >= 0x80)
+    {
+        buf[n++] = (uint8_t) (value | 0x80);
+        value >>= 7;
+    }
+    buf[n++] = (uint8_t) value;
+    return n;
+}
+
+size_t traceRecGetVarint(const uint8_t *buf, size_t len, uint32_t *value)
+{
+    uint32_t v = 0;
+    for (size_t n = 0; n < len && n < 5; n++)
+    {
+        v |= (uint32_t) (buf[n] & 0x7F) << (7 * n);
+        if (!(buf[n] & 0x80))
+        {
+            *value = v;
+            return n + 1;
+        }
+    }
+    return 0;
+}
+
+static int32_t traceRecQuantise(float v, int32_t scale)
+{
+    return (int32_t) (v * scale + (v >= 0 ? 0.5f : -0.5f));
+}
+
+static uint8_t *traceRecNewest(void)
+{
+    return traceRecBlocks[(traceRecOldest + traceRecCount - 1) % TRACE_REC_NUM_BLOCKS];
+}
+
+static uint8_t *traceRecStartBlock(uint32_t tMs)
+{
+    // The newest block is full, keep it in the store before the RAM ring may drop it
+    if (traceRecStore != NULL && traceRecCount)
+    {
+        if (traceRecStore->write(traceRecStoreNext, traceRecNewest()))
+        {
+            traceRecStoreNext = (traceRecStoreNext + 1) % traceRecStore->blocks;
+            if (traceRecStored < traceRecStore->blocks) traceRecStored++;
+        }
+        else traceRecStored = 0; // no gaps in the stored run, it starts over
+    }
+
+    if (traceRecCount == TRACE_REC_NUM_BLOCKS)
+    {
+        traceRecOldest = (traceRecOldest + 1) % TRACE_REC_NUM_BLOCKS;
+        traceRecCount--;
+    }
+    traceRecCount++;
+
+    uint8_t *blk = traceRecNewest();
+    memset(blk, 0, TRACE_REC_BLOCK_SIZE);
+    blk[0] = (uint8_t) traceRecSeq;
+    blk[1] = (uint8_t) (traceRecSeq >> 8);
+    blk[2] = (uint8_t) tMs;
+    blk[3] = (uint8_t) (tMs >> 8);
+    blk[4] = (uint8_t) (tMs >> 16);
+    blk[5] = (uint8_t) (tMs >> 24);
+    traceRecSeq++;
+
+    memset(&traceRecPrev, 0, sizeof(traceRecPrev));
+    return blk;
+}
+
+void traceRecInit(const traceRecStore_t *store)
+{
+    traceRecOldest = 0;
+    traceRecCount = 0;
+    traceRecSeq = 0;
+    traceRecStore = store != NULL && store->blocks ? store : NULL;
+    traceRecStoreNext = 0;
+    traceRecStored = 0;
+    memset(&traceRecPrev, 0, sizeof(traceRecPrev));
+}
+
+/* Counts the frame against the last record if it is the same, false if it needs a record of its own */
+static bool traceRecRepeat(uint8_t *blk, const traceRecFrame_t *frame, int32_t score, int32_t distance)
+{
+    uint8_t *payload = &blk[TRACE_REC_HEADER_SIZE];
+    if (blk[6] == 0 || frame->detected != traceRecPrev.detected || frame->detectConf != traceRecPrev.detectConf
+            || frame->delayMs != traceRecPrev.delayMs)
+        return false;
+    if (frame->detected ? score != traceRecPrev.score || distance != traceRecPrev.distance
+                        : score != traceRecPrev.idleScore)
+        return false;
+
+    uint32_t count = 0;
+    if (traceRecPrev.countAt)
+    {
+        traceRecGetVarint(&payload[traceRecPrev.countAt], blk[6] - traceRecPrev.countAt, &count);
+        if (count == TRACE_REC_MAX_REPEAT) return false;
+    }
+    uint8_t at = traceRecPrev.countAt ? traceRecPrev.countAt : blk[6];
+    uint8_t buf[5];
+    size_t n = traceRecPutVarint(buf, count + 1);
+    if (at + n > TRACE_REC_PAYLOAD_SIZE) return false;
+
+    memcpy(&payload[at], buf, n);
+    payload[traceRecPrev.last] |= TRACE_REC_HDR_REPEAT;
+    traceRecPrev.countAt = at;
+    blk[6] = (uint8_t) (at + n);
+    return true;
+}
+
+/* Record of the frame against traceRecPrev, returns its length */
+static size_t traceRecEncode(uint8_t *p, const traceRecFrame_t *frame, int32_t score, int32_t distance)
+{
+    uint8_t *hdr = p++;
+    int32_t scoreDelta = score - (frame->detected ? traceRecPrev.score : traceRecPrev.idleScore);
+
+    *hdr = frame->detected ? TRACE_REC_HDR_DETECTED : 0;
+    if (frame->detectConf != traceRecPrev.detectConf)
+    {
+        *hdr |= TRACE_REC_HDR_CONF;
+        *p++ = frame->detectConf;
+    }
+    if (frame->delayMs != traceRecPrev.delayMs)
+    {
+        *hdr |= TRACE_REC_HDR_DELAY;
+        p += traceRecPutVarint(p, traceRecZigzag((int32_t) (frame->delayMs - traceRecPrev.delayMs)));
+    }
+    if (scoreDelta > TRACE_REC_SCORE_ESCAPE && scoreDelta <= -TRACE_REC_SCORE_ESCAPE - 1)
+    {
+        *hdr |= (uint8_t) scoreDelta & TRACE_REC_HDR_SCORE_MASK;
+    }
+    else
+    {
+        *hdr |= (uint8_t) TRACE_REC_SCORE_ESCAPE & TRACE_REC_HDR_SCORE_MASK;
+        p += traceRecPutVarint(p, traceRecZigzag(scoreDelta));
+    }
+    if (frame->detected) p += traceRecPutVarint(p, traceRecZigzag(distance - traceRecPrev.distance));
+    return (size_t) (p - hdr);
+}
+
+void traceRecAppend(uint32_t tMs, const traceRecFrame_t *frame)
+{
+    int32_t score = frame->detected ? traceRecQuantise(frame->score, TRACE_REC_SCORE_SCALE)
+                                    : traceRecQuantise(frame->score, TRACE_REC_IDLE_SCORE_SCALE);
+    int32_t distance = frame->detected ? traceRecQuantise(frame->distance, TRACE_REC_DIST_SCALE) : 0;
+
+    uint8_t *blk = traceRecCount ? traceRecNewest() : NULL;
+    if (blk != NULL && traceRecRepeat(blk, frame, score, distance)) return;
+
+    // A record that does not fit starts a new block, against the block's zero state
+    uint8_t rec[TRACE_REC_MAX_RECORD];
+    size_t n = blk != NULL ? traceRecEncode(rec, frame, score, distance) : 0;
+    if (blk == NULL || blk[6] + n > TRACE_REC_PAYLOAD_SIZE)
+    {
+        blk = traceRecStartBlock(tMs);
+        n = traceRecEncode(rec, frame, score, distance);
+    }
+    memcpy(&blk[TRACE_REC_HEADER_SIZE + blk[6]], rec, n);
+
+    if (frame->detected)
+    {
+        traceRecPrev.score = score;
+        traceRecPrev.distance = distance;
+    }
+    else traceRecPrev.idleScore = score;
+    traceRecPrev.delayMs = frame->delayMs;
+    traceRecPrev.detectConf = frame->detectConf;
+    traceRecPrev.detected = frame->detected;
+    traceRecPrev.last = blk[6];
+    traceRecPrev.countAt = 0;
+    blk[6] = (uint8_t) (blk[6] + n);
+}
+
+/* Stored blocks that have left the RAM ring, the newest stored one is the one
+ * before the RAM ring's newest */
+static size_t traceRecStoredOnly(void)
+{
+    size_t inRam = traceRecCount ? traceRecCount - 1 : 0;
+    return traceRecStored > inRam ? traceRecStored - inRam : 0;
+}
+
+size_t traceRecBlockCount(void)
+{
+    return traceRecStoredOnly() + traceRecCount;
+}
+
+bool traceRecReadBlock(size_t n, uint8_t *out)
+{
+    size_t stored = traceRecStoredOnly();
+    if (n < stored)
+    {
+        size_t slots = traceRecStore->blocks;
+        return traceRecStore->read((traceRecStoreNext + slots - traceRecStored + n) % slots, out);
+    }
+    n -= stored;
+    if (n >= traceRecCount) return false;
+    memcpy(out, traceRecBlocks[(traceRecOldest + n) % TRACE_REC_NUM_BLOCKS], TRACE_REC_BLOCK_SIZE);
+    return true;
+}
@@ -0,0 +1,123 @@
+/*
+ * trace_rec.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: edward62740
+ */
+
+#ifndef TRACE_REC_H_
+#define TRACE_REC_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Per-frame presence trace recorder.
+ *
+ * Frames are packed into a RAM ring of fixed-size blocks; the oldest block is
+ * dropped when the ring is full. Each block is self-contained so it can be
+ * served as one CoAP Block2 (SZX 64) and decoded even if neighbouring blocks
+ * were lost or evicted mid-dump.
+ *
+ * With a store (traceRecInit()), every full block is also written to one of
+ * its slots, oldest overwritten first, and reads cover the stored blocks that
+ * have already left the RAM ring. The store only covers blocks written since
+ * traceRecInit(), slots of an earlier run are overwritten in turn.
+ *
+ * Block layout (little endian):
+ *     u16 seq       block sequence number, increments for every new block
+ *     u32 t0        sleeptimer time of the first frame in the block [ms], wraps
+ *                   with the 32 bit tick count after TRACE_REC_T0_WRAP_MS
+ *     u8  used      number of payload bytes in use
+ *     u8  payload[TRACE_REC_PAYLOAD_SIZE]
+ *
+ * Record layout, each field relative to the previous record in the same block
+ * (the first record of a block is relative to all-zero state):
+ *     u8  hdr       bit 7     presence_detected
+ *                   bit 6     detectConf changed, u8 detectConf follows
+ *                   bit 5     delay changed, zigzag varint delta [ms] follows
+ *                   bit 4     repeated, varint count follows last
+ *                   bits 3..0 score delta (signed), TRACE_REC_SCORE_ESCAPE
+ *                             means a zigzag varint delta follows
+ *     ...           optional fields in the order above
+ *     varint        zigzag distance delta [TRACE_REC_DIST_SCALE], only present when detected
+ *     varint        further frames identical to this one, only present when repeated
+ *
+ * Scores of detected frames are in TRACE_REC_SCORE_SCALE units, relative to the
+ * previous detected frame. Undetected ones only need to show how far below the
+ * threshold they stay, they use the coarser TRACE_REC_IDLE_SCORE_SCALE relative
+ * to the previous undetected frame.
+ *
+ * Frame times are not stored per record: the next frame is taken delay ms
+ * after the current one, which is exactly how the BURTC schedules frames.
+ * A frame that quantises to the same record as the one before only adds to
+ * its repeat count, a run of idle frames costs one record.
+ */
+
+#define TRACE_REC_BLOCK_SIZE     64
+#define TRACE_REC_HEADER_SIZE    7
+#define TRACE_REC_PAYLOAD_SIZE   (TRACE_REC_BLOCK_SIZE - TRACE_REC_HEADER_SIZE)
+#define TRACE_REC_MAX_RECORD     17 // without the repeat count
+#define TRACE_REC_MAX_REPEAT     16383 // 2 byte varint
+
+#ifndef TRACE_REC_NUM_BLOCKS
+#define TRACE_REC_NUM_BLOCKS     16 // 1 KB of RAM, older blocks are in the store
+#endif
+
+#define TRACE_REC_T0_WRAP_MS     131072000u // 2^32 ticks at 32768 Hz, about 36 h
+
+#define TRACE_REC_SCORE_SCALE      20 // 0.05 score units
+#define TRACE_REC_IDLE_SCORE_SCALE 4  // 0.25 score units, undetected frames
+#define TRACE_REC_DIST_SCALE       20 // 5 cm
+
+#define TRACE_REC_HDR_DETECTED   (1 << 7)
+#define TRACE_REC_HDR_CONF       (1 << 6)
+#define TRACE_REC_HDR_DELAY      (1 << 5)
+#define TRACE_REC_HDR_REPEAT     (1 << 4)
+#define TRACE_REC_HDR_SCORE_MASK 0x0F
+#define TRACE_REC_SCORE_ESCAPE   (-8)
+
+/* Backing store for full blocks, e.g. NVM3 objects. Slots are written in turn */
+typedef struct
+{
+    size_t blocks;
+    bool (*write)(size_t slot, const uint8_t *blk);
+    bool (*read)(size_t slot, uint8_t *blk);
+} traceRecStore_t;
+
+typedef struct
+{
+    bool detected;
+    float score;
+    float distance;
+    uint32_t delayMs;
+    uint8_t detectConf;
+} traceRecFrame_t;
+
+/* store may be NULL, the trace is then held in RAM only */
+void traceRecInit(const traceRecStore_t *store);
+void traceRecAppend(uint32_t tMs, const traceRecFrame_t *frame);
+
+/* Number of blocks currently held, in the store and in RAM, including the
+ * partially filled newest block */
+size_t traceRecBlockCount(void);
+
+/* Copy the n-th oldest block (TRACE_REC_BLOCK_SIZE bytes) into out. False if
+ * there is no such block or the store could not read it */
+bool traceRecReadBlock(size_t n, uint8_t *out);
+
+/* Encoding helpers, shared with the host decoder */
+size_t traceRecPutVarint(uint8_t *buf, uint32_t value);
+size_t traceRecGetVarint(const uint8_t *buf, size_t len, uint32_t *value);
+
+static inline uint32_t traceRecZigzag(int32_t v)
+{
+    return ((uint32_t) v << 1) ^ (uint32_t) (v >> 31);
+}
+
+static inline int32_t traceRecUnzigzag(uint32_t v)
+{
+    return (int32_t) (v >> 1) ^ -(int32_t) (v & 1);
+}
+
+#endif /* TRACE_REC_H_ */